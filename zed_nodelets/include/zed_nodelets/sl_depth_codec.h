@@ -0,0 +1,76 @@
+///////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2023, STEREOLABS.
+//
+// All rights reserved.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+///////////////////////////////////////////////////////////////////////////
+
+#ifndef SL_DEPTH_CODEC_H
+#define SL_DEPTH_CODEC_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace sl_tools
+{
+/*! \brief Compression of 16 bit depth maps in millimeters (`16UC1`, `0` for invalid values).
+ *
+ * The image is split in bands of rows that are compressed independently (in parallel when OpenMP is available)
+ * with the RVL algorithm: runs of invalid pixels are run-length encoded, valid pixels are encoded as the zig-zag
+ * difference with the previous valid pixel, and all the values are written with a 3 bit per nibble variable length
+ * code.
+ *
+ * With `maxError > 0` the valid values are quantized before compression, the decoded values differ from the
+ * original ones by at most `maxError` millimeters. Invalid pixels are always preserved.
+ *
+ * The stream is self-describing: a decoder only needs this header and does not depend on ROS or on the ZED SDK.
+ */
+namespace depth_codec
+{
+/*! \brief Format string of the `sensor_msgs/CompressedImage` messages carrying a compressed stream */
+constexpr const char* FORMAT = "16UC1; rvl";
+
+/*! \brief Maximum number of pixels of a decoded image, larger streams are rejected */
+constexpr uint64_t MAX_PIXELS = 1ull << 26;
+
+/*! \brief Compress a depth map
+ * \param depth : pointer to the first pixel
+ * \param width : image width [pixel]
+ * \param height : image height [pixel]
+ * \param stepBytes : size of a row in bytes, `0` for contiguous rows
+ * \param maxError : maximum absolute error allowed [mm], `0` for lossless compression
+ * \param out : the compressed stream, resized to the used size
+ * \param tileRows : number of rows of each independently compressed band
+ * \return false if the parameters are not valid or the image is larger than \ref MAX_PIXELS
+ */
+bool compress(const uint16_t* depth, int width, int height, size_t stepBytes, int maxError, std::vector<uint8_t>& out,
+              int tileRows = 32);
+
+/*! \brief Decompress a depth map. The stream is validated and never read past `size`
+ * \param data : the compressed stream
+ * \param size : size of the compressed stream in bytes
+ * \param depth : the decompressed depth map, `width * height` contiguous values
+ * \param width : decompressed image width [pixel]
+ * \param height : decompressed image height [pixel]
+ * \return false if the stream is not valid, truncated or larger than \ref MAX_PIXELS
+ */
+bool decompress(const uint8_t* data, size_t size, std::vector<uint16_t>& depth, int& width, int& height);
+
+}  // namespace depth_codec
+}  // namespace sl_tools
+
+#endif  // SL_DEPTH_CODEC_H
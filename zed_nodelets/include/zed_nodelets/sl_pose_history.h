@@ -0,0 +1,109 @@
+///////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2023, STEREOLABS.
+//
+// All rights reserved.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+///////////////////////////////////////////////////////////////////////////
+
+#ifndef SL_POSE_HISTORY_H
+#define SL_POSE_HISTORY_H
+
+#include <ros/time.h>
+#include <tf2/LinearMath/Transform.h>
+
+#include <cstdint>
+#include <memory>
+#include <shared_mutex>
+#include <string>
+#include <vector>
+
+namespace sl_tools
+{
+/*! \brief Time-indexed history of the poses of the base frame.
+ *
+ * The poses are stored in a fixed capacity ring ordered by timestamp and looked up in O(log n), interpolating
+ * between the two closest samples. The history is written by the camera nodelet once per frame and can be read
+ * concurrently by any number of threads.
+ *
+ * The histories are registered by name, so nodelets loaded in the same nodelet manager can query the poses of a
+ * camera directly from memory with \ref find, without going through the TF buffer or a service call.
+ */
+class PoseHistory
+{
+public:
+  /*! \brief A pose of the base frame */
+  struct Sample
+  {
+    ros::Time stamp;
+    tf2::Transform odom2base;  //!< Coordinates of the base in odometry frame
+    tf2::Transform map2base;   //!< Coordinates of the base in map frame
+  };
+
+  /*! \brief Create a history and register it, replacing any history previously registered with the same name
+   * \param name the name used by \ref find, usually the namespace of the camera nodelet
+   * \param capacity maximum number of stored poses
+   * \return the new history. It is unregistered when the last reference is released
+   */
+  static std::shared_ptr<PoseHistory> create(const std::string& name, size_t capacity);
+
+  /*! \brief Get a registered history
+   * \param name the name used when creating the history
+   * \return the history, `nullptr` if not available
+   */
+  static std::shared_ptr<const PoseHistory> find(const std::string& name);
+
+  ~PoseHistory();
+
+  /*! \brief Add a pose. Poses not newer than the latest stored one are ignored */
+  void add(ros::Time stamp, const tf2::Transform& odom2base, const tf2::Transform& map2base);
+
+  /*! \brief Remove all the stored poses, e.g. when the odometry is reset */
+  void clear();
+
+  /*! \brief Get the pose at the given time
+   * \param stamp the requested time
+   * \param sample the pose at `stamp`, interpolated between the two closest stored poses
+   * \return false if `stamp` is outside of the stored time range
+   */
+  bool lookup(ros::Time stamp, Sample& sample) const;
+
+  /*! \brief Get the poses at many times with a single lock of the history
+   * \param stamps the requested times
+   * \param samples the poses at the requested times, same size as `stamps`
+   * \param valid for each requested time `1` if the pose has been found, `0` otherwise
+   * \return the number of poses found
+   */
+  size_t lookup(const std::vector<ros::Time>& stamps, std::vector<Sample>& samples, std::vector<uint8_t>& valid) const;
+
+  /*! \brief Get the stored time range
+   * \return false if the history is empty
+   */
+  bool getTimeRange(ros::Time& oldest, ros::Time& newest) const;
+
+private:
+  explicit PoseHistory(size_t capacity);
+
+  // Must be called with the lock held
+  bool lookupUnlocked(ros::Time stamp, Sample& sample) const;
+
+  class Samples;  // Defined in the source file, keeps the SDK headers out of this public header
+  std::unique_ptr<Samples> mSamples;
+  mutable std::shared_mutex mMutex;
+};
+
+}  // namespace sl_tools
+
+#endif  // SL_POSE_HISTORY_H
@@ -33,6 +33,9 @@
 #include <image_transport/image_transport.h>
 #include <image_transport/subscriber_filter.h>
 
+#include <mutex>
+
+#include "sl_rgbd_payload.h"
 #include "zed_interfaces/RGBDSensors.h"
 
 namespace zed_nodelets
@@ -50,7 +53,12 @@ protected:
 
   /*! \brief Callback for full topics synchronization
    */
-  void msgCallback(const zed_interfaces::RGBDSensorsPtr& msg);
+  void msgCallback(const zed_interfaces::RGBDSensorsConstPtr& msg);
+
+  /*! \brief Subscribe to the sync topic only while at least one demuxed topic has subscribers.
+   *         Called by the connection callbacks of all the publishers
+   */
+  void updateSubscription();
 
 private:
   // Node handlers
@@ -65,6 +73,8 @@ private:
 
   // Subscribers
   ros::Subscriber mSub;
+  std::string mSyncTopic;  // Resolved name of the sync topic
+  std::mutex mSubMutex;  // Connection callbacks can be called concurrently
 };
 
 }  // namespace zed_nodelets
@@ -24,6 +24,7 @@
 #include <ros/console.h>
 #endif
 
+#include <boost/bind.hpp>
 #include <chrono>
 
 namespace zed_nodelets
@@ -51,78 +52,109 @@ void RgbdSensorsDemuxNodelet::onInit()
 
   NODELET_INFO("********** Starting nodelet '%s' **********", getName().c_str());
 
-  mSub = mNh.subscribe("rgbd_sens", 1, &RgbdSensorsDemuxNodelet::msgCallback, this);
-  NODELET_INFO_STREAM(" * Subscribed to topic: " << mSub.getTopic().c_str());
+  // Resolved before advertising: the connection callbacks can subscribe as soon as a publisher is advertised
+  mSyncTopic = mNh.resolveName("rgbd_sens");
+  NODELET_INFO_STREAM(" * Subscribing to topic " << mSyncTopic << " when the demuxed topics have subscribers");
+
+  // ----> Publishers, all advertised at startup so that the subscriptions drive the demux
+  ros::SubscriberStatusCallback rosConnCb = boost::bind(&RgbdSensorsDemuxNodelet::updateSubscription, this);
+  image_transport::SubscriberStatusCallback itConnCb = boost::bind(&RgbdSensorsDemuxNodelet::updateSubscription, this);
+
+  ros::NodeHandle rgb_pnh(mNhP, "rgb");
+  image_transport::ImageTransport rgb_it(rgb_pnh);
+  mPubRgb = rgb_it.advertiseCamera("image_rect_color", 1, itConnCb, itConnCb, rosConnCb, rosConnCb);  // rgb
+  NODELET_INFO_STREAM("Advertised on topic " << mPubRgb.getTopic());
+  NODELET_INFO_STREAM("Advertised on topic " << mPubRgb.getInfoTopic());
+
+  ros::NodeHandle depth_pnh(mNhP, "depth");
+  image_transport::ImageTransport depth_it(depth_pnh);
+  mPubDepth = depth_it.advertiseCamera("depth_registered", 1, itConnCb, itConnCb, rosConnCb, rosConnCb);  // depth
+  NODELET_INFO_STREAM("Advertised on topic " << mPubDepth.getTopic());
+  NODELET_INFO_STREAM("Advertised on topic " << mPubDepth.getInfoTopic());
+
+  ros::NodeHandle imu_pnh(mNhP, "imu");
+  mPubIMU = imu_pnh.advertise<sensor_msgs::Imu>("data", 1, rosConnCb, rosConnCb);  // IMU
+  NODELET_INFO_STREAM("Advertised on topic " << mPubIMU.getTopic());
+  mPubMag = imu_pnh.advertise<sensor_msgs::MagneticField>("mag", 1, rosConnCb, rosConnCb);  // Magnetometer
+  NODELET_INFO_STREAM("Advertised on topic " << mPubMag.getTopic());
+  // <---- Publishers, all advertised at startup so that the subscriptions drive the demux
+
+  // Subscribers connected while advertising
+  updateSubscription();
 }
 
-void RgbdSensorsDemuxNodelet::msgCallback(const zed_interfaces::RGBDSensorsPtr& msg)
+void RgbdSensorsDemuxNodelet::updateSubscription()
 {
-  if (!msg->rgb.header.stamp.isZero())
-  {
-    if (mPubRgb.getTopic().empty())
-    {
-      ros::NodeHandle rgb_pnh(mNhP, "rgb");
-      image_transport::ImageTransport it(rgb_pnh);
+  std::lock_guard<std::mutex> lock(mSubMutex);
 
-      mPubRgb = it.advertiseCamera("image_rect_color", 1);  // rgb
-      NODELET_INFO_STREAM("Advertised on topic " << mPubRgb.getTopic());
-      NODELET_INFO_STREAM("Advertised on topic " << mPubRgb.getInfoTopic());
-    }
+  uint32_t subCount = mPubRgb.getNumSubscribers() + mPubDepth.getNumSubscribers() + mPubIMU.getNumSubscribers() +
+                      mPubMag.getNumSubscribers();
+
+  if (subCount > 0 && !mSub)
+  {
+    mSub = mNh.subscribe(mSyncTopic, 1, &RgbdSensorsDemuxNodelet::msgCallback, this);
+    NODELET_DEBUG_STREAM("Subscribed to topic " << mSub.getTopic());
+  }
+  else if (subCount == 0 && mSub)
+  {
+    NODELET_DEBUG_STREAM("No subscribers: unsubscribing from topic " << mSub.getTopic());
+    mSub.shutdown();
+  }
+}
 
-    if (mPubRgb.getNumSubscribers() > 0)
+void RgbdSensorsDemuxNodelet::msgCallback(const zed_interfaces::RGBDSensorsConstPtr& msg)
+{
+  // ----> Images shared in memory by a sync nodelet running in the same manager
+  sensor_msgs::ImageConstPtr rgbShared, depthShared;
+  if (sl_tools::RgbdPayloadChannel::isReference(msg->rgb) || sl_tools::RgbdPayloadChannel::isReference(msg->depth))
+  {
+    std::shared_ptr<const sl_tools::RgbdPayloadChannel> channel = sl_tools::RgbdPayloadChannel::find(mSyncTopic);
+    if (!channel || !channel->get(msg->header.stamp, rgbShared, depthShared))
     {
-      mPubRgb.publish(msg->rgb, msg->rgbCameraInfo);
+      NODELET_WARN_THROTTLE(5.0,
+                            "The sync message does not contain the images and the shared images are not available: "
+                            "the sync nodelet must run in the same nodelet manager to use 'shared_payload'");
     }
   }
+  // <---- Images shared in memory by a sync nodelet running in the same manager
+
+  // The parts are published as shared pointers aliasing the received message: no copy, and the message is released
+  // when the last part is no longer used
 
-  if (!msg->depth.header.stamp.isZero())
+  if (!msg->rgb.header.stamp.isZero() && mPubRgb.getNumSubscribers() > 0)
   {
-    if (mPubDepth.getTopic().empty())
+    sensor_msgs::CameraInfoConstPtr info(msg, &msg->rgbCameraInfo);
+    if (rgbShared)
     {
-      ros::NodeHandle depth_pnh(mNhP, "depth");
-      image_transport::ImageTransport it(depth_pnh);
-
-      mPubDepth = it.advertiseCamera("depth_registered", 1);  // depth
-      NODELET_INFO_STREAM("Advertised on topic " << mPubDepth.getTopic());
-      NODELET_INFO_STREAM("Advertised on topic " << mPubDepth.getInfoTopic());
+      mPubRgb.publish(rgbShared, info);
     }
-
-    if (mPubDepth.getNumSubscribers() > 0)
+    else if (!sl_tools::RgbdPayloadChannel::isReference(msg->rgb))
     {
-      mPubDepth.publish(msg->depth, msg->depthCameraInfo);
+      mPubRgb.publish(sensor_msgs::ImageConstPtr(msg, &msg->rgb), info);
     }
   }
 
-  if (!msg->imu.header.stamp.isZero())
+  if (!msg->depth.header.stamp.isZero() && mPubDepth.getNumSubscribers() > 0)
   {
-    if (mPubIMU.getTopic().empty())
+    sensor_msgs::CameraInfoConstPtr info(msg, &msg->depthCameraInfo);
+    if (depthShared)
     {
-      ros::NodeHandle imu_pnh(mNhP, "imu");
-
-      mPubIMU = imu_pnh.advertise<sensor_msgs::Imu>("data", 1);  // IMU
-      NODELET_INFO_STREAM("Advertised on topic " << mPubIMU.getTopic());
+      mPubDepth.publish(depthShared, info);
     }
-
-    if (mPubIMU.getNumSubscribers() > 0)
+    else if (!sl_tools::RgbdPayloadChannel::isReference(msg->depth))
     {
-      mPubIMU.publish(msg->imu);
+      mPubDepth.publish(sensor_msgs::ImageConstPtr(msg, &msg->depth), info);
     }
   }
 
-  if (!msg->mag.header.stamp.isZero())
+  if (!msg->imu.header.stamp.isZero() && mPubIMU.getNumSubscribers() > 0)
   {
-    if (mPubMag.getTopic().empty())
-    {
-      ros::NodeHandle imu_pnh(mNhP, "imu");
-
-      mPubMag = imu_pnh.advertise<sensor_msgs::MagneticField>("mag", 1);  // IMU
-      NODELET_INFO_STREAM("Advertised on topic " << mPubMag.getTopic());
-    }
+    mPubIMU.publish(sensor_msgs::ImuConstPtr(msg, &msg->imu));
+  }
 
-    if (mPubMag.getNumSubscribers() > 0)
-    {
-      mPubMag.publish(msg->mag);
-    }
+  if (!msg->mag.header.stamp.isZero() && mPubMag.getNumSubscribers() > 0)
+  {
+    mPubMag.publish(sensor_msgs::MagneticFieldConstPtr(msg, &msg->mag));
   }
 }
 
@@ -29,15 +29,18 @@
 #include <sensor_msgs/Imu.h>
 #include <sensor_msgs/MagneticField.h>
 
-#include <message_filters/subscriber.h>
-#include <message_filters/sync_policies/approximate_time.h>
-#include <message_filters/sync_policies/exact_time.h>
-#include <message_filters/synchronizer.h>
-
+#include <diagnostic_updater/diagnostic_updater.h>
 #include <image_transport/image_transport.h>
-#include <image_transport/subscriber_filter.h>
 
+#include <chrono>
+#include <deque>
+#include <memory>
+#include <mutex>
+
+#include "sl_rgbd_payload.h"
+#include "sl_tools.h"
 #include "zed_interfaces/RGBDSensors.h"
+#include "zed_nodelets/ImuWindow.h"
 
 namespace zed_nodelets
 {
@@ -82,67 +85,134 @@ protected:
                        const sensor_msgs::CameraInfoConstPtr& depthCameraInfo,
                        const sensor_msgs::MagneticFieldConstPtr& mag);
 
+  /*! \brief Set the images of a sync message: deep copies, or references to the shared payload channel
+   */
+  void fillImages(zed_interfaces::RGBDSensorsPtr& outSyncMsg, const sensor_msgs::ImageConstPtr& rgb,
+                  const sensor_msgs::ImageConstPtr& depth);
+
+  /*! \brief Input callbacks: queue the received message and try to complete the pending frames
+   */
+  void rgbCallback(const sensor_msgs::ImageConstPtr& msg);
+  void depthCallback(const sensor_msgs::ImageConstPtr& msg);
+  void rgbInfoCallback(const sensor_msgs::CameraInfoConstPtr& msg);
+  void depthInfoCallback(const sensor_msgs::CameraInfoConstPtr& msg);
+  void imuCallback(const sensor_msgs::ImuConstPtr& msg);
+  void magCallback(const sensor_msgs::MagneticFieldConstPtr& msg);
+
+  /*! \brief Diagnostic callback: match latency and drop statistics
+   */
+  void callback_updateDiagnostic(diagnostic_updater::DiagnosticStatusWrapper& stat);
+
 private:
+  /*! \brief Match the queued images and camera infos into frames, dropping the parts older than a matched frame.
+   *         `mSyncMutex` must be locked by the caller
+   */
+  void matchFrames();
+
+  /*! \brief Publish the matched frames whose IMU and magnetometer samples are available.
+   *         `mSyncMutex` must be locked by the caller
+   */
+  void emitFrames();
+
+  /*! \brief Get the IMU sample at the given time from the IMU ring: the nearest one or the linear interpolation of
+   *         the two closest ones. `mSyncMutex` must be locked by the caller
+   * \return `nullptr` if the ring is empty
+   */
+  sensor_msgs::ImuConstPtr imuAt(ros::Time stamp);
+
+  /*! \brief Index of the first sample of the IMU ring not older than the given time, the ring size if none.
+   *         `mSyncMutex` must be locked by the caller
+   */
+  size_t imuLowerBound(ros::Time stamp) const;
+
+  /*! \brief Publish the IMU samples received since the previous frame. `mSyncMutex` must be locked by the caller
+   * \param stamp : the stamp of the frame
+   */
+  void publishImuWindow(ros::Time stamp);
+
+  /*! \brief Get the magnetometer sample nearest to the given time. `mSyncMutex` must be locked by the caller
+   * \return `nullptr` if the ring is empty
+   */
+  sensor_msgs::MagneticFieldConstPtr magAt(ros::Time stamp);
+
+  /*! \brief A frame whose images and camera infos have been matched */
+  struct Frame
+  {
+    ros::Time stamp;
+    sensor_msgs::ImageConstPtr rgb;
+    sensor_msgs::ImageConstPtr depth;
+    sensor_msgs::CameraInfoConstPtr rgbInfo;
+    sensor_msgs::CameraInfoConstPtr depthInfo;
+    std::chrono::steady_clock::time_point firstArrival;  //!< Arrival of the first part, for the match latency
+    std::chrono::steady_clock::time_point matchTime;     //!< Used for the sensors timeout
+  };
+
+  /*! \brief A message waiting for the other parts of its frame */
+  template <typename T>
+  struct Queued
+  {
+    T msg;
+    std::chrono::steady_clock::time_point arrival;
+  };
+
   // Node handlers
   ros::NodeHandle mNh;   // Node handler
   ros::NodeHandle mNhP;  // Private Node handler
 
   // Publishers
   ros::Publisher mPubRaw;
+  ros::Publisher mPubImuWindow;
+  zed_nodelets::ImuWindowPtr mImuWindowMsg;  // Reused when not held by intra-process subscribers
+  ros::Time mLastWindowStamp;                 // End of the last published IMU window
 
   // Subscribers
-  image_transport::SubscriberFilter mSubRgbImage;
-  image_transport::SubscriberFilter mSubDepthImage;
-  message_filters::Subscriber<sensor_msgs::CameraInfo> mSubRgbCamInfo;
-  message_filters::Subscriber<sensor_msgs::CameraInfo> mSubDepthCamInfo;
-  message_filters::Subscriber<sensor_msgs::Imu> mSubImu;
-  message_filters::Subscriber<sensor_msgs::MagneticField> mSubMag;
-
-  // Approx sync policies
-  typedef message_filters::sync_policies::ApproximateTime<sensor_msgs::Image, sensor_msgs::Image,
-                                                          sensor_msgs::CameraInfo, sensor_msgs::CameraInfo,
-                                                          sensor_msgs::Imu, sensor_msgs::MagneticField>
-      ApproxFullSyncPolicy;
-  typedef message_filters::sync_policies::ApproximateTime<
-      sensor_msgs::Image, sensor_msgs::Image, sensor_msgs::CameraInfo, sensor_msgs::CameraInfo, sensor_msgs::Imu>
-      ApproxRgbdImuSyncPolicy;
-  typedef message_filters::sync_policies::ApproximateTime<sensor_msgs::Image, sensor_msgs::Image,
-                                                          sensor_msgs::CameraInfo, sensor_msgs::CameraInfo,
-                                                          sensor_msgs::MagneticField>
-      ApproxRgbdMagSyncPolicy;
-  typedef message_filters::sync_policies::ApproximateTime<sensor_msgs::Image, sensor_msgs::Image,
-                                                          sensor_msgs::CameraInfo, sensor_msgs::CameraInfo>
-      ApproxRgbdSyncPolicy;
-  message_filters::Synchronizer<ApproxFullSyncPolicy>* mApproxFullSync = nullptr;
-  message_filters::Synchronizer<ApproxRgbdImuSyncPolicy>* mApproxRgbdImuSync = nullptr;
-  message_filters::Synchronizer<ApproxRgbdMagSyncPolicy>* mApproxRgbdMagSync = nullptr;
-  message_filters::Synchronizer<ApproxRgbdSyncPolicy>* mApproxRgbdSync = nullptr;
-
-  // Exact sync policies
-  typedef message_filters::sync_policies::ExactTime<sensor_msgs::Image, sensor_msgs::Image, sensor_msgs::CameraInfo,
-                                                    sensor_msgs::CameraInfo, sensor_msgs::Imu,
-                                                    sensor_msgs::MagneticField>
-      ExactFullSyncPolicy;
-  typedef message_filters::sync_policies::ExactTime<sensor_msgs::Image, sensor_msgs::Image, sensor_msgs::CameraInfo,
-                                                    sensor_msgs::CameraInfo, sensor_msgs::Imu>
-      ExactRgbdImuSyncPolicy;
-  typedef message_filters::sync_policies::ExactTime<sensor_msgs::Image, sensor_msgs::Image, sensor_msgs::CameraInfo,
-                                                    sensor_msgs::CameraInfo, sensor_msgs::MagneticField>
-      ExactRgbdMagSyncPolicy;
-  typedef message_filters::sync_policies::ExactTime<sensor_msgs::Image, sensor_msgs::Image, sensor_msgs::CameraInfo,
-                                                    sensor_msgs::CameraInfo>
-      ExactRgbdSyncPolicy;
-  message_filters::Synchronizer<ExactFullSyncPolicy>* mExactFullSync = nullptr;
-  message_filters::Synchronizer<ExactRgbdImuSyncPolicy>* mExactRgbdImuSync = nullptr;
-  message_filters::Synchronizer<ExactRgbdMagSyncPolicy>* mExactRgbdMagSync = nullptr;
-  message_filters::Synchronizer<ExactRgbdSyncPolicy>* mExactRgbdSync = nullptr;
+  image_transport::Subscriber mSubRgbImage;
+  image_transport::Subscriber mSubDepthImage;
+  ros::Subscriber mSubRgbCamInfo;
+  ros::Subscriber mSubDepthCamInfo;
+  ros::Subscriber mSubImu;
+  ros::Subscriber mSubMag;
+
+  // ----> Synchronization: all the queues are bounded
+  std::mutex mSyncMutex;
+  std::deque<Queued<sensor_msgs::ImageConstPtr>> mRgbQueue;
+  std::deque<Queued<sensor_msgs::ImageConstPtr>> mDepthQueue;
+  std::deque<Queued<sensor_msgs::CameraInfoConstPtr>> mRgbInfoQueue;
+  std::deque<Queued<sensor_msgs::CameraInfoConstPtr>> mDepthInfoQueue;
+  std::deque<Frame> mPendingFrames;  // Matched, waiting for the IMU and magnetometer samples
+  sl_tools::RingBuffer<sensor_msgs::ImuConstPtr> mImuRing;
+  sl_tools::RingBuffer<sensor_msgs::MagneticFieldConstPtr> mMagRing;
+  // <---- Synchronization
+
+  // ----> Statistics
+  diagnostic_updater::Updater mDiagUpdater;
+  ros::Timer mDiagTimer;
+  uint64_t mFramesPublished = 0;
+  uint64_t mFramesDropped = 0;    // Frames not matched, or not completed before the queues overflowed
+  uint64_t mMsgsOverflowed = 0;   // Image and camera info messages removed from a full queue
+  uint64_t mSensorsTimeouts = 0;  // Frames published without waiting for a newer IMU or magnetometer sample
+  std::unique_ptr<sl_tools::CSmartMean> mMatchLatencyMean_msec;
+  std::unique_ptr<sl_tools::CSmartMean> mImuOffsetMean_msec;
+  // <---- Statistics
 
   // Params
   std::string mZedNodeletName = "zed_node";
   bool mUseApproxSync = true;
   bool mUseImu = true;
   bool mUseMag = true;
-  int mQueueSize = 50;
+  int mQueueSize = 50;             // Size of the IMU and magnetometer rings
+  int mImageQueueSize = 5;         // Maximum number of queued messages for each image and camera info topic
+  double mMaxInterval = 0.01;      // [sec] Maximum stamp difference of the parts of a frame with approximate sync
+  double mMaxSensorWait = 0.05;    // [sec] Maximum wait for an IMU or magnetometer sample newer than the frame
+  bool mImuInterpolation = false;  // Interpolate the IMU samples at the frame time instead of picking the nearest
+  bool mImuWindow = false;         // Publish all the IMU samples between consecutive frames
+  bool mSharedPayload = false;     // Images shared in memory with the demux nodelets in the same manager
+
+  // Images referenced by the sync messages when `mSharedPayload` is enabled
+  std::shared_ptr<sl_tools::RgbdPayloadChannel> mPayloadChannel;
+
+  // Frequency calculation (per instance, multiple sync nodelets can share the same manager)
+  std::chrono::steady_clock::time_point mLastCbTime = std::chrono::steady_clock::now();
 };
 
 }  // namespace zed_nodelets
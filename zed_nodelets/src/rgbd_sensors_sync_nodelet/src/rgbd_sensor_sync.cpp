@@ -24,33 +24,54 @@
 #include <ros/console.h>
 #endif
 
+#include <tf2/LinearMath/Quaternion.h>
+
+#include <algorithm>
+#include <boost/make_shared.hpp>
 #include <chrono>
+#include <cmath>
 
 namespace zed_nodelets
 {
+namespace
+{
+// Index of the queued message nearest to `stamp` within `tol`, `-1` if none
+template <typename Q>
+int nearestQueued(const Q& queue, ros::Time stamp, double tol)
+{
+  int best = -1;
+  double bestDiff = 0.0;
+  for (size_t i = 0; i < queue.size(); i++)
+  {
+    double diff = std::fabs((queue[i].msg->header.stamp - stamp).toSec());
+    if (diff <= tol && (best < 0 || diff < bestDiff))
+    {
+      best = static_cast<int>(i);
+      bestDiff = diff;
+    }
+  }
+  return best;
+}
+
+// Append a message to a bounded queue, counting the oldest message in `dropped` when it is removed
+template <typename Q, typename T>
+void enqueue(Q& queue, const T& msg, size_t maxSize, uint64_t& dropped)
+{
+  queue.push_back({ msg, std::chrono::steady_clock::now() });
+  if (queue.size() > maxSize)
+  {
+    queue.pop_front();
+    dropped++;
+  }
+}
+}  // namespace
+
 RgbdSensorsSyncNodelet::RgbdSensorsSyncNodelet()
 {
 }
 
 RgbdSensorsSyncNodelet::~RgbdSensorsSyncNodelet()
 {
-  if (mApproxFullSync)
-    delete mApproxFullSync;
-  if (mApproxRgbdImuSync)
-    delete mApproxRgbdImuSync;
-  if (mApproxRgbdMagSync)
-    delete mApproxRgbdMagSync;
-  if (mApproxRgbdSync)
-    delete mApproxRgbdSync;
-
-  if (mExactFullSync)
-    delete mExactFullSync;
-  if (mExactRgbdImuSync)
-    delete mExactRgbdImuSync;
-  if (mExactRgbdMagSync)
-    delete mExactRgbdMagSync;
-  if (mExactRgbdSync)
-    delete mExactRgbdSync;
 }
 
 void RgbdSensorsSyncNodelet::onInit()
@@ -70,91 +91,34 @@ void RgbdSensorsSyncNodelet::onInit()
 
   readParameters();
 
+  mImuRing.setCapacity(std::max(mQueueSize, 2));
+  mMagRing.setCapacity(std::max(mQueueSize, 2));
+  mMatchLatencyMean_msec = std::make_unique<sl_tools::CSmartMean>(30);
+  mImuOffsetMean_msec = std::make_unique<sl_tools::CSmartMean>(30);
+
   mPubRaw = mNhP.advertise<zed_interfaces::RGBDSensors>("rgbd_sens", 1);
   NODELET_INFO_STREAM("Advertised on topic " << mPubRaw.getTopic());
 
-  if (mUseApproxSync)
+  if (mUseImu && mImuWindow)
   {
-    NODELET_DEBUG("Using Approximate Time sync");
-
-    if (mUseImu && mUseMag)
-    {
-      mApproxFullSync = new message_filters::Synchronizer<ApproxFullSyncPolicy>(
-          ApproxFullSyncPolicy(mQueueSize), mSubRgbImage, mSubDepthImage, mSubRgbCamInfo, mSubDepthCamInfo, mSubImu,
-          mSubMag);
-      mApproxFullSync->registerCallback(
-          boost::bind(&RgbdSensorsSyncNodelet::callbackFull, this, _1, _2, _3, _4, _5, _6));
-
-      NODELET_DEBUG("RGB + Depth + IMU + Magnetometer Sync");
-    }
-    else if (mUseImu)
-    {
-      NODELET_DEBUG("RGB + Depth + IMU Sync");
-
-      mApproxRgbdImuSync = new message_filters::Synchronizer<ApproxRgbdImuSyncPolicy>(
-          ApproxRgbdImuSyncPolicy(mQueueSize), mSubRgbImage, mSubDepthImage, mSubRgbCamInfo, mSubDepthCamInfo, mSubImu);
-      mApproxRgbdImuSync->registerCallback(
-          boost::bind(&RgbdSensorsSyncNodelet::callbackRGBDIMU, this, _1, _2, _3, _4, _5));
-    }
-    else if (mUseMag)
-    {
-      NODELET_DEBUG("RGB + Depth + Magnetometer Sync");
-
-      mApproxRgbdMagSync = new message_filters::Synchronizer<ApproxRgbdMagSyncPolicy>(
-          ApproxRgbdMagSyncPolicy(mQueueSize), mSubRgbImage, mSubDepthImage, mSubRgbCamInfo, mSubDepthCamInfo, mSubMag);
-      mApproxRgbdMagSync->registerCallback(
-          boost::bind(&RgbdSensorsSyncNodelet::callbackRGBDMag, this, _1, _2, _3, _4, _5));
-    }
-    else
-    {
-      NODELET_DEBUG("RGB + Depth Sync");
-
-      mApproxRgbdSync = new message_filters::Synchronizer<ApproxRgbdSyncPolicy>(
-          ApproxRgbdSyncPolicy(mQueueSize), mSubRgbImage, mSubDepthImage, mSubRgbCamInfo, mSubDepthCamInfo);
-      mApproxRgbdSync->registerCallback(boost::bind(&RgbdSensorsSyncNodelet::callbackRGBD, this, _1, _2, _3, _4));
-    }
+    mPubImuWindow = mNhP.advertise<zed_nodelets::ImuWindow>("imu_window", 1);
+    NODELET_INFO_STREAM("Advertised on topic " << mPubImuWindow.getTopic());
   }
-  else
-  {
-    NODELET_DEBUG("Using Exact Time sync");
-
-    if (mUseImu && mUseMag)
-    {
-      mExactFullSync = new message_filters::Synchronizer<ExactFullSyncPolicy>(
-          ExactFullSyncPolicy(mQueueSize), mSubRgbImage, mSubDepthImage, mSubRgbCamInfo, mSubDepthCamInfo, mSubImu,
-          mSubMag);
-      mExactFullSync->registerCallback(
-          boost::bind(&RgbdSensorsSyncNodelet::callbackFull, this, _1, _2, _3, _4, _5, _6));
 
-      NODELET_DEBUG("RGB + Depth + IMU + Magnetometer Sync");
-    }
-    else if (mUseImu)
-    {
-      NODELET_DEBUG("RGB + Depth + IMU Sync");
-
-      mExactRgbdImuSync = new message_filters::Synchronizer<ExactRgbdImuSyncPolicy>(
-          ExactRgbdImuSyncPolicy(mQueueSize), mSubRgbImage, mSubDepthImage, mSubRgbCamInfo, mSubDepthCamInfo, mSubImu);
-      mExactRgbdImuSync->registerCallback(
-          boost::bind(&RgbdSensorsSyncNodelet::callbackRGBDIMU, this, _1, _2, _3, _4, _5));
-    }
-    else if (mUseMag)
-    {
-      NODELET_DEBUG("RGB + Depth + Magnetometer Sync");
+  if (mSharedPayload)
+  {
+    // A few frames, in case the demux is late
+    mPayloadChannel = sl_tools::RgbdPayloadChannel::create(mPubRaw.getTopic(), 4);
+  }
 
-      mExactRgbdMagSync = new message_filters::Synchronizer<ExactRgbdMagSyncPolicy>(
-          ExactRgbdMagSyncPolicy(mQueueSize), mSubRgbImage, mSubDepthImage, mSubRgbCamInfo, mSubDepthCamInfo, mSubMag);
-      mExactRgbdMagSync->registerCallback(
-          boost::bind(&RgbdSensorsSyncNodelet::callbackRGBDMag, this, _1, _2, _3, _4, _5));
-    }
-    else
-    {
-      NODELET_DEBUG("RGB + Depth Sync");
+  NODELET_DEBUG("Using %s Time sync", mUseApproxSync ? "Approximate" : "Exact");
+  NODELET_DEBUG("RGB + Depth%s%s Sync", mUseImu ? " + IMU" : "", mUseMag ? " + Magnetometer" : "");
 
-      mExactRgbdSync = new message_filters::Synchronizer<ExactRgbdSyncPolicy>(
-          ExactRgbdSyncPolicy(mQueueSize), mSubRgbImage, mSubDepthImage, mSubRgbCamInfo, mSubDepthCamInfo);
-      mExactRgbdSync->registerCallback(boost::bind(&RgbdSensorsSyncNodelet::callbackRGBD, this, _1, _2, _3, _4));
-    }
-  }
+  // ----> Diagnostic
+  mDiagUpdater.add("RGBD Sensors Sync", this, &RgbdSensorsSyncNodelet::callback_updateDiagnostic);
+  mDiagUpdater.setHardwareID(getName());
+  mDiagTimer = mNh.createTimer(ros::Duration(1.0), [this](const ros::TimerEvent&) { mDiagUpdater.update(); });
+  // <---- Diagnostic
 
   // Create remappings
   ros::NodeHandle rgb_nh(mNh, mZedNodeletName + "/rgb");
@@ -169,25 +133,28 @@ void RgbdSensorsSyncNodelet::onInit()
   image_transport::TransportHints hintsRgb("raw", ros::TransportHints(), rgb_pnh);
   image_transport::TransportHints hintsDepth("raw", ros::TransportHints(), depth_pnh);
 
-  mSubRgbImage.subscribe(rgb_it, rgb_nh.resolveName("image_rect_color"), 1, hintsRgb);
-  mSubDepthImage.subscribe(depth_it, depth_nh.resolveName("depth_registered"), 1, hintsDepth);
-  mSubRgbCamInfo.subscribe(rgb_nh, "camera_info", 1);
-  mSubDepthCamInfo.subscribe(depth_nh, "camera_info", 1);
+  mSubRgbImage = rgb_it.subscribe(rgb_nh.resolveName("image_rect_color"), 1, &RgbdSensorsSyncNodelet::rgbCallback,
+                                  this, hintsRgb);
+  mSubDepthImage = depth_it.subscribe(depth_nh.resolveName("depth_registered"), 1,
+                                      &RgbdSensorsSyncNodelet::depthCallback, this, hintsDepth);
+  mSubRgbCamInfo = rgb_nh.subscribe("camera_info", 1, &RgbdSensorsSyncNodelet::rgbInfoCallback, this);
+  mSubDepthCamInfo = depth_nh.subscribe("camera_info", 1, &RgbdSensorsSyncNodelet::depthInfoCallback, this);
 
   NODELET_INFO_STREAM(" * Subscribed to topic: " << mSubRgbImage.getTopic().c_str());
   NODELET_INFO_STREAM(" * Subscribed to topic: " << mSubRgbCamInfo.getTopic().c_str());
   NODELET_INFO_STREAM(" * Subscribed to topic: " << mSubDepthImage.getTopic().c_str());
   NODELET_INFO_STREAM(" * Subscribed to topic: " << mSubDepthCamInfo.getTopic().c_str());
 
+  // The sensor samples are stored in the rings as soon as they are received: a short subscriber queue is enough
   if (mUseImu)
   {
-    mSubImu.subscribe(imu_nh, "data", 1);
+    mSubImu = imu_nh.subscribe("data", 10, &RgbdSensorsSyncNodelet::imuCallback, this);
     NODELET_INFO_STREAM(" * Subscribed to topic: " << mSubImu.getTopic().c_str());
   }
 
   if (mUseMag)
   {
-    mSubMag.subscribe(imu_nh, "mag", 1);
+    mSubMag = imu_nh.subscribe("mag", 10, &RgbdSensorsSyncNodelet::magCallback, this);
     NODELET_INFO_STREAM(" * Subscribed to topic: " << mSubMag.getTopic().c_str());
   }
 }
@@ -199,14 +166,400 @@ void RgbdSensorsSyncNodelet::readParameters()
   mNhP.getParam("zed_nodelet_name", mZedNodeletName);
   mNhP.getParam("approx_sync", mUseApproxSync);
   mNhP.getParam("queue_size", mQueueSize);
+  mNhP.getParam("image_queue_size", mImageQueueSize);
+  mImageQueueSize = std::max(mImageQueueSize, 1);
+  mNhP.getParam("max_interval", mMaxInterval);
+  mNhP.getParam("max_sensor_wait", mMaxSensorWait);
+  mNhP.getParam("imu_interpolation", mImuInterpolation);
+  mNhP.getParam("imu_window", mImuWindow);
   mNhP.getParam("sub_imu", mUseImu);
   mNhP.getParam("sub_mag", mUseMag);
+  mNhP.getParam("shared_payload", mSharedPayload);
 
   NODELET_INFO(" * zed_nodelet_name -> %s", mZedNodeletName.c_str());
   NODELET_INFO(" * approx_sync -> %s", mUseApproxSync ? "true" : "false");
   NODELET_INFO(" * queue_size  -> %d", mQueueSize);
+  NODELET_INFO(" * image_queue_size  -> %d", mImageQueueSize);
+  if (mUseApproxSync)
+  {
+    NODELET_INFO(" * max_interval -> %g", mMaxInterval);
+  }
+  NODELET_INFO(" * max_sensor_wait -> %g", mMaxSensorWait);
+  NODELET_INFO(" * imu_interpolation -> %s", mImuInterpolation ? "true" : "false");
+  NODELET_INFO(" * imu_window -> %s", mImuWindow ? "true" : "false");
   NODELET_INFO(" * sub_imu -> %s", mUseImu ? "true" : "false");
   NODELET_INFO(" * sub_mag -> %s", mUseMag ? "true" : "false");
+  NODELET_INFO(" * shared_payload -> %s", mSharedPayload ? "true" : "false");
+}
+
+void RgbdSensorsSyncNodelet::rgbCallback(const sensor_msgs::ImageConstPtr& msg)
+{
+  std::lock_guard<std::mutex> lock(mSyncMutex);
+  enqueue(mRgbQueue, msg, mImageQueueSize, mMsgsOverflowed);
+  matchFrames();
+  emitFrames();
+}
+
+void RgbdSensorsSyncNodelet::depthCallback(const sensor_msgs::ImageConstPtr& msg)
+{
+  std::lock_guard<std::mutex> lock(mSyncMutex);
+  enqueue(mDepthQueue, msg, mImageQueueSize, mMsgsOverflowed);
+  matchFrames();
+  emitFrames();
+}
+
+void RgbdSensorsSyncNodelet::rgbInfoCallback(const sensor_msgs::CameraInfoConstPtr& msg)
+{
+  std::lock_guard<std::mutex> lock(mSyncMutex);
+  enqueue(mRgbInfoQueue, msg, mImageQueueSize, mMsgsOverflowed);
+  matchFrames();
+  emitFrames();
+}
+
+void RgbdSensorsSyncNodelet::depthInfoCallback(const sensor_msgs::CameraInfoConstPtr& msg)
+{
+  std::lock_guard<std::mutex> lock(mSyncMutex);
+  enqueue(mDepthInfoQueue, msg, mImageQueueSize, mMsgsOverflowed);
+  matchFrames();
+  emitFrames();
+}
+
+void RgbdSensorsSyncNodelet::imuCallback(const sensor_msgs::ImuConstPtr& msg)
+{
+  std::lock_guard<std::mutex> lock(mSyncMutex);
+
+  // The samples must be sorted for the binary search
+  if (!mImuRing.empty() && msg->header.stamp <= mImuRing.back()->header.stamp)
+  {
+    return;
+  }
+  mImuRing.push(msg);
+
+  if (!mPendingFrames.empty())
+  {
+    emitFrames();
+  }
+}
+
+void RgbdSensorsSyncNodelet::magCallback(const sensor_msgs::MagneticFieldConstPtr& msg)
+{
+  std::lock_guard<std::mutex> lock(mSyncMutex);
+
+  if (!mMagRing.empty() && msg->header.stamp <= mMagRing.back()->header.stamp)
+  {
+    return;
+  }
+  mMagRing.push(msg);
+
+  if (!mPendingFrames.empty())
+  {
+    emitFrames();
+  }
+}
+
+void RgbdSensorsSyncNodelet::matchFrames()
+{
+  const double tol = mUseApproxSync ? mMaxInterval : 0.0;
+
+  bool matched = true;
+  while (matched && !mRgbQueue.empty())
+  {
+    matched = false;
+
+    for (size_t i = 0; i < mRgbQueue.size(); i++)
+    {
+      ros::Time stamp = mRgbQueue[i].msg->header.stamp;
+
+      int d = nearestQueued(mDepthQueue, stamp, tol);
+      int ri = nearestQueued(mRgbInfoQueue, stamp, tol);
+      int di = nearestQueued(mDepthInfoQueue, stamp, tol);
+      if (d < 0 || ri < 0 || di < 0)
+      {
+        continue;
+      }
+
+      Frame frame;
+      frame.stamp = stamp;
+      frame.rgb = mRgbQueue[i].msg;
+      frame.depth = mDepthQueue[d].msg;
+      frame.rgbInfo = mRgbInfoQueue[ri].msg;
+      frame.depthInfo = mDepthInfoQueue[di].msg;
+      frame.firstArrival = std::min({ mRgbQueue[i].arrival, mDepthQueue[d].arrival, mRgbInfoQueue[ri].arrival,
+                                      mDepthInfoQueue[di].arrival });
+      frame.matchTime = std::chrono::steady_clock::now();
+
+      // The older parts can no longer be matched: the frames are published in order
+      mFramesDropped += i;
+      mRgbQueue.erase(mRgbQueue.begin(), mRgbQueue.begin() + i + 1);
+      mDepthQueue.erase(mDepthQueue.begin(), mDepthQueue.begin() + d + 1);
+      mRgbInfoQueue.erase(mRgbInfoQueue.begin(), mRgbInfoQueue.begin() + ri + 1);
+      mDepthInfoQueue.erase(mDepthInfoQueue.begin(), mDepthInfoQueue.begin() + di + 1);
+
+      mPendingFrames.push_back(frame);
+      if (mPendingFrames.size() > static_cast<size_t>(mImageQueueSize))
+      {
+        mPendingFrames.pop_front();
+        mFramesDropped++;
+      }
+
+      matched = true;
+      break;
+    }
+  }
+}
+
+void RgbdSensorsSyncNodelet::emitFrames()
+{
+  std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+
+  while (!mPendingFrames.empty())
+  {
+    const Frame& frame = mPendingFrames.front();
+
+    // ----> Wait for a sensor sample newer than the frame, so that the nearest one is known
+    bool imuReady = !mUseImu || (!mImuRing.empty() && mImuRing.back()->header.stamp >= frame.stamp);
+    bool magReady = !mUseMag || (!mMagRing.empty() && mMagRing.back()->header.stamp >= frame.stamp);
+    bool timeout = std::chrono::duration<double>(now - frame.matchTime).count() > mMaxSensorWait;
+    if (!(imuReady && magReady) && !timeout)
+    {
+      break;
+    }
+    // <---- Wait for a sensor sample newer than the frame, so that the nearest one is known
+
+    sensor_msgs::ImuConstPtr imu = mUseImu ? imuAt(frame.stamp) : sensor_msgs::ImuConstPtr();
+    sensor_msgs::MagneticFieldConstPtr mag = mUseMag ? magAt(frame.stamp) : sensor_msgs::MagneticFieldConstPtr();
+
+    if ((mUseImu && !imu) || (mUseMag && !mag))
+    {
+      mFramesDropped++;
+      mPendingFrames.pop_front();
+      continue;
+    }
+    if (!(imuReady && magReady))
+    {
+      mSensorsTimeouts++;
+    }
+
+    // ----> Statistics
+    mMatchLatencyMean_msec->addValue(
+        std::chrono::duration_cast<std::chrono::microseconds>(now - frame.firstArrival).count() / 1000.);
+    if (imu)
+    {
+      mImuOffsetMean_msec->addValue(std::fabs((frame.stamp - imu->header.stamp).toSec()) * 1000.);
+    }
+    mFramesPublished++;
+    // <---- Statistics
+
+    if (mPubImuWindow && mPubImuWindow.getNumSubscribers() > 0)
+    {
+      publishImuWindow(frame.stamp);
+    }
+    mLastWindowStamp = frame.stamp;
+
+    if (mUseImu && mUseMag)
+    {
+      callbackFull(frame.rgb, frame.depth, frame.rgbInfo, frame.depthInfo, imu, mag);
+    }
+    else if (mUseImu)
+    {
+      callbackRGBDIMU(frame.rgb, frame.depth, frame.rgbInfo, frame.depthInfo, imu);
+    }
+    else if (mUseMag)
+    {
+      callbackRGBDMag(frame.rgb, frame.depth, frame.rgbInfo, frame.depthInfo, mag);
+    }
+    else
+    {
+      callbackRGBD(frame.rgb, frame.depth, frame.rgbInfo, frame.depthInfo);
+    }
+
+    mPendingFrames.pop_front();
+  }
+}
+
+sensor_msgs::ImuConstPtr RgbdSensorsSyncNodelet::imuAt(ros::Time stamp)
+{
+  const size_t count = mImuRing.size();
+  if (count == 0)
+  {
+    return nullptr;
+  }
+
+  const size_t lo = imuLowerBound(stamp);
+  if (lo == 0)
+  {
+    return mImuRing[0];
+  }
+  if (lo == count)
+  {
+    return mImuRing[count - 1];
+  }
+
+  const sensor_msgs::ImuConstPtr& prev = mImuRing[lo - 1];
+  const sensor_msgs::ImuConstPtr& next = mImuRing[lo];
+
+  if (!mImuInterpolation)
+  {
+    return ((stamp - prev->header.stamp) <= (next->header.stamp - stamp)) ? prev : next;
+  }
+
+  // ----> Linear interpolation of the measures, spherical interpolation of the orientation
+  const double ratio = (stamp - prev->header.stamp).toSec() / (next->header.stamp - prev->header.stamp).toSec();
+  auto lerp = [ratio](double a, double b) { return a + (b - a) * ratio; };
+
+  sensor_msgs::ImuPtr imu = boost::make_shared<sensor_msgs::Imu>(*next);
+  imu->header.stamp = stamp;
+  imu->angular_velocity.x = lerp(prev->angular_velocity.x, next->angular_velocity.x);
+  imu->angular_velocity.y = lerp(prev->angular_velocity.y, next->angular_velocity.y);
+  imu->angular_velocity.z = lerp(prev->angular_velocity.z, next->angular_velocity.z);
+  imu->linear_acceleration.x = lerp(prev->linear_acceleration.x, next->linear_acceleration.x);
+  imu->linear_acceleration.y = lerp(prev->linear_acceleration.y, next->linear_acceleration.y);
+  imu->linear_acceleration.z = lerp(prev->linear_acceleration.z, next->linear_acceleration.z);
+
+  tf2::Quaternion qPrev(prev->orientation.x, prev->orientation.y, prev->orientation.z, prev->orientation.w);
+  tf2::Quaternion qNext(next->orientation.x, next->orientation.y, next->orientation.z, next->orientation.w);
+  if (qPrev.length2() > 0.0 && qNext.length2() > 0.0)
+  {
+    tf2::Quaternion q = qPrev.slerp(qNext, ratio);
+    imu->orientation.x = q.x();
+    imu->orientation.y = q.y();
+    imu->orientation.z = q.z();
+    imu->orientation.w = q.w();
+  }
+  // <---- Linear interpolation of the measures, spherical interpolation of the orientation
+
+  return imu;
+}
+
+size_t RgbdSensorsSyncNodelet::imuLowerBound(ros::Time stamp) const
+{
+  size_t lo = 0, hi = mImuRing.size();
+  while (lo < hi)
+  {
+    size_t mid = (lo + hi) / 2;
+    if (mImuRing[mid]->header.stamp < stamp)
+    {
+      lo = mid + 1;
+    }
+    else
+    {
+      hi = mid;
+    }
+  }
+  return lo;
+}
+
+void RgbdSensorsSyncNodelet::publishImuWindow(ros::Time stamp)
+{
+  // ----> Window (previous frame, current frame]. The first window is empty
+  ros::Time prevStamp = mLastWindowStamp.isZero() ? stamp : mLastWindowStamp;
+
+  size_t begin = imuLowerBound(prevStamp);
+  while (begin < mImuRing.size() && mImuRing[begin]->header.stamp <= prevStamp)
+  {
+    begin++;
+  }
+  size_t end = imuLowerBound(stamp);
+  if (end < mImuRing.size() && mImuRing[end]->header.stamp == stamp)
+  {
+    end++;
+  }
+  end = std::max(begin, end);
+  // <---- Window (previous frame, current frame]. The first window is empty
+
+  // Reuse the storage of the previous message when no subscriber holds it
+  if (!mImuWindowMsg || !mImuWindowMsg.unique())
+  {
+    mImuWindowMsg = boost::make_shared<zed_nodelets::ImuWindow>();
+  }
+  zed_nodelets::ImuWindowPtr msg = mImuWindowMsg;
+
+  msg->header.stamp = stamp;
+  msg->header.frame_id = (end > begin) ? mImuRing[begin]->header.frame_id : std::string();
+  msg->previous_stamp = prevStamp;
+  msg->stamps.resize(end - begin);
+  msg->data.resize((end - begin) * zed_nodelets::ImuWindow::FIELDS);
+
+  float* data = msg->data.data();
+  for (size_t i = begin; i < end; i++)
+  {
+    const sensor_msgs::Imu& imu = *mImuRing[i];
+    msg->stamps[i - begin] = imu.header.stamp;
+    *data++ = imu.angular_velocity.x;
+    *data++ = imu.angular_velocity.y;
+    *data++ = imu.angular_velocity.z;
+    *data++ = imu.linear_acceleration.x;
+    *data++ = imu.linear_acceleration.y;
+    *data++ = imu.linear_acceleration.z;
+    *data++ = imu.orientation.x;
+    *data++ = imu.orientation.y;
+    *data++ = imu.orientation.z;
+    *data++ = imu.orientation.w;
+  }
+
+  mPubImuWindow.publish(msg);
+}
+
+sensor_msgs::MagneticFieldConstPtr RgbdSensorsSyncNodelet::magAt(ros::Time stamp)
+{
+  // Low rate sensor: linear search from the newest sample
+  sensor_msgs::MagneticFieldConstPtr best;
+  double bestDiff = 0.0;
+  for (size_t i = mMagRing.size(); i > 0; i--)
+  {
+    const sensor_msgs::MagneticFieldConstPtr& mag = mMagRing[i - 1];
+    double diff = std::fabs((mag->header.stamp - stamp).toSec());
+    if (best && diff >= bestDiff)
+    {
+      break;  // The samples are sorted: the distance can only grow
+    }
+    best = mag;
+    bestDiff = diff;
+  }
+  return best;
+}
+
+void RgbdSensorsSyncNodelet::callback_updateDiagnostic(diagnostic_updater::DiagnosticStatusWrapper& stat)
+{
+  std::lock_guard<std::mutex> lock(mSyncMutex);
+
+  if (mFramesPublished == 0)
+  {
+    stat.summary(diagnostic_msgs::DiagnosticStatus::WARN, "Waiting for synchronized data");
+  }
+  else
+  {
+    stat.summary(diagnostic_msgs::DiagnosticStatus::OK, "Synchronizing");
+  }
+
+  stat.addf("Published frames", "%lu", mFramesPublished);
+  stat.addf("Dropped frames", "%lu", mFramesDropped);
+  stat.addf("Dropped messages (queue full)", "%lu", mMsgsOverflowed);
+  stat.addf("Published without waiting for sensors", "%lu", mSensorsTimeouts);
+  stat.addf("Match latency", "Mean: %.1f msec", mMatchLatencyMean_msec->getMean());
+  if (mUseImu)
+  {
+    stat.addf("IMU offset", "Mean: %.2f msec%s", mImuOffsetMean_msec->getMean(),
+              mImuInterpolation ? " (interpolated)" : "");
+  }
+  stat.addf("Queued frames", "%lu", mPendingFrames.size());
+}
+
+void RgbdSensorsSyncNodelet::fillImages(zed_interfaces::RGBDSensorsPtr& outSyncMsg,
+                                        const sensor_msgs::ImageConstPtr& rgb, const sensor_msgs::ImageConstPtr& depth)
+{
+  if (mPayloadChannel)
+  {
+    // Only the metadata travel with the message, the demux gets the images from the channel
+    sl_tools::RgbdPayloadChannel::fillReference(*rgb, outSyncMsg->rgb);
+    sl_tools::RgbdPayloadChannel::fillReference(*depth, outSyncMsg->depth);
+    mPayloadChannel->add(outSyncMsg->header.stamp, rgb, depth);
+  }
+  else
+  {
+    outSyncMsg->rgb = *rgb;
+    outSyncMsg->depth = *depth;
+  }
 }
 
 void RgbdSensorsSyncNodelet::callbackRGBD(const sensor_msgs::ImageConstPtr& rgb,
@@ -215,11 +568,10 @@ void RgbdSensorsSyncNodelet::callbackRGBD(const sensor_msgs::ImageConstPtr& rgb,
                                           const sensor_msgs::CameraInfoConstPtr& depthCameraInfo)
 {
   // ----> Frequency calculation
-  static std::chrono::steady_clock::time_point last_time = std::chrono::steady_clock::now();
   std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
 
-  double elapsed_usec = std::chrono::duration_cast<std::chrono::microseconds>(now - last_time).count();
-  last_time = now;
+  double elapsed_usec = std::chrono::duration_cast<std::chrono::microseconds>(now - mLastCbTime).count();
+  mLastCbTime = now;
 
   double freq = 1e6 / elapsed_usec;
   NODELET_DEBUG("Freq: %.2f", freq);
@@ -244,8 +596,7 @@ void RgbdSensorsSyncNodelet::callbackRGBD(const sensor_msgs::ImageConstPtr& rgb,
   outSyncMsg->rgbCameraInfo = *rgbCameraInfo;
   outSyncMsg->depthCameraInfo = *depthCameraInfo;
 
-  outSyncMsg->rgb = *rgb;
-  outSyncMsg->depth = *depth;
+  fillImages(outSyncMsg, rgb, depth);
 
   mPubRaw.publish(outSyncMsg);
 
@@ -269,11 +620,10 @@ void RgbdSensorsSyncNodelet::callbackRGBDIMU(const sensor_msgs::ImageConstPtr& r
                                              const sensor_msgs::ImuConstPtr& imu)
 {
   // ----> Frequency calculation
-  static std::chrono::steady_clock::time_point last_time = std::chrono::steady_clock::now();
   std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
 
-  double elapsed_usec = std::chrono::duration_cast<std::chrono::microseconds>(now - last_time).count();
-  last_time = now;
+  double elapsed_usec = std::chrono::duration_cast<std::chrono::microseconds>(now - mLastCbTime).count();
+  mLastCbTime = now;
 
   double freq = 1e6 / elapsed_usec;
   NODELET_DEBUG("Freq: %.2f", freq);
@@ -303,8 +653,7 @@ void RgbdSensorsSyncNodelet::callbackRGBDIMU(const sensor_msgs::ImageConstPtr& r
   outSyncMsg->rgbCameraInfo = *rgbCameraInfo;
   outSyncMsg->depthCameraInfo = *depthCameraInfo;
 
-  outSyncMsg->rgb = *rgb;
-  outSyncMsg->depth = *depth;
+  fillImages(outSyncMsg, rgb, depth);
   outSyncMsg->imu = *imu;
 
   mPubRaw.publish(outSyncMsg);
@@ -329,11 +678,10 @@ void RgbdSensorsSyncNodelet::callbackRGBDMag(const sensor_msgs::ImageConstPtr& r
                                              const sensor_msgs::MagneticFieldConstPtr& mag)
 {
   // ----> Frequency calculation
-  static std::chrono::steady_clock::time_point last_time = std::chrono::steady_clock::now();
   std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
 
-  double elapsed_usec = std::chrono::duration_cast<std::chrono::microseconds>(now - last_time).count();
-  last_time = now;
+  double elapsed_usec = std::chrono::duration_cast<std::chrono::microseconds>(now - mLastCbTime).count();
+  mLastCbTime = now;
 
   double freq = 1e6 / elapsed_usec;
   NODELET_DEBUG("Freq: %.2f", freq);
@@ -363,8 +711,7 @@ void RgbdSensorsSyncNodelet::callbackRGBDMag(const sensor_msgs::ImageConstPtr& r
   outSyncMsg->rgbCameraInfo = *rgbCameraInfo;
   outSyncMsg->depthCameraInfo = *depthCameraInfo;
 
-  outSyncMsg->rgb = *rgb;
-  outSyncMsg->depth = *depth;
+  fillImages(outSyncMsg, rgb, depth);
   outSyncMsg->mag = *mag;
 
   mPubRaw.publish(outSyncMsg);
@@ -390,11 +737,10 @@ void RgbdSensorsSyncNodelet::callbackFull(const sensor_msgs::ImageConstPtr& rgb,
                                           const sensor_msgs::MagneticFieldConstPtr& mag)
 {
   // ----> Frequency calculation
-  static std::chrono::steady_clock::time_point last_time = std::chrono::steady_clock::now();
   std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
 
-  double elapsed_usec = std::chrono::duration_cast<std::chrono::microseconds>(now - last_time).count();
-  last_time = now;
+  double elapsed_usec = std::chrono::duration_cast<std::chrono::microseconds>(now - mLastCbTime).count();
+  mLastCbTime = now;
 
   double freq = 1e6 / elapsed_usec;
   NODELET_DEBUG("Freq: %.2f", freq);
@@ -427,8 +773,7 @@ void RgbdSensorsSyncNodelet::callbackFull(const sensor_msgs::ImageConstPtr& rgb,
   outSyncMsg->rgbCameraInfo = *rgbCameraInfo;
   outSyncMsg->depthCameraInfo = *depthCameraInfo;
 
-  outSyncMsg->rgb = *rgb;
-  outSyncMsg->depth = *depth;
+  fillImages(outSyncMsg, rgb, depth);
   outSyncMsg->imu = *imu;
   outSyncMsg->mag = *mag;
 
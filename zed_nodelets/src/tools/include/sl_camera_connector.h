@@ -0,0 +1,142 @@
+///////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2023, STEREOLABS.
+//
+// All rights reserved.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+///////////////////////////////////////////////////////////////////////////
+
+#ifndef SL_CAMERA_CONNECTOR_H
+#define SL_CAMERA_CONNECTOR_H
+
+#include <sl/Camera.hpp>
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+namespace sl_tools
+{
+/*! \brief Opens a camera on a dedicated thread, retrying with exponential backoff.
+ *
+ * The connector does not own the camera: opening and closing are delegated to the functions given to the
+ * constructor, so it can be driven by a synthetic source that fails or disconnects on demand.
+ * A connection is started by \ref requestConnection, which closes the camera before the first attempt, and
+ * its completion is signalled to the threads waiting in \ref waitConnected.
+ */
+class CameraConnector
+{
+public:
+  typedef std::chrono::steady_clock Clock;
+  typedef std::function<sl::ERROR_CODE()> OpenFunc;
+  typedef std::function<void()> CloseFunc;
+
+  enum class State
+  {
+    DISCONNECTED,  ///< No connection requested
+    CONNECTING,    ///< Trying to open the camera
+    CONNECTED      ///< The last attempt succeeded
+  };
+
+  /*! \brief Retry timing */
+  struct Params
+  {
+    double minDelay = 0.1;       ///< [sec] Delay after the first failed attempt
+    double maxDelay = 2.0;       ///< [sec] Maximum delay between two attempts
+    double backoffFactor = 2.0;  ///< Delay multiplier after each failed attempt
+  };
+
+  /*! \brief Connection statistics */
+  struct Stats
+  {
+    uint32_t connections = 0;                            ///< Successful connections
+    uint32_t attempts = 0;                               ///< Attempts of the current or last connection
+    double lastConnect_sec = 0.0;                        ///< Time from the request to the last success
+    double maxConnect_sec = 0.0;                         ///< Maximum connection time, first connection excluded
+    sl::ERROR_CODE lastError = sl::ERROR_CODE::SUCCESS;  ///< Result of the last attempt
+  };
+
+  /*! \brief Constructor, starts the connection thread
+   * \param open opens the camera, called by the connection thread
+   * \param close closes the camera if opened, called by the connection thread
+   * \param params retry timing
+   */
+  CameraConnector(OpenFunc open, CloseFunc close, const Params& params);
+
+  /*! \brief Destructor, stops the connection thread waiting for the running attempt */
+  ~CameraConnector();
+
+  /*! \brief Close the camera and try to open it until success. Ignored if a connection is already running */
+  void requestConnection();
+
+  /*! \brief Wait for the requested connection
+   * \param timeout maximum waiting time
+   * \return true if the camera is connected
+   */
+  bool waitConnected(Clock::duration timeout);
+
+  /*! \brief Stop the connection attempts and the thread, waiting for the running attempt */
+  void stop();
+
+  State getState();
+
+  Stats getStats();
+
+private:
+  void threadFunc();
+
+  OpenFunc mOpen;
+  CloseFunc mClose;
+  Params mParams;
+
+  std::thread mThread;
+  std::mutex mMutex;
+  std::condition_variable mCondVar;  // Signals requests, state changes and stop
+  State mState = State::DISCONNECTED;
+  bool mRequested = false;
+  bool mStop = false;
+  Clock::time_point mRequestTime;
+  Stats mStats;
+};
+
+/*! \brief Reaction of the grab loop to a failed grab */
+enum class GrabErrorAction
+{
+  RETRY,      ///< Grab again: the error can be transient
+  RECONNECT,  ///< Close and reopen the camera with \ref CameraConnector
+  STOP        ///< Stop the node: end of the SVO file or remote stream lost
+};
+
+/*! \brief Decide how the grab loop reacts to a grab error.
+ *  A live camera is reopened when no frame has been grabbed for `grace_sec`, or for at least
+ *  \ref REBOOT_GRACE_SEC while the SDK reports that it is rebooting the camera
+ * \param err the result of the grab, not `SUCCESS`
+ * \param svo true if the input is an SVO file
+ * \param stream true if the input is a remote stream
+ * \param sinceLastFrame_sec time since the last grabbed frame [sec]
+ * \param grace_sec time without frames before reopening the camera or stopping on a lost stream [sec]
+ */
+GrabErrorAction grabErrorAction(sl::ERROR_CODE err, bool svo, bool stream, double sinceLastFrame_sec,
+                                double grace_sec);
+
+/*! \brief Minimum time left to the SDK to reboot the camera by itself before reopening it [sec] */
+constexpr double REBOOT_GRACE_SEC = 5.0;
+
+}  // namespace sl_tools
+
+#endif  // SL_CAMERA_CONNECTOR_H
@@ -0,0 +1,151 @@
+///////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2023, STEREOLABS.
+//
+// All rights reserved.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+///////////////////////////////////////////////////////////////////////////
+
+#ifndef SL_EXECUTOR_H
+#define SL_EXECUTOR_H
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace sl_tools
+{
+/*! \brief Class of work submitted to the shared executor.
+ *  Lower values are served first.
+ */
+enum class TaskClass : int
+{
+  SENSORS = 0,      ///< IMU/Magnetometer/Barometer publishing
+  POINTCLOUD = 1,   ///< Point cloud conversion and publishing
+  OBJ_DET = 2,      ///< Object detection processing
+  FUSED_CLOUD = 3,  ///< Fused point cloud publishing
+};
+
+/*! \brief Worker pool shared by all the camera nodelets loaded in the same nodelet manager.
+ *
+ * Tasks are served by class first, then by the priority of the camera that posted them
+ * and finally by deadline (earliest first). A task is never started before its release time.
+ * The executor keeps track of the time spent by each registered camera to report its CPU share.
+ */
+class SharedExecutor
+{
+public:
+  typedef std::chrono::steady_clock Clock;
+
+  /*! \brief Get the executor of the process, creating it if required
+   * \param workers number of worker threads used when creating the executor. `0` for automatic
+   * \param workerInit function called by each worker thread when it starts, e.g. to apply the thread scheduling.
+   *        Used only when creating the executor
+   * \return the shared executor
+   */
+  static std::shared_ptr<SharedExecutor> getInstance(int workers = 0, std::function<void()> workerInit = nullptr);
+
+  ~SharedExecutor();
+
+  /*! \brief Register a camera client
+   * \param name the name of the client, used for logging
+   * \param priority the priority of the client, lower values are served first
+   * \return the client ID to be used when posting tasks
+   */
+  int registerClient(const std::string& name, int priority);
+
+  /*! \brief Unregister a client, dropping its queued tasks and waiting for the running ones
+   * \param clientId the client ID returned by \ref registerClient
+   */
+  void unregisterClient(int clientId);
+
+  /*! \brief Post a task
+   * \param clientId the client ID returned by \ref registerClient
+   * \param cls the class of the task
+   * \param release the task will not be started before this time
+   * \param deadline the time when the task is expected to be completed
+   * \param task the function to be executed
+   * \return false if the client is not registered or is being unregistered
+   */
+  bool post(int clientId, TaskClass cls, Clock::time_point release, Clock::time_point deadline,
+            std::function<void()> task);
+
+  /*! \brief Get the cumulative time spent executing tasks
+   * \param clientId the client ID returned by \ref registerClient
+   * \param client_nsec time spent executing the tasks of the client
+   * \param total_nsec time spent executing the tasks of all the clients
+   * \param late_count number of tasks of the client started after their deadline
+   */
+  void getStats(int clientId, uint64_t& client_nsec, uint64_t& total_nsec, uint64_t& late_count);
+
+  /*! \brief Number of worker threads */
+  int getWorkerCount() const
+  {
+    return static_cast<int>(mWorkers.size());
+  }
+
+  /*! \brief Number of registered clients */
+  int getClientCount();
+
+private:
+  SharedExecutor(int workers, std::function<void()> workerInit);
+
+  struct Task
+  {
+    int clientId;
+    TaskClass cls;
+    int priority;
+    uint64_t seq;
+    Clock::time_point release;
+    Clock::time_point deadline;
+    std::function<void()> func;
+  };
+
+  struct Client
+  {
+    std::string name;
+    int priority = 0;
+    int running = 0;
+    bool closing = false;  // No more tasks accepted
+    uint64_t busy_nsec = 0;
+    uint64_t late_count = 0;
+  };
+
+  void workerFunc(std::function<void()> workerInit);
+
+  // Return true if `a` must be served before `b`
+  static bool before(const Task& a, const Task& b);
+
+  std::vector<std::thread> mWorkers;
+  std::vector<Task> mQueue;
+  std::map<int, Client> mClients;
+  std::mutex mMutex;
+  std::condition_variable mCondVar;
+  int mNextClientId = 0;
+  uint64_t mNextSeq = 0;
+  uint64_t mTotalBusy_nsec = 0;
+  bool mStop = false;
+};
+
+}  // namespace sl_tools
+
+#endif  // SL_EXECUTOR_H
@@ -0,0 +1,100 @@
+///////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2023, STEREOLABS.
+//
+// All rights reserved.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+///////////////////////////////////////////////////////////////////////////
+#ifndef SL_RGBD_PAYLOAD_H
+#define SL_RGBD_PAYLOAD_H
+
+#include <ros/time.h>
+#include <sensor_msgs/Image.h>
+
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include "sl_tools.h"
+
+namespace sl_tools
+{
+/*! \brief In-process channel of the images synchronized by `RgbdSensorsSyncNodelet`.
+ *
+ * When the sync and the demux nodelets run in the same nodelet manager, the sync message can carry only the
+ * metadata of the images (`data` empty) while the images themselves are shared through this channel: the demux
+ * republishes the same shared pointers it gets from the channel, so no pixel is copied between the camera nodelet
+ * and the subscribers of the demux.
+ *
+ * The channels are registered by the resolved name of the sync topic and keep the last few payloads, so that a
+ * sync message can be resolved even if the demux is a few frames late.
+ */
+class RgbdPayloadChannel
+{
+public:
+  /*! \brief Create a channel and register it, replacing any channel previously registered with the same name
+   * \param topic the resolved name of the sync topic
+   * \param capacity maximum number of stored payloads
+   * \return the new channel. It is unregistered when the last reference is released
+   */
+  static std::shared_ptr<RgbdPayloadChannel> create(const std::string& topic, size_t capacity);
+
+  /*! \brief Get a registered channel
+   * \param topic the resolved name of the sync topic
+   * \return the channel, `nullptr` if not available
+   */
+  static std::shared_ptr<const RgbdPayloadChannel> find(const std::string& topic);
+
+  /*! \brief Store the images of a sync message, replacing the oldest payload if the channel is full
+   * \param stamp the timestamp of the sync message
+   * \param rgb the color image
+   * \param depth the depth image
+   */
+  void add(ros::Time stamp, const sensor_msgs::ImageConstPtr& rgb, const sensor_msgs::ImageConstPtr& depth);
+
+  /*! \brief Get the images of a sync message
+   * \param stamp the timestamp of the sync message
+   * \param rgb the color image
+   * \param depth the depth image
+   * \return false if the payload is no longer available
+   */
+  bool get(ros::Time stamp, sensor_msgs::ImageConstPtr& rgb, sensor_msgs::ImageConstPtr& depth) const;
+
+  /*! \brief Copy the metadata of an image, leaving `data` empty, to reference it in a sync message */
+  static void fillReference(const sensor_msgs::Image& img, sensor_msgs::Image& ref);
+
+  /*! \brief Test if an image of a sync message is a reference to an image stored in a channel */
+  static bool isReference(const sensor_msgs::Image& img)
+  {
+    return img.data.empty() && img.height > 0 && img.step > 0;
+  }
+
+private:
+  explicit RgbdPayloadChannel(size_t capacity);
+
+  struct Payload
+  {
+    ros::Time stamp;
+    sensor_msgs::ImageConstPtr rgb;
+    sensor_msgs::ImageConstPtr depth;
+  };
+
+  RingBuffer<Payload> mPayloads;
+  mutable std::mutex mMutex;
+};
+
+}  // namespace sl_tools
+
+#endif  // SL_RGBD_PAYLOAD_H
@@ -0,0 +1,92 @@
+///////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2023, STEREOLABS.
+//
+// All rights reserved.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+///////////////////////////////////////////////////////////////////////////
+
+#ifndef SL_STAMP_TRACKER_H
+#define SL_STAMP_TRACKER_H
+
+#include <cstdint>
+
+namespace sl_tools
+{
+/*! \brief Last timestamp of a data stream, used to skip the data already published and to measure the
+ * publishing period.
+ *
+ * Each camera owns its trackers: the state of a stream must never be shared by the cameras running in the same
+ * nodelet manager.
+ */
+class StampTracker
+{
+public:
+  /*! \brief Check if a timestamp differs from the last accepted one
+   * \param stamp_ns the timestamp in nanoseconds
+   */
+  bool isNew(uint64_t stamp_ns) const
+  {
+    return stamp_ns != mLast_ns;
+  }
+
+  /*! \brief Accept a timestamp if it differs from the last accepted one
+   * \param stamp_ns the timestamp in nanoseconds
+   * \param period_sec set to the time elapsed from the previous accepted timestamp, `0` for the first one
+   * \return false if the timestamp has already been accepted
+   */
+  bool update(uint64_t stamp_ns, double& period_sec)
+  {
+    period_sec = 0.0;
+    if (!isNew(stamp_ns))
+    {
+      return false;
+    }
+    if (mLast_ns != 0)
+    {
+      period_sec = static_cast<double>(static_cast<int64_t>(stamp_ns - mLast_ns)) / 1e9;
+    }
+    mLast_ns = stamp_ns;
+    return true;
+  }
+
+  /*! \brief Accept a timestamp if it differs from the last accepted one
+   * \return false if the timestamp has already been accepted
+   */
+  bool update(uint64_t stamp_ns)
+  {
+    double period_sec;
+    return update(stamp_ns, period_sec);
+  }
+
+  /*! \brief Forget the last timestamp: the next one is accepted without a period */
+  void reset()
+  {
+    mLast_ns = 0;
+  }
+
+  /*! \brief The last accepted timestamp in nanoseconds, `0` if none */
+  uint64_t last() const
+  {
+    return mLast_ns;
+  }
+
+private:
+  uint64_t mLast_ns = 0;
+};
+
+}  // namespace sl_tools
+
+#endif  // SL_STAMP_TRACKER_H
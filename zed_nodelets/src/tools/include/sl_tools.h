@@ -26,6 +26,7 @@
 #include <sl/Camera.hpp>
 #include <string>
 #include <vector>
+#include <zed_interfaces/Object.h>
 
 namespace sl_tools
 {
@@ -72,6 +73,25 @@ bool isZED2OrZED2i(sl::MODEL camModel);
  */
 bool isZEDX(sl::MODEL camModel);
 
+/*! \brief Label of an object class, from a table built once: no allocation per call
+ * \param objClass the object class
+ */
+const std::string& objClassLabel(sl::OBJECT_CLASS objClass);
+
+/*! \brief Label of an object subclass, from a table built once: no allocation per call
+ * \param objSubclass the object subclass
+ */
+const std::string& objSubclassLabel(sl::OBJECT_SUBCLASS objSubclass);
+
+/*! \brief Fill the objects of an `ObjectsStamped` message from the detected objects.
+ *  The message objects are resized to the detected ones and their storage, including the label strings, is reused
+ * \param objects : the detected objects
+ * \param trackingAvailable : true if object tracking is enabled
+ * \param msgObjects : the `objects` field of the message to fill
+ */
+void objectsToROSmsg(const std::vector<sl::ObjectData>& objects, bool trackingAvailable,
+                     std::vector<zed_interfaces::Object>& msgObjects);
+
 /*! \brief Creates an sl::Mat containing a ROI from a polygon
  *  \param poly the ROI polygon. Coordinates must be normalized from 0.0 to 1.0
  *  \param out_roi the `sl::Mat` containing the ROI
@@ -92,6 +112,15 @@ std::vector<std::vector<float>> parseStringVector(const std::string& input, std:
  */
 void imageToROSmsg(sensor_msgs::ImagePtr imgMsgPtr, sl::Mat img, std::string frameId, ros::Time t);
 
+/*! \brief sl::Mat to ros message conversion, writing directly into an existing message.
+ *  The data buffer of the message is reused if it is already large enough
+ * \param imgMsg : the image message to fill, e.g. the `image` field of a `stereo_msgs::DisparityImage`
+ * \param img : the image to publish
+ * \param frameId : the id of the reference frame of the image
+ * \param t : the ros::Time to stamp the image
+ */
+void imageToROSmsg(sensor_msgs::Image& imgMsg, sl::Mat img, std::string frameId, ros::Time t);
+
 /*! \brief Two sl::Mat to ros message conversion
  * \param imgMsgPtr : the image topic message to publish
  * \param left : the left image to publish
@@ -101,10 +130,90 @@ void imageToROSmsg(sensor_msgs::ImagePtr imgMsgPtr, sl::Mat img, std::string fra
  */
 void imagesToROSmsg(sensor_msgs::ImagePtr imgMsgPtr, sl::Mat left, sl::Mat right, std::string frameId, ros::Time t);
 
+/*! \brief Convert a float depth map in meters to 16 bit millimeters (OpenNI convention).
+ *  Values are rounded to the nearest millimeter (ties can differ by 1 mm because of the float precision).
+ *  NaN, infinite and not positive values are converted to `0`, values over 65.535 m are saturated to `65535`
+ * \param src : pointer to the first value of the float depth map
+ * \param srcStepBytes : size of a row of the float depth map in bytes
+ * \param dst : pointer to the first value of the 16 bit depth map
+ * \param dstStepBytes : size of a row of the 16 bit depth map in bytes
+ * \param width : image width [pixel]
+ * \param height : image height [pixel]
+ */
+void depthToU16mm(const float* src, size_t srcStepBytes, uint16_t* dst, size_t dstStepBytes, int width, int height);
+
+/*! \brief Convert a `F32_C1` depth map in meters to a `U16_C1` depth map in millimeters
+ * \param src : the float depth map, on CPU memory
+ * \param dst : the 16 bit depth map, (re)allocated on CPU memory only if size or type do not match
+ */
+void depthToU16mm(sl::Mat src, sl::Mat& dst);
+
+/*! \brief Limits of the depth filter applied by \ref filterDepth
+ */
+struct DepthFilterParams
+{
+  float confThreshold = 100.0f;  ///< Maximum confidence value [1,100] of a valid pixel (higher is less confident)
+  float minRange = 0.0f;         ///< Minimum valid depth [m]
+  float maxRange = 0.0f;         ///< Maximum valid depth [m], `0` for no limit
+};
+
+/*! \brief Mask a float depth map in meters by confidence and range in a single pass, writing the result.
+ *  Rows are processed in parallel. Invalid pixels are set to NaN
+ * \param depth : the `F32_C1` depth map in meters
+ * \param conf : the `F32_C1` confidence map, same size as `depth`
+ * \param params : confidence threshold and range limits
+ * \param dst : pointer to the first value of the filtered float depth map
+ * \param dstStepBytes : size of a row of the filtered depth map in bytes
+ */
+void filterDepth(sl::Mat depth, sl::Mat conf, const DepthFilterParams& params, float* dst, size_t dstStepBytes);
+
+/*! \brief Same as \ref filterDepth, but the result is converted to 16 bit millimeters as in \ref depthToU16mm.
+ *  Invalid pixels are set to `0`
+ */
+void filterDepthU16mm(sl::Mat depth, sl::Mat conf, const DepthFilterParams& params, uint16_t* dst,
+                      size_t dstStepBytes);
+
+/*! \brief Robust depth of a region of a float depth map in meters.
+ *  The region is sampled on a regular grid of at most `maxSamples` pixels, the median is computed on the valid
+ *  samples and the image position is the mean position of the samples within `inlierTol * median` of the median,
+ *  so that the background and the foreground occluders inside a bounding box are ignored
+ * \param depth : the `F32_C1` depth map in meters, on CPU memory
+ * \param x : left column of the region, clipped to the image
+ * \param y : top row of the region, clipped to the image
+ * \param width : width of the region [pixel]
+ * \param height : height of the region [pixel]
+ * \param inlierTol : relative tolerance of the inliers around the median
+ * \param maxSamples : maximum number of sampled pixels
+ * \param scratch : buffer for the valid samples, reused by the caller to avoid allocations
+ * \param median : median depth of the valid samples [m]
+ * \param u : column of the inliers centroid [pixel]
+ * \param v : row of the inliers centroid [pixel]
+ * \return the number of valid samples, `0` if the outputs are not valid
+ */
+size_t depthRoiMedian(sl::Mat depth, int x, int y, int width, int height, float inlierTol, size_t maxSamples,
+                      std::vector<float>& scratch, float& median, float& u, float& v);
+
 /*! \brief String tokenization
  */
 std::vector<std::string> split_string(const std::string& s, char seperator);
 
+/*! \brief Scheduling configuration of a thread
+ */
+struct ThreadSchedParams
+{
+  std::string policy = "SCHED_OTHER";  ///< 'SCHED_OTHER', 'SCHED_FIFO' or 'SCHED_RR'
+  int priority = 0;                    ///< Real-time priority [1,99], ignored with 'SCHED_OTHER'
+  std::vector<int> cpus;               ///< CPU cores allowed to run the thread. Empty for no affinity
+};
+
+/*! \brief Apply scheduling policy, priority and CPU affinity to the calling thread
+ * \param params the scheduling configuration
+ * \param error_return the description of the settings that could not be applied
+ * \return false if at least one setting has not been applied. The thread keeps the default values
+ *         for the settings that failed (e.g. missing privileges for real-time scheduling)
+ */
+bool setThreadScheduling(const ThreadSchedParams& params, std::string& error_return);
+
 /*!
  * \brief The CSmartMean class is used to
  * make a mobile window mean of a sequence of values
@@ -145,6 +254,98 @@ private:
   double mGamma;  ///< Weight value
 };
 
+/*!
+ * \brief The RingBuffer class stores the last values of a sequence.
+ * When the buffer is full a new value replaces the oldest one in O(1), without moving the others.
+ */
+template <typename T>
+class RingBuffer
+{
+public:
+  /*!
+   * \param capacity maximum number of stored values, `0` for no limit
+   */
+  explicit RingBuffer(size_t capacity = 0)
+  {
+    setCapacity(capacity);
+  }
+
+  /*!
+   * \brief Set the maximum number of stored values, clearing the buffer
+   */
+  void setCapacity(size_t capacity)
+  {
+    mCapacity = capacity;
+    mData.clear();
+    mData.reserve(capacity);
+    mHead = 0;
+  }
+
+  void clear()
+  {
+    mData.clear();
+    mHead = 0;
+  }
+
+  size_t size() const
+  {
+    return mData.size();
+  }
+
+  bool empty() const
+  {
+    return mData.empty();
+  }
+
+  /*!
+   * \brief Add a value, replacing the oldest one if the buffer is full
+   */
+  void push(const T& val)
+  {
+    if (mCapacity == 0 || mData.size() < mCapacity)
+    {
+      mData.push_back(val);
+    }
+    else
+    {
+      mData[mHead] = val;
+      mHead = (mHead + 1) % mCapacity;
+    }
+  }
+
+  /*!
+   * \brief The last added value. The buffer must not be empty
+   */
+  const T& back() const
+  {
+    return mData[(mHead + mData.size() - 1) % mData.size()];
+  }
+
+  /*!
+   * \brief The i-th stored value, `0` is the oldest one
+   */
+  const T& operator[](size_t i) const
+  {
+    return mData[(mHead + i) % mData.size()];
+  }
+
+  /*!
+   * \brief Copy the stored values to `out`, from the oldest to the newest
+   */
+  void copyTo(std::vector<T>& out) const
+  {
+    out.clear();
+    out.reserve(mData.size());
+    out.insert(out.end(), mData.begin() + mHead, mData.end());
+    out.insert(out.end(), mData.begin(), mData.begin() + mHead);
+  }
+
+private:
+  std::vector<T> mData;
+  size_t mCapacity = 0;
+  size_t mHead = 0;  ///< Index of the oldest value when the buffer is full
+};
+
 }  // namespace sl_tools
 
 #endif  // SL_TOOLS_H
@@ -0,0 +1,164 @@
+///////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2023, STEREOLABS.
+//
+// All rights reserved.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+///////////////////////////////////////////////////////////////////////////
+
+#include "sl_camera_connector.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace sl_tools
+{
+CameraConnector::CameraConnector(OpenFunc open, CloseFunc close, const Params& params)
+  : mOpen(std::move(open)), mClose(std::move(close)), mParams(params)
+{
+  mParams.minDelay = std::max(mParams.minDelay, 0.0);
+  mParams.maxDelay = std::max(mParams.maxDelay, mParams.minDelay);
+  mParams.backoffFactor = std::max(mParams.backoffFactor, 1.0);
+
+  mThread = std::thread(&CameraConnector::threadFunc, this);
+}
+
+CameraConnector::~CameraConnector()
+{
+  stop();
+}
+
+void CameraConnector::requestConnection()
+{
+  std::lock_guard<std::mutex> lock(mMutex);
+  if (mStop || mState == State::CONNECTING || mRequested)
+  {
+    return;
+  }
+  mRequested = true;
+  mRequestTime = Clock::now();
+  mCondVar.notify_all();
+}
+
+bool CameraConnector::waitConnected(Clock::duration timeout)
+{
+  std::unique_lock<std::mutex> lock(mMutex);
+  return mCondVar.wait_for(lock, timeout, [this] { return mStop || (!mRequested && mState == State::CONNECTED); }) &&
+         !mStop;
+}
+
+void CameraConnector::stop()
+{
+  {
+    std::lock_guard<std::mutex> lock(mMutex);
+    mStop = true;
+  }
+  mCondVar.notify_all();
+
+  if (mThread.joinable())
+  {
+    mThread.join();
+  }
+}
+
+CameraConnector::State CameraConnector::getState()
+{
+  std::lock_guard<std::mutex> lock(mMutex);
+  return mState;
+}
+
+CameraConnector::Stats CameraConnector::getStats()
+{
+  std::lock_guard<std::mutex> lock(mMutex);
+  return mStats;
+}
+
+void CameraConnector::threadFunc()
+{
+  std::unique_lock<std::mutex> lock(mMutex);
+
+  while (true)
+  {
+    mCondVar.wait(lock, [this] { return mRequested || mStop; });
+    if (mStop)
+    {
+      break;
+    }
+
+    mRequested = false;
+    mState = State::CONNECTING;
+    mStats.attempts = 0;
+
+    lock.unlock();
+    mClose();
+    lock.lock();
+
+    double delay = mParams.minDelay;
+    while (!mStop)
+    {
+      lock.unlock();
+      sl::ERROR_CODE err = mOpen();
+      lock.lock();
+
+      mStats.attempts++;
+      mStats.lastError = err;
+
+      if (err == sl::ERROR_CODE::SUCCESS)
+      {
+        mState = State::CONNECTED;
+        mStats.lastConnect_sec = std::chrono::duration<double>(Clock::now() - mRequestTime).count();
+        if (mStats.connections > 0)
+        {
+          mStats.maxConnect_sec = std::max(mStats.maxConnect_sec, mStats.lastConnect_sec);
+        }
+        mStats.connections++;
+        mCondVar.notify_all();
+        break;
+      }
+
+      // Exponential backoff, interrupted only by stop
+      mCondVar.wait_for(lock, std::chrono::duration<double>(delay), [this] { return mStop; });
+      delay = std::min(delay * mParams.backoffFactor, mParams.maxDelay);
+    }
+
+    if (mState != State::CONNECTED)
+    {
+      mState = State::DISCONNECTED;
+    }
+  }
+}
+
+GrabErrorAction grabErrorAction(sl::ERROR_CODE err, bool svo, bool stream, double sinceLastFrame_sec,
+                                double grace_sec)
+{
+  if (svo)
+  {
+    // An SVO file cannot be reopened
+    return (err == sl::ERROR_CODE::END_OF_SVOFILE_REACHED) ? GrabErrorAction::STOP : GrabErrorAction::RETRY;
+  }
+
+  if (stream)
+  {
+    return (sinceLastFrame_sec > grace_sec) ? GrabErrorAction::STOP : GrabErrorAction::RETRY;
+  }
+
+  if (err == sl::ERROR_CODE::CAMERA_REBOOTING)
+  {
+    grace_sec = std::max(grace_sec, REBOOT_GRACE_SEC);
+  }
+  return (sinceLastFrame_sec > grace_sec) ? GrabErrorAction::RECONNECT : GrabErrorAction::RETRY;
+}
+
+}  // namespace sl_tools
@@ -0,0 +1,392 @@
+///////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2023, STEREOLABS.
+//
+// All rights reserved.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+///////////////////////////////////////////////////////////////////////////
+
+#include "zed_nodelets/sl_depth_codec.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace sl_tools
+{
+namespace depth_codec
+{
+namespace
+{
+// Stream layout, all the integers are little endian uint32:
+// magic | width | height | max_error | tile_rows | tile_count | tile_count x tile_size | tile payloads
+const uint8_t MAGIC[4] = { 'R', 'V', 'L', '1' };
+const size_t HEADER_WORDS = 6;
+
+void putU32(uint8_t* dst, uint32_t value)
+{
+  dst[0] = static_cast<uint8_t>(value);
+  dst[1] = static_cast<uint8_t>(value >> 8);
+  dst[2] = static_cast<uint8_t>(value >> 16);
+  dst[3] = static_cast<uint8_t>(value >> 24);
+}
+
+uint32_t getU32(const uint8_t* src)
+{
+  return static_cast<uint32_t>(src[0]) | (static_cast<uint32_t>(src[1]) << 8) |
+         (static_cast<uint32_t>(src[2]) << 16) | (static_cast<uint32_t>(src[3]) << 24);
+}
+
+// Variable length code: 3 bits of payload per nibble, the 4th bit set if more nibbles follow.
+// Nibbles are packed MSB first in 32 bit words.
+class NibbleWriter
+{
+public:
+  // `dst` must be large enough for the whole encoded tile, see `maxTileSize`
+  explicit NibbleWriter(uint8_t* dst) : mBegin(dst), mPtr(dst)
+  {
+  }
+
+  void put(uint32_t value)
+  {
+    do
+    {
+      uint32_t nibble = value & 0x7;
+      value >>= 3;
+      if (value)
+      {
+        nibble |= 0x8;
+      }
+      mWord = (mWord << 4) | nibble;
+      if (++mNibbles == 8)
+      {
+        flushWord();
+      }
+    } while (value);
+  }
+
+  // Flush the last partial word and return the number of written bytes
+  size_t finish()
+  {
+    if (mNibbles)
+    {
+      mWord <<= 4 * (8 - mNibbles);
+      flushWord();
+    }
+    return mPtr - mBegin;
+  }
+
+private:
+  void flushWord()
+  {
+    putU32(mPtr, mWord);
+    mPtr += 4;
+    mWord = 0;
+    mNibbles = 0;
+  }
+
+  uint8_t* mBegin;
+  uint8_t* mPtr;
+  uint32_t mWord = 0;
+  int mNibbles = 0;
+};
+
+// Worst case: isolated valid pixels, one nibble for each run length and six for a 17 bit zig-zag delta
+inline size_t maxTileSize(size_t count)
+{
+  return count * 4 + 16;
+}
+
+class NibbleReader
+{
+public:
+  NibbleReader(const uint8_t* data, size_t size) : mPtr(data), mEnd(data + size)
+  {
+  }
+
+  // Return false if the stream is truncated or the value does not fit 32 bits
+  bool get(uint32_t& value)
+  {
+    value = 0;
+    for (int shift = 0; shift < 32; shift += 3)
+    {
+      if (!mNibbles)
+      {
+        if (mEnd - mPtr < 4)
+        {
+          return false;
+        }
+        mWord = getU32(mPtr);
+        mPtr += 4;
+        mNibbles = 8;
+      }
+      uint32_t nibble = mWord >> 28;
+      mWord <<= 4;
+      mNibbles--;
+
+      if (shift == 30 && (nibble & 0x4))
+      {
+        return false;  // Bit 32 set
+      }
+      value |= (nibble & 0x7) << shift;
+      if (!(nibble & 0x8))
+      {
+        return true;
+      }
+    }
+    return false;
+  }
+
+private:
+  const uint8_t* mPtr;
+  const uint8_t* mEnd;
+  uint32_t mWord = 0;
+  int mNibbles = 0;
+};
+
+// Bounded error quantization: valid values are mapped to bins of `2*maxError+1` millimeters,
+// `0` (invalid) is never produced for a valid value
+inline uint16_t quantize(uint16_t value, uint32_t step)
+{
+  return value ? static_cast<uint16_t>((value - 1) / step + 1) : 0;
+}
+
+inline uint16_t dequantize(uint16_t q, uint32_t step, uint32_t maxError)
+{
+  return q ? static_cast<uint16_t>(std::min<uint32_t>((q - 1) * step + 1 + maxError, 0xFFFF)) : 0;
+}
+
+void compressTile(const uint16_t* px, size_t count, std::vector<uint8_t>& out)
+{
+  out.resize(maxTileSize(count));
+  NibbleWriter writer(out.data());
+
+  const uint16_t* end = px + count;
+  int32_t previous = 0;
+
+  while (px != end)
+  {
+    uint32_t zeros = 0;
+    for (; px != end && *px == 0; px++)
+    {
+      zeros++;
+    }
+    writer.put(zeros);
+
+    uint32_t nonzeros = 0;
+    for (const uint16_t* p = px; p != end && *p != 0; p++)
+    {
+      nonzeros++;
+    }
+    writer.put(nonzeros);
+
+    for (uint32_t i = 0; i < nonzeros; i++)
+    {
+      int32_t current = *px++;
+      int32_t delta = current - previous;
+      writer.put((static_cast<uint32_t>(delta) << 1) ^ static_cast<uint32_t>(delta >> 31));  // zig-zag
+      previous = current;
+    }
+  }
+
+  out.resize(writer.finish());
+}
+
+bool decompressTile(const uint8_t* data, size_t size, uint16_t* px, size_t count)
+{
+  NibbleReader reader(data, size);
+
+  uint16_t* end = px + count;
+  uint32_t previous = 0;
+
+  while (px != end)
+  {
+    uint32_t zeros, nonzeros;
+    if (!reader.get(zeros) || zeros > static_cast<size_t>(end - px))
+    {
+      return false;
+    }
+    std::fill(px, px + zeros, 0);
+    px += zeros;
+
+    if (!reader.get(nonzeros) || nonzeros > static_cast<size_t>(end - px))
+    {
+      return false;
+    }
+    for (uint32_t i = 0; i < nonzeros; i++)
+    {
+      uint32_t zz;
+      if (!reader.get(zz))
+      {
+        return false;
+      }
+      previous += (zz >> 1) ^ (0u - (zz & 1));  // modular arithmetic, exact for valid streams
+      *px++ = static_cast<uint16_t>(previous);
+    }
+  }
+
+  return true;
+}
+}  // namespace
+
+bool compress(const uint16_t* depth, int width, int height, size_t stepBytes, int maxError, std::vector<uint8_t>& out,
+              int tileRows /*= 32*/)
+{
+  if (!depth || width <= 0 || height <= 0 || static_cast<uint64_t>(width) * height > MAX_PIXELS || maxError < 0 ||
+      maxError > 0x7FFF || tileRows <= 0)
+  {
+    return false;
+  }
+  if (stepBytes == 0)
+  {
+    stepBytes = width * sizeof(uint16_t);
+  }
+
+  const int tileCount = (height + tileRows - 1) / tileRows;
+  const uint32_t step = 2 * maxError + 1;
+
+  std::vector<std::vector<uint8_t>> tiles(tileCount);
+
+#pragma omp parallel for schedule(dynamic)
+  for (int t = 0; t < tileCount; t++)
+  {
+    const int row0 = t * tileRows;
+    const int rows = std::min(tileRows, height - row0);
+
+    // Contiguous copy of the band, RVL runs continue across the rows
+    std::vector<uint16_t> band(static_cast<size_t>(rows) * width);
+    for (int r = 0; r < rows; r++)
+    {
+      const uint16_t* src =
+          reinterpret_cast<const uint16_t*>(reinterpret_cast<const uint8_t*>(depth) + (row0 + r) * stepBytes);
+      uint16_t* dst = &band[static_cast<size_t>(r) * width];
+      if (maxError == 0)
+      {
+        memcpy(dst, src, width * sizeof(uint16_t));
+      }
+      else
+      {
+        for (int c = 0; c < width; c++)
+        {
+          dst[c] = quantize(src[c], step);
+        }
+      }
+    }
+
+    compressTile(band.data(), band.size(), tiles[t]);
+  }
+
+  size_t total = (HEADER_WORDS + tileCount) * 4;
+  for (const auto& tile : tiles)
+  {
+    total += tile.size();
+  }
+
+  out.resize(total);
+  uint8_t* ptr = out.data();
+  memcpy(ptr, MAGIC, 4);
+  putU32(ptr + 4, static_cast<uint32_t>(width));
+  putU32(ptr + 8, static_cast<uint32_t>(height));
+  putU32(ptr + 12, static_cast<uint32_t>(maxError));
+  putU32(ptr + 16, static_cast<uint32_t>(tileRows));
+  putU32(ptr + 20, static_cast<uint32_t>(tileCount));
+  ptr += HEADER_WORDS * 4;
+
+  for (const auto& tile : tiles)
+  {
+    putU32(ptr, static_cast<uint32_t>(tile.size()));
+    ptr += 4;
+  }
+  for (const auto& tile : tiles)
+  {
+    if (!tile.empty())
+    {
+      memcpy(ptr, tile.data(), tile.size());
+      ptr += tile.size();
+    }
+  }
+
+  return true;
+}
+
+bool decompress(const uint8_t* data, size_t size, std::vector<uint16_t>& depth, int& width, int& height)
+{
+  if (!data || size < HEADER_WORDS * 4 || memcmp(data, MAGIC, 4) != 0)
+  {
+    return false;
+  }
+
+  const uint32_t w = getU32(data + 4);
+  const uint32_t h = getU32(data + 8);
+  const uint32_t maxError = getU32(data + 12);
+  const uint32_t tileRows = getU32(data + 16);
+  const uint32_t tileCount = getU32(data + 20);
+
+  // The header is not trusted: the image size is bounded before allocating and each tile, that encodes at least
+  // one run, requires at least one word
+  if (w == 0 || h == 0 || static_cast<uint64_t>(w) * h > MAX_PIXELS || maxError > 0x7FFF || tileRows == 0 ||
+      tileCount != (h + tileRows - 1) / tileRows || (size - HEADER_WORDS * 4) / 8 < tileCount)
+  {
+    return false;
+  }
+
+  // ----> Tile offsets
+  std::vector<size_t> offsets(tileCount + 1);
+  offsets[0] = (HEADER_WORDS + tileCount) * 4;
+  for (uint32_t t = 0; t < tileCount; t++)
+  {
+    const size_t tileSize = getU32(data + (HEADER_WORDS + t) * 4);
+    if (tileSize < 4 || tileSize > size - offsets[t])
+    {
+      return false;
+    }
+    offsets[t + 1] = offsets[t] + tileSize;
+  }
+  // <---- Tile offsets
+
+  width = static_cast<int>(w);
+  height = static_cast<int>(h);
+  depth.resize(static_cast<size_t>(w) * h);
+
+  const uint32_t step = 2 * maxError + 1;
+  bool ok = true;
+
+#pragma omp parallel for schedule(dynamic) reduction(&& : ok)
+  for (int t = 0; t < static_cast<int>(tileCount); t++)
+  {
+    const size_t row0 = static_cast<size_t>(t) * tileRows;
+    const size_t rows = std::min<size_t>(tileRows, h - row0);
+    uint16_t* px = &depth[row0 * w];
+    const size_t count = rows * w;
+
+    if (!decompressTile(data + offsets[t], offsets[t + 1] - offsets[t], px, count))
+    {
+      ok = false;
+      continue;
+    }
+
+    if (maxError > 0)
+    {
+      for (size_t i = 0; i < count; i++)
+      {
+        px[i] = dequantize(px[i], step, maxError);
+      }
+    }
+  }
+
+  return ok;
+}
+
+}  // namespace depth_codec
+}  // namespace sl_tools
@@ -0,0 +1,258 @@
+///////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2023, STEREOLABS.
+//
+// All rights reserved.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+///////////////////////////////////////////////////////////////////////////
+
+#include "sl_executor.h"
+
+#include <ros/console.h>
+
+#include <algorithm>
+
+namespace sl_tools
+{
+std::shared_ptr<SharedExecutor> SharedExecutor::getInstance(int workers, std::function<void()> workerInit)
+{
+  // The executor lives as long as at least one camera uses it
+  static std::mutex instMutex;
+  static std::weak_ptr<SharedExecutor> instance;
+
+  std::lock_guard<std::mutex> lock(instMutex);
+
+  std::shared_ptr<SharedExecutor> exec = instance.lock();
+  if (!exec)
+  {
+    if (workers <= 0)
+    {
+      workers = std::max(2, static_cast<int>(std::thread::hardware_concurrency()) / 2);
+    }
+    exec.reset(new SharedExecutor(workers, workerInit));
+    instance = exec;
+  }
+
+  return exec;
+}
+
+SharedExecutor::SharedExecutor(int workers, std::function<void()> workerInit)
+{
+  ROS_INFO_STREAM("Starting shared executor with " << workers << " worker threads");
+
+  for (int i = 0; i < workers; i++)
+  {
+    mWorkers.emplace_back(&SharedExecutor::workerFunc, this, workerInit);
+  }
+}
+
+SharedExecutor::~SharedExecutor()
+{
+  {
+    std::lock_guard<std::mutex> lock(mMutex);
+    mStop = true;
+    mQueue.clear();
+  }
+  mCondVar.notify_all();
+
+  for (auto& worker : mWorkers)
+  {
+    if (worker.joinable())
+    {
+      worker.join();
+    }
+  }
+}
+
+int SharedExecutor::registerClient(const std::string& name, int priority)
+{
+  std::lock_guard<std::mutex> lock(mMutex);
+
+  int id = mNextClientId++;
+  Client& client = mClients[id];
+  client.name = name;
+  client.priority = priority;
+
+  ROS_INFO_STREAM("Shared executor: registered '" << name << "' with priority " << priority);
+
+  return id;
+}
+
+void SharedExecutor::unregisterClient(int clientId)
+{
+  std::unique_lock<std::mutex> lock(mMutex);
+
+  auto it = mClients.find(clientId);
+  if (it == mClients.end())
+  {
+    return;
+  }
+
+  it->second.closing = true;
+
+  mQueue.erase(std::remove_if(mQueue.begin(), mQueue.end(),
+                              [clientId](const Task& task) { return task.clientId == clientId; }),
+               mQueue.end());
+
+  // Tasks reference the client object, wait for the running ones before returning
+  mCondVar.wait(lock, [this, clientId]() { return mClients[clientId].running == 0; });
+
+  mClients.erase(clientId);
+}
+
+bool SharedExecutor::post(int clientId, TaskClass cls, Clock::time_point release, Clock::time_point deadline,
+                          std::function<void()> task)
+{
+  {
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    auto it = mClients.find(clientId);
+    if (mStop || it == mClients.end() || it->second.closing)
+    {
+      return false;
+    }
+
+    Task newTask;
+    newTask.clientId = clientId;
+    newTask.cls = cls;
+    newTask.priority = it->second.priority;
+    newTask.seq = mNextSeq++;
+    newTask.release = release;
+    newTask.deadline = deadline;
+    newTask.func = std::move(task);
+
+    mQueue.push_back(std::move(newTask));
+  }
+  mCondVar.notify_all();
+
+  return true;
+}
+
+void SharedExecutor::getStats(int clientId, uint64_t& client_nsec, uint64_t& total_nsec, uint64_t& late_count)
+{
+  std::lock_guard<std::mutex> lock(mMutex);
+
+  auto it = mClients.find(clientId);
+  client_nsec = (it != mClients.end()) ? it->second.busy_nsec : 0;
+  late_count = (it != mClients.end()) ? it->second.late_count : 0;
+  total_nsec = mTotalBusy_nsec;
+}
+
+int SharedExecutor::getClientCount()
+{
+  std::lock_guard<std::mutex> lock(mMutex);
+  return static_cast<int>(mClients.size());
+}
+
+bool SharedExecutor::before(const Task& a, const Task& b)
+{
+  if (a.cls != b.cls)
+  {
+    return a.cls < b.cls;
+  }
+  if (a.priority != b.priority)
+  {
+    return a.priority < b.priority;
+  }
+  if (a.deadline != b.deadline)
+  {
+    return a.deadline < b.deadline;
+  }
+  return a.seq < b.seq;
+}
+
+void SharedExecutor::workerFunc(std::function<void()> workerInit)
+{
+  if (workerInit)
+  {
+    workerInit();
+  }
+
+  std::unique_lock<std::mutex> lock(mMutex);
+
+  while (!mStop)
+  {
+    // ----> Select the best released task
+    Clock::time_point now = Clock::now();
+    Clock::time_point nextRelease = Clock::time_point::max();
+    auto best = mQueue.end();
+
+    for (auto it = mQueue.begin(); it != mQueue.end(); ++it)
+    {
+      if (it->release > now)
+      {
+        nextRelease = std::min(nextRelease, it->release);
+        continue;
+      }
+
+      if (best == mQueue.end() || before(*it, *best))
+      {
+        best = it;
+      }
+    }
+    // <---- Select the best released task
+
+    if (best == mQueue.end())
+    {
+      if (nextRelease == Clock::time_point::max())
+      {
+        mCondVar.wait(lock);
+      }
+      else
+      {
+        mCondVar.wait_until(lock, nextRelease);
+      }
+      continue;
+    }
+
+    Task task = std::move(*best);
+    mQueue.erase(best);
+
+    Client& client = mClients[task.clientId];
+    client.running++;
+    if (now > task.deadline)
+    {
+      client.late_count++;
+    }
+
+    lock.unlock();
+
+    Clock::time_point start = Clock::now();
+    try
+    {
+      task.func();
+    }
+    catch (const std::exception& e)
+    {
+      ROS_ERROR_STREAM("Shared executor: task failed: " << e.what());
+    }
+    uint64_t elapsed_nsec = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count();
+
+    lock.lock();
+
+    Client& cl = mClients[task.clientId];
+    cl.busy_nsec += elapsed_nsec;
+    cl.running--;
+    mTotalBusy_nsec += elapsed_nsec;
+
+    if (cl.running == 0)
+    {
+      // Wake up a possible `unregisterClient` waiting for the tasks to complete
+      mCondVar.notify_all();
+    }
+  }
+}
+
+}  // namespace sl_tools
@@ -0,0 +1,183 @@
+///////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2023, STEREOLABS.
+//
+// All rights reserved.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+///////////////////////////////////////////////////////////////////////////
+
+#include "zed_nodelets/sl_pose_history.h"
+
+#include "sl_tools.h"
+
+#include <algorithm>
+#include <map>
+#include <mutex>
+
+namespace sl_tools
+{
+namespace
+{
+std::mutex registryMutex;
+std::map<std::string, std::weak_ptr<PoseHistory>> registry;
+
+tf2::Transform interpolate(const tf2::Transform& a, const tf2::Transform& b, double ratio)
+{
+  return tf2::Transform(a.getRotation().slerp(b.getRotation(), ratio), a.getOrigin().lerp(b.getOrigin(), ratio));
+}
+}  // namespace
+
+std::shared_ptr<PoseHistory> PoseHistory::create(const std::string& name, size_t capacity)
+{
+  std::shared_ptr<PoseHistory> history(new PoseHistory(capacity));
+
+  std::lock_guard<std::mutex> lock(registryMutex);
+  registry[name] = history;
+
+  return history;
+}
+
+std::shared_ptr<const PoseHistory> PoseHistory::find(const std::string& name)
+{
+  std::lock_guard<std::mutex> lock(registryMutex);
+
+  auto it = registry.find(name);
+  if (it == registry.end())
+  {
+    return nullptr;
+  }
+
+  std::shared_ptr<PoseHistory> history = it->second.lock();
+  if (!history)
+  {
+    registry.erase(it);
+  }
+  return history;
+}
+
+class PoseHistory::Samples : public RingBuffer<Sample>
+{
+public:
+  using RingBuffer<Sample>::RingBuffer;
+};
+
+PoseHistory::PoseHistory(size_t capacity) : mSamples(std::make_unique<Samples>(std::max<size_t>(capacity, 2)))
+{
+}
+
+PoseHistory::~PoseHistory() = default;
+
+void PoseHistory::add(ros::Time stamp, const tf2::Transform& odom2base, const tf2::Transform& map2base)
+{
+  std::unique_lock<std::shared_mutex> lock(mMutex);
+
+  if (!mSamples->empty() && stamp <= mSamples->back().stamp)
+  {
+    return;  // The samples must be sorted for the binary search
+  }
+
+  Sample sample;
+  sample.stamp = stamp;
+  sample.odom2base = odom2base;
+  sample.map2base = map2base;
+  mSamples->push(sample);
+}
+
+void PoseHistory::clear()
+{
+  std::unique_lock<std::shared_mutex> lock(mMutex);
+  mSamples->clear();
+}
+
+bool PoseHistory::lookup(ros::Time stamp, Sample& sample) const
+{
+  std::shared_lock<std::shared_mutex> lock(mMutex);
+  return lookupUnlocked(stamp, sample);
+}
+
+size_t PoseHistory::lookup(const std::vector<ros::Time>& stamps, std::vector<Sample>& samples,
+                           std::vector<uint8_t>& valid) const
+{
+  samples.resize(stamps.size());
+  valid.resize(stamps.size());
+
+  size_t found = 0;
+
+  std::shared_lock<std::shared_mutex> lock(mMutex);
+  for (size_t i = 0; i < stamps.size(); i++)
+  {
+    valid[i] = lookupUnlocked(stamps[i], samples[i]) ? 1 : 0;
+    found += valid[i];
+  }
+
+  return found;
+}
+
+bool PoseHistory::getTimeRange(ros::Time& oldest, ros::Time& newest) const
+{
+  std::shared_lock<std::shared_mutex> lock(mMutex);
+
+  if (mSamples->empty())
+  {
+    return false;
+  }
+
+  oldest = (*mSamples)[0].stamp;
+  newest = mSamples->back().stamp;
+  return true;
+}
+
+bool PoseHistory::lookupUnlocked(ros::Time stamp, Sample& sample) const
+{
+  const size_t count = mSamples->size();
+  if (count == 0 || stamp < (*mSamples)[0].stamp || stamp > mSamples->back().stamp)
+  {
+    return false;
+  }
+
+  // ----> Binary search of the first sample not older than `stamp`
+  size_t first = 0;
+  size_t last = count - 1;
+  while (first < last)
+  {
+    size_t mid = first + (last - first) / 2;
+    if ((*mSamples)[mid].stamp < stamp)
+    {
+      first = mid + 1;
+    }
+    else
+    {
+      last = mid;
+    }
+  }
+  // <---- Binary search of the first sample not older than `stamp`
+
+  const Sample& after = (*mSamples)[first];
+  if (after.stamp == stamp || first == 0)
+  {
+    sample = after;
+    return true;
+  }
+
+  const Sample& before = (*mSamples)[first - 1];
+  double ratio = (stamp - before.stamp).toSec() / (after.stamp - before.stamp).toSec();
+
+  sample.stamp = stamp;
+  sample.odom2base = interpolate(before.odom2base, after.odom2base, ratio);
+  sample.map2base = interpolate(before.map2base, after.map2base, ratio);
+  return true;
+}
+
+}  // namespace sl_tools
@@ -0,0 +1,103 @@
+///////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2023, STEREOLABS.
+//
+// All rights reserved.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+///////////////////////////////////////////////////////////////////////////
+#include "sl_rgbd_payload.h"
+
+#include <algorithm>
+#include <map>
+
+namespace sl_tools
+{
+namespace
+{
+std::mutex registryMutex;
+std::map<std::string, std::weak_ptr<RgbdPayloadChannel>> registry;
+}  // namespace
+
+std::shared_ptr<RgbdPayloadChannel> RgbdPayloadChannel::create(const std::string& topic, size_t capacity)
+{
+  std::shared_ptr<RgbdPayloadChannel> channel(new RgbdPayloadChannel(capacity));
+
+  std::lock_guard<std::mutex> lock(registryMutex);
+  registry[topic] = channel;
+
+  return channel;
+}
+
+std::shared_ptr<const RgbdPayloadChannel> RgbdPayloadChannel::find(const std::string& topic)
+{
+  std::lock_guard<std::mutex> lock(registryMutex);
+
+  auto it = registry.find(topic);
+  if (it == registry.end())
+  {
+    return nullptr;
+  }
+
+  std::shared_ptr<RgbdPayloadChannel> channel = it->second.lock();
+  if (!channel)
+  {
+    registry.erase(it);
+  }
+  return channel;
+}
+
+RgbdPayloadChannel::RgbdPayloadChannel(size_t capacity) : mPayloads(std::max<size_t>(capacity, 1))
+{
+}
+
+void RgbdPayloadChannel::add(ros::Time stamp, const sensor_msgs::ImageConstPtr& rgb,
+                             const sensor_msgs::ImageConstPtr& depth)
+{
+  std::lock_guard<std::mutex> lock(mMutex);
+  mPayloads.push({ stamp, rgb, depth });
+}
+
+bool RgbdPayloadChannel::get(ros::Time stamp, sensor_msgs::ImageConstPtr& rgb,
+                             sensor_msgs::ImageConstPtr& depth) const
+{
+  std::lock_guard<std::mutex> lock(mMutex);
+
+  // Few payloads, the requested one is usually the newest
+  for (size_t i = mPayloads.size(); i > 0; i--)
+  {
+    const Payload& payload = mPayloads[i - 1];
+    if (payload.stamp == stamp)
+    {
+      rgb = payload.rgb;
+      depth = payload.depth;
+      return true;
+    }
+  }
+
+  return false;
+}
+
+void RgbdPayloadChannel::fillReference(const sensor_msgs::Image& img, sensor_msgs::Image& ref)
+{
+  ref.header = img.header;
+  ref.height = img.height;
+  ref.width = img.width;
+  ref.encoding = img.encoding;
+  ref.is_bigendian = img.is_bigendian;
+  ref.step = img.step;
+  ref.data.clear();
+}
+
+}  // namespace sl_tools
@@ -19,11 +19,19 @@
 ///////////////////////////////////////////////////////////////////////////
 
 #include <sensor_msgs/image_encodings.h>
+#include <pthread.h>
+#include <sched.h>
 #include <sys/stat.h>
 
+#include <algorithm>
 #include <boost/make_shared.hpp>
+#include <cmath>
+#include <cstring>
 #include <experimental/filesystem>  // for std::experimental::filesystem::absolute
+#include <limits>
 #include <sstream>
+#include <thread>
+#include <type_traits>
 #include <vector>
 
 #include "sl_tools.h"
@@ -164,6 +172,89 @@ bool isZEDX(sl::MODEL camModel)
   return false;
 }
 
+namespace
+{
+template <typename E>
+const std::string& enumLabel(E value)
+{
+  // Constant tables shared by all the cameras, initialized once in a thread-safe way
+  static const std::vector<std::string> labels = [] {
+    std::vector<std::string> table;
+    for (int i = 0; i < static_cast<int>(E::LAST); i++)
+    {
+      table.push_back(sl::toString(static_cast<E>(i)).c_str());
+    }
+    return table;
+  }();
+  static const std::string unknown = "UNKNOWN";
+
+  int idx = static_cast<int>(value);
+  return (idx >= 0 && idx < static_cast<int>(labels.size())) ? labels[idx] : unknown;
+}
+}  // namespace
+
+const std::string& objClassLabel(sl::OBJECT_CLASS objClass)
+{
+  return enumLabel(objClass);
+}
+
+const std::string& objSubclassLabel(sl::OBJECT_SUBCLASS objSubclass)
+{
+  return enumLabel(objSubclass);
+}
+
+void objectsToROSmsg(const std::vector<sl::ObjectData>& objects, bool trackingAvailable,
+                     std::vector<zed_interfaces::Object>& msgObjects)
+{
+  msgObjects.resize(objects.size());
+
+  size_t idx = 0;
+  for (const sl::ObjectData& data : objects)
+  {
+    zed_interfaces::Object& obj = msgObjects[idx];
+
+    obj.label = objClassLabel(data.label);
+    obj.sublabel = objSubclassLabel(data.sublabel);
+    obj.label_id = data.raw_label;
+    obj.instance_id = data.id;
+    obj.confidence = data.confidence;
+
+    memcpy(&(obj.position[0]), &(data.position[0]), 3 * sizeof(float));
+    memcpy(&(obj.position_covariance[0]), &(data.position_covariance[0]), 6 * sizeof(float));
+    memcpy(&(obj.velocity[0]), &(data.velocity[0]), 3 * sizeof(float));
+
+    obj.tracking_available = trackingAvailable;
+    obj.tracking_state = static_cast<int8_t>(data.tracking_state);
+    obj.action_state = static_cast<int8_t>(data.action_state);
+
+    // The reused elements must not keep the boxes of the previous message
+    if (data.bounding_box_2d.size() == 4)
+    {
+      memcpy(&(obj.bounding_box_2d.corners[0]), &(data.bounding_box_2d[0]), 8 * sizeof(unsigned int));
+    }
+    else
+    {
+      obj.bounding_box_2d = decltype(obj.bounding_box_2d)();
+    }
+    if (data.bounding_box.size() == 8)
+    {
+      memcpy(&(obj.bounding_box_3d.corners[0]), &(data.bounding_box[0]), 24 * sizeof(float));
+    }
+    else
+    {
+      obj.bounding_box_3d = decltype(obj.bounding_box_3d)();
+    }
+
+    memcpy(&(obj.dimensions_3d[0]), &(data.dimensions[0]), 3 * sizeof(float));
+
+    // Body Detection is in a separate module in ZED SDK v4
+    obj.skeleton_available = false;
+
+    // at the end of the loop
+    idx++;
+  }
+}
+
 void imageToROSmsg(sensor_msgs::ImagePtr imgMsgPtr, sl::Mat img, std::string frameId, ros::Time t)
 {
   if (!imgMsgPtr)
@@ -171,66 +262,71 @@ void imageToROSmsg(sensor_msgs::ImagePtr imgMsgPtr, sl::Mat img, std::string fra
     return;
   }
 
-  imgMsgPtr->header.stamp = t;
-  imgMsgPtr->header.frame_id = frameId;
-  imgMsgPtr->height = img.getHeight();
-  imgMsgPtr->width = img.getWidth();
+  imageToROSmsg(*imgMsgPtr, img, frameId, t);
+}
+
+void imageToROSmsg(sensor_msgs::Image& imgMsg, sl::Mat img, std::string frameId, ros::Time t)
+{
+  imgMsg.header.stamp = t;
+  imgMsg.header.frame_id = frameId;
+  imgMsg.height = img.getHeight();
+  imgMsg.width = img.getWidth();
 
   int num = 1;  // for endianness detection
-  imgMsgPtr->is_bigendian = !(*(char*)&num == 1);
+  imgMsg.is_bigendian = !(*(char*)&num == 1);
 
-  imgMsgPtr->step = img.getStepBytes();
+  imgMsg.step = img.getStepBytes();
 
-  size_t size = imgMsgPtr->step * imgMsgPtr->height;
-  imgMsgPtr->data.resize(size);
+  size_t size = imgMsg.step * imgMsg.height;
+  imgMsg.data.resize(size);
 
   sl::MAT_TYPE dataType = img.getDataType();
 
   switch (dataType)
   {
     case sl::MAT_TYPE::F32_C1: /**< float 1 channel.*/
-      imgMsgPtr->encoding = sensor_msgs::image_encodings::TYPE_32FC1;
-      memcpy((char*)(&imgMsgPtr->data[0]), img.getPtr<sl::float1>(), size);
+      imgMsg.encoding = sensor_msgs::image_encodings::TYPE_32FC1;
+      memcpy((char*)(&imgMsg.data[0]), img.getPtr<sl::float1>(), size);
       break;
 
     case sl::MAT_TYPE::F32_C2: /**< float 2 channels.*/
-      imgMsgPtr->encoding = sensor_msgs::image_encodings::TYPE_32FC2;
-      memcpy((char*)(&imgMsgPtr->data[0]), img.getPtr<sl::float2>(), size);
+      imgMsg.encoding = sensor_msgs::image_encodings::TYPE_32FC2;
+      memcpy((char*)(&imgMsg.data[0]), img.getPtr<sl::float2>(), size);
       break;
 
     case sl::MAT_TYPE::F32_C3: /**< float 3 channels.*/
-      imgMsgPtr->encoding = sensor_msgs::image_encodings::TYPE_32FC3;
-      memcpy((char*)(&imgMsgPtr->data[0]), img.getPtr<sl::float3>(), size);
+      imgMsg.encoding = sensor_msgs::image_encodings::TYPE_32FC3;
+      memcpy((char*)(&imgMsg.data[0]), img.getPtr<sl::float3>(), size);
       break;
 
     case sl::MAT_TYPE::F32_C4: /**< float 4 channels.*/
-      imgMsgPtr->encoding = sensor_msgs::image_encodings::TYPE_32FC4;
-      memcpy((char*)(&imgMsgPtr->data[0]), img.getPtr<sl::float4>(), size);
+      imgMsg.encoding = sensor_msgs::image_encodings::TYPE_32FC4;
+      memcpy((char*)(&imgMsg.data[0]), img.getPtr<sl::float4>(), size);
       break;
 
     case sl::MAT_TYPE::U8_C1: /**< unsigned char 1 channel.*/
-      imgMsgPtr->encoding = sensor_msgs::image_encodings::MONO8;
-      memcpy((char*)(&imgMsgPtr->data[0]), img.getPtr<sl::uchar1>(), size);
+      imgMsg.encoding = sensor_msgs::image_encodings::MONO8;
+      memcpy((char*)(&imgMsg.data[0]), img.getPtr<sl::uchar1>(), size);
       break;
 
     case sl::MAT_TYPE::U8_C2: /**< unsigned char 2 channels.*/
-      imgMsgPtr->encoding = sensor_msgs::image_encodings::TYPE_8UC2;
-      memcpy((char*)(&imgMsgPtr->data[0]), img.getPtr<sl::uchar2>(), size);
+      imgMsg.encoding = sensor_msgs::image_encodings::TYPE_8UC2;
+      memcpy((char*)(&imgMsg.data[0]), img.getPtr<sl::uchar2>(), size);
       break;
 
     case sl::MAT_TYPE::U8_C3: /**< unsigned char 3 channels.*/
-      imgMsgPtr->encoding = sensor_msgs::image_encodings::BGR8;
-      memcpy((char*)(&imgMsgPtr->data[0]), img.getPtr<sl::uchar3>(), size);
+      imgMsg.encoding = sensor_msgs::image_encodings::BGR8;
+      memcpy((char*)(&imgMsg.data[0]), img.getPtr<sl::uchar3>(), size);
       break;
 
     case sl::MAT_TYPE::U8_C4: /**< unsigned char 4 channels.*/
-      imgMsgPtr->encoding = sensor_msgs::image_encodings::BGRA8;
-      memcpy((char*)(&imgMsgPtr->data[0]), img.getPtr<sl::uchar4>(), size);
+      imgMsg.encoding = sensor_msgs::image_encodings::BGRA8;
+      memcpy((char*)(&imgMsg.data[0]), img.getPtr<sl::uchar4>(), size);
       break;
 
     case sl::MAT_TYPE::U16_C1: /**< unsigned short 1 channel.*/
-      imgMsgPtr->encoding = sensor_msgs::image_encodings::TYPE_16UC1;
-      memcpy((uint16_t*)(&imgMsgPtr->data[0]), img.getPtr<sl::ushort1>(), size);
+      imgMsg.encoding = sensor_msgs::image_encodings::TYPE_16UC1;
+      memcpy((uint16_t*)(&imgMsg.data[0]), img.getPtr<sl::ushort1>(), size);
       break;
   }
 }
@@ -340,6 +436,177 @@ void imagesToROSmsg(sensor_msgs::ImagePtr imgMsgPtr, sl::Mat left, sl::Mat right
   }
 }
 
+void depthToU16mm(const float* src, size_t srcStepBytes, uint16_t* dst, size_t dstStepBytes, int width, int height)
+{
+  for (int r = 0; r < height; r++)
+  {
+    const uint32_t* srcRow =
+        reinterpret_cast<const uint32_t*>(reinterpret_cast<const uint8_t*>(src) + r * srcStepBytes);
+    uint16_t* dstRow = reinterpret_cast<uint16_t*>(reinterpret_cast<uint8_t*>(dst) + r * dstStepBytes);
+
+    // Branchless body, vectorized by the compiler also without fast-math
+#pragma omp simd
+    for (int c = 0; c < width; c++)
+    {
+      // NaN, infinite and negative values are replaced by 0 working on the IEEE-754 bits
+      uint32_t bits = srcRow[c];
+      uint32_t valid = ((bits & 0x7F800000u) != 0x7F800000u) & ((bits >> 31) == 0u);
+      bits &= 0u - valid;
+
+      float v;
+      memcpy(&v, &bits, sizeof(float));
+      float mm = std::min(v * 1000.0f + 0.5f, 65535.0f);  // round to nearest and saturate
+      dstRow[c] = static_cast<uint16_t>(static_cast<int32_t>(mm));
+    }
+  }
+}
+
+void depthToU16mm(sl::Mat src, sl::Mat& dst)
+{
+  if (dst.getWidth() != src.getWidth() || dst.getHeight() != src.getHeight() ||
+      dst.getDataType() != sl::MAT_TYPE::U16_C1)
+  {
+    dst.alloc(src.getResolution(), sl::MAT_TYPE::U16_C1, sl::MEM::CPU);
+  }
+
+  depthToU16mm(src.getPtr<sl::float1>(), src.getStepBytes(), dst.getPtr<sl::ushort1>(), dst.getStepBytes(),
+               static_cast<int>(src.getWidth()), static_cast<int>(src.getHeight()));
+  dst.timestamp = src.timestamp;
+}
+
+namespace
+{
+// `OutT` is `float` for meters with NaN as invalid value, or `uint16_t` for millimeters with 0 as invalid value
+template <typename OutT>
+void filterDepthImpl(sl::Mat depth, sl::Mat conf, const DepthFilterParams& params, OutT* dst, size_t dstStepBytes)
+{
+  const int width = static_cast<int>(depth.getWidth());
+  const int height = static_cast<int>(depth.getHeight());
+  const size_t depthStep = depth.getStepBytes();
+  const size_t confStep = conf.getStepBytes();
+  const uint8_t* depthPtr = reinterpret_cast<const uint8_t*>(depth.getPtr<sl::float1>());
+  const uint8_t* confPtr = reinterpret_cast<const uint8_t*>(conf.getPtr<sl::float1>());
+
+  const float confThresh = params.confThreshold;
+  const float minRange = params.minRange;
+  const float maxRange = params.maxRange > 0.0f ? params.maxRange : std::numeric_limits<float>::max();
+
+#pragma omp parallel for
+  for (int r = 0; r < height; r++)
+  {
+    const float* depthRow = reinterpret_cast<const float*>(depthPtr + r * depthStep);
+    const float* confRow = reinterpret_cast<const float*>(confPtr + r * confStep);
+    OutT* dstRow = reinterpret_cast<OutT*>(reinterpret_cast<uint8_t*>(dst) + r * dstStepBytes);
+
+#pragma omp simd
+    for (int c = 0; c < width; c++)
+    {
+      float d = depthRow[c];
+      // Comparisons with NaN and infinite depth values are false
+      uint32_t valid = (confRow[c] <= confThresh) & (d >= minRange) & (d <= maxRange);
+
+      // Bitwise select of the valid values, keeps the loop free of branches
+      uint32_t mask = 0u - valid;
+      uint32_t bits;
+      memcpy(&bits, &d, sizeof(float));
+      bits &= mask;
+
+      if constexpr (std::is_same<OutT, float>::value)
+      {
+        bits |= 0x7FC00000u & ~mask;  // quiet NaN
+        memcpy(&dstRow[c], &bits, sizeof(float));
+      }
+      else
+      {
+        memcpy(&d, &bits, sizeof(float));
+        float mm = std::min(d * 1000.0f + 0.5f, 65535.0f);
+        dstRow[c] = static_cast<OutT>(static_cast<int32_t>(mm));
+      }
+    }
+  }
+}
+}  // namespace
+
+void filterDepth(sl::Mat depth, sl::Mat conf, const DepthFilterParams& params, float* dst, size_t dstStepBytes)
+{
+  filterDepthImpl<float>(depth, conf, params, dst, dstStepBytes);
+}
+
+void filterDepthU16mm(sl::Mat depth, sl::Mat conf, const DepthFilterParams& params, uint16_t* dst,
+                      size_t dstStepBytes)
+{
+  filterDepthImpl<uint16_t>(depth, conf, params, dst, dstStepBytes);
+}
+
+size_t depthRoiMedian(sl::Mat depth, int x, int y, int width, int height, float inlierTol, size_t maxSamples,
+                      std::vector<float>& scratch, float& median, float& u, float& v)
+{
+  scratch.clear();
+
+  // ----> Clip the region
+  const int x0 = std::max(0, x);
+  const int y0 = std::max(0, y);
+  const int x1 = std::min(static_cast<int>(depth.getWidth()), x + width);
+  const int y1 = std::min(static_cast<int>(depth.getHeight()), y + height);
+  if (x1 <= x0 || y1 <= y0 || maxSamples == 0)
+  {
+    return 0;
+  }
+  // <---- Clip the region
+
+  const size_t area = static_cast<size_t>(x1 - x0) * (y1 - y0);
+  const int stride = std::max(1, static_cast<int>(std::ceil(std::sqrt(static_cast<double>(area) / maxSamples))));
+
+  const float* data = depth.getPtr<float>(sl::MEM::CPU);
+  const size_t step = depth.getStepBytes(sl::MEM::CPU);
+
+  for (int r = y0; r < y1; r += stride)
+  {
+    const float* row = reinterpret_cast<const float*>(reinterpret_cast<const uint8_t*>(data) + r * step);
+    for (int c = x0; c < x1; c += stride)
+    {
+      if (std::isfinite(row[c]) && row[c] > 0.0f)
+      {
+        scratch.push_back(row[c]);
+      }
+    }
+  }
+
+  const size_t count = scratch.size();
+  if (count == 0)
+  {
+    return 0;
+  }
+
+  std::nth_element(scratch.begin(), scratch.begin() + count / 2, scratch.end());
+  median = scratch[count / 2];
+
+  // ----> Inliers centroid: second pass on the same grid
+  const float tol = inlierTol * median;
+  double sumU = 0.0, sumV = 0.0;
+  size_t inliers = 0;
+  for (int r = y0; r < y1; r += stride)
+  {
+    const float* row = reinterpret_cast<const float*>(reinterpret_cast<const uint8_t*>(data) + r * step);
+    for (int c = x0; c < x1; c += stride)
+    {
+      if (std::fabs(row[c] - median) <= tol)  // false for NaN
+      {
+        sumU += c;
+        sumV += r;
+        inliers++;
+      }
+    }
+  }
+  // <---- Inliers centroid
+
+  // The median itself is always an inlier
+  u = static_cast<float>(sumU / inliers);
+  v = static_cast<float>(sumV / inliers);
+
+  return count;
+}
+
 std::vector<std::string> split_string(const std::string& s, char seperator)
 {
   std::vector<std::string> output;
@@ -356,6 +623,76 @@ std::vector<std::string> split_string(const std::string& s, char seperator)
   return output;
 }
 
+bool setThreadScheduling(const ThreadSchedParams& params, std::string& error_return)
+{
+  bool ret = true;
+  error_return.clear();
+
+  // ----> Scheduling policy and priority
+  int policy = SCHED_OTHER;
+  if (params.policy == "SCHED_FIFO")
+  {
+    policy = SCHED_FIFO;
+  }
+  else if (params.policy == "SCHED_RR")
+  {
+    policy = SCHED_RR;
+  }
+  else if (params.policy != "SCHED_OTHER")
+  {
+    error_return += "unknown policy '" + params.policy + "'; ";
+    ret = false;
+  }
+
+  if (policy != SCHED_OTHER)
+  {
+    sched_param sch;
+    sch.sched_priority =
+        std::max(sched_get_priority_min(policy), std::min(params.priority, sched_get_priority_max(policy)));
+
+    int err = pthread_setschedparam(pthread_self(), policy, &sch);
+    if (err != 0)
+    {
+      error_return += params.policy + " (priority " + std::to_string(sch.sched_priority) + ") not applied: " +
+                      std::string(strerror(err)) + "; ";
+      ret = false;
+    }
+  }
+  // <---- Scheduling policy and priority
+
+  // ----> CPU affinity
+  if (!params.cpus.empty())
+  {
+    cpu_set_t cpuset;
+    CPU_ZERO(&cpuset);
+
+    int nCpus = static_cast<int>(std::thread::hardware_concurrency());
+    for (int cpu : params.cpus)
+    {
+      if (cpu < 0 || (nCpus > 0 && cpu >= nCpus))
+      {
+        error_return += "CPU " + std::to_string(cpu) + " not available; ";
+        ret = false;
+        continue;
+      }
+      CPU_SET(cpu, &cpuset);
+    }
+
+    if (CPU_COUNT(&cpuset) > 0)
+    {
+      int err = pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpuset);
+      if (err != 0)
+      {
+        error_return += "CPU affinity not applied: " + std::string(strerror(err)) + "; ";
+        ret = false;
+      }
+    }
+  }
+  // <---- CPU affinity
+
+  return ret;
+}
+
 inline bool contains(std::vector<sl::float2>& poly, sl::float2 test)
 {
   int i, j;
@@ -21,6 +21,7 @@
 #ifndef ZED_WRAPPER_NODELET_H
 #define ZED_WRAPPER_NODELET_H
 
+#include <diagnostic_msgs/DiagnosticStatus.h>
 #include <diagnostic_updater/diagnostic_updater.h>
 #include <dynamic_reconfigure/server.h>
 #include <geometry_msgs/PointStamped.h>
@@ -38,9 +39,16 @@
 
 #include <sl/Camera.hpp>
 
+#include "sl_camera_connector.h"
+#include "zed_nodelets/sl_depth_codec.h"
+#include "sl_executor.h"
+#include "zed_nodelets/sl_pose_history.h"
+#include "sl_stamp_tracker.h"
 #include "sl_tools.h"
 
 // Dynamic reconfiguration
+#include <zed_nodelets/GetPoseAtTime.h>
+#include <zed_nodelets/ObjectsDepthStamped.h>
 #include <zed_nodelets/ZedConfig.h>
 
 // Services
@@ -64,6 +72,9 @@
 #include <geometry_msgs/PoseWithCovarianceStamped.h>
 #include <nav_msgs/Odometry.h>
 #include <nav_msgs/Path.h>
+#include <zed_interfaces/ObjectsStamped.h>
+#include <sensor_msgs/CameraInfo.h>
+#include <sensor_msgs/CompressedImage.h>
 #include <sensor_msgs/FluidPressure.h>
 #include <sensor_msgs/Imu.h>
 #include <sensor_msgs/MagneticField.h>
@@ -74,9 +85,13 @@
 #include <stereo_msgs/DisparityImage.h>
 #include <tf2_geometry_msgs/tf2_geometry_msgs.h>
 
+#include <atomic>
+#include <bitset>
+#include <chrono>
 #include <condition_variable>
 #include <memory>
 #include <mutex>
+#include <shared_mutex>
 #include <thread>
 
 namespace zed_nodelets
@@ -87,6 +102,69 @@ typedef enum
   CUSTOM   //!< Custom Rescale Factor
 } PubRes;
 
+typedef enum
+{
+  GOV_POINTCLOUD,  //!< Halve the point cloud publishing rate
+  GOV_STEREO,      //!< Skip the side-by-side stereo images
+  GOV_DEPTH,       //!< Halve the depth, disparity and confidence publishing rate
+  GOV_OBJ_DET      //!< Halve the object detection processing rate
+} GovStep;
+
+typedef enum
+{
+  STARTUP_PARAMETERS,     //!< Parameters read
+  STARTUP_CAMERA_OPEN,    //!< Camera opened
+  STARTUP_PUBLISHERS,     //!< Topics and services advertised
+  STARTUP_NODELET_READY,  //!< Threads started, `onInit` completed
+  STARTUP_FIRST_FRAME,    //!< First frame grabbed
+  STARTUP_FIRST_IMU,      //!< First IMU sample published
+  STARTUP_POS_TRACKING,   //!< Positional tracking enabled
+  STARTUP_MAPPING,        //!< Spatial mapping enabled
+  STARTUP_OBJ_DET,        //!< Object detection enabled
+  STARTUP_PHASE_COUNT
+} StartupPhase;
+
+typedef enum
+{
+  WARMUP_POS_TRACKING = 1,  //!< Enable the positional tracking
+  WARMUP_MAPPING = 2,       //!< Enable the spatial mapping
+  WARMUP_OBJ_DET = 4        //!< Enable the object detection
+} WarmupModule;
+
+/*! \brief Immutable snapshot of the camera calibration at the publishing resolution.
+ *  Built once when the camera is opened and replaced as a whole when the calibration changes.
+ */
+struct CalibSnapshot
+{
+  sl::Resolution resol;       //!< Publishing resolution the parameters refer to
+  float fx = 0.0f;            //!< Left rectified camera focal length [pixel]
+  float fy = 0.0f;            //!< Left rectified camera focal length [pixel]
+  float cx = 0.0f;            //!< Left rectified camera optical center [pixel]
+  float cy = 0.0f;            //!< Left rectified camera optical center [pixel]
+  float baseline = 0.0f;      //!< Stereo baseline [m]
+  float minDisparity = 0.0f;  //!< Disparity at the minimum depth (DisparityImage convention)
+  float maxDisparity = 0.0f;  //!< Disparity at the maximum depth (DisparityImage convention)
+
+  sensor_msgs::CameraInfo leftCamInfo;
+  sensor_msgs::CameraInfo rightCamInfo;
+  sensor_msgs::CameraInfo leftCamInfoRaw;
+  sensor_msgs::CameraInfo rightCamInfoRaw;
+  sensor_msgs::CameraInfo depthCamInfo;
+};
+typedef std::shared_ptr<const CalibSnapshot> CalibSnapshotPtr;
+
+/*! \brief Immutable snapshot of the dynamic transforms of the base frame.
+ *  Published by the writers of the positional tracking state and read without locking.
+ */
+struct PoseSnapshot
+{
+  ros::Time stamp;           //!< Timestamp of the frame the transforms refer to
+  tf2::Transform odom2base;  //!< Coordinates of the base in odometry frame
+  tf2::Transform map2base;   //!< Coordinates of the base in map frame
+  tf2::Transform map2odom;   //!< Coordinates of the odometry frame in map frame
+};
+typedef std::shared_ptr<const PoseSnapshot> PoseSnapshotPtr;
+
 class ZEDWrapperNodelet : public nodelet::Nodelet
 {
   typedef enum _dyn_params
@@ -108,6 +186,9 @@ class ZEDWrapperNodelet : public nodelet::Nodelet
     WB_TEMP = 14
   } DynParams;
 
+  // Camera settings to be applied, indexed by `sl::VIDEO_SETTINGS`
+  typedef std::bitset<static_cast<size_t>(sl::VIDEO_SETTINGS::LAST)> CamSettingsMask;
+
 public:
   /*! \brief Default constructor
    */
@@ -158,6 +239,38 @@ protected:
    */
   void readSvoParams();
 
+  /*! \brief Reads threads scheduling parameters from the param server
+   */
+  void readThreadsParams();
+
+  /*! \brief Apply scheduling policy, priority and CPU affinity to the calling thread
+   * \param threadName the name of the thread, used for logging
+   * \param sched the scheduling configuration
+   */
+  void applyThreadSched(const std::string& threadName, const sl_tools::ThreadSchedParams& sched);
+
+  /*! \brief Reads load governor parameters from the param server
+   */
+  void readGovernorParams();
+
+  /*! \brief Update the degradation level of the load governor
+   * \param mean_proc_sec the mean processing time of the grab loop, from the return of `grab` to the end of the
+   *        publishing
+   */
+  void updateGovernor(double mean_proc_sec);
+
+  /*! \brief Check if a processing step has been shed by the load governor
+   */
+  bool isGovShed(GovStep step);
+
+  /*! \brief Check if a processing step must be skipped for the current frame because of the load governor
+   */
+  bool govSkipFrame(GovStep step);
+
+  /*! \brief Publish the status of the load governor
+   */
+  void publishGovernorStatus();
+
   /*! \brief Reads dynamic parameters from the param server
    */
   void readDynParams();
@@ -174,6 +287,53 @@ protected:
    */
   void sensors_thread_func();
 
+  /*! \brief Modules warmup thread function: enables the optional modules requested by the grab thread, so that
+   *         loading the tracking area memory or the object detection model does not stop the grabbing
+   */
+  void warmup_thread_func();
+
+  /*! \brief Request the background start of an optional module. Ignored if already pending
+   * \param module : the module to be started
+   */
+  void requestWarmup(WarmupModule module);
+
+  /*! \brief Record the time of a startup phase, only the first call for each phase is considered
+   * \param phase : the phase reached
+   */
+  void markStartupPhase(StartupPhase phase);
+
+  /*! \brief Publish the startup phases reached so far. Requires `mStartupMutex` locked
+   */
+  void publishStartupTimeline();
+
+  /*! \brief Camera controls thread function: applies the camera settings changed by dynamic reconfigure and
+   *         periodically reads back the values controlled by the camera in automatic mode
+   */
+  void cam_ctrl_thread_func();
+
+  /*! \brief Sensors data publishing task, replaces the sensors thread when the shared executor is enabled.
+   *         Reschedules itself at the sensors publishing rate
+   */
+  void sensors_task_func();
+
+  /*! \brief Pointcloud publishing task, replaces the pointcloud thread when the shared executor is enabled
+   */
+  void pointcloud_task_func();
+
+  /*! \brief Object detection publishing function
+   */
+  void obj_det_thread_func();
+
+  /*! \brief Object detection publishing task, replaces the object detection thread when the shared executor is
+   * enabled
+   */
+  void obj_det_task_func();
+
+  /*! \brief Post the object detection publishing task to the shared executor, with the rate limit. Must be called
+   * with `mObjDetDataMutex` locked
+   */
+  void postObjDetTask();
+
   /*! \brief Publish odometry status message
    */
   void publishPoseStatus();
@@ -202,20 +362,33 @@ protected:
    */
   void publishOdom(tf2::Transform odom2baseTransf, sl::Pose& slPose, ros::Time t);
 
-  /*! \brief Publish the odom -> base_link TF
-   * \param t : the ros::Time to stamp the image
+  /*! \brief Set the visual odometry solution used as starting point of the IMU propagation
+   * \param odom2baseTransf : the latest visual odometry pose
+   * \param t : the timestamp of the frame
    */
-  void publishTFs(ros::Time t);
+  void updateImuOdomAnchor(const tf2::Transform& odom2baseTransf, ros::Time t);
 
-  /*! \brief Publish the odom -> base_link TF
-   * \param t : the ros::Time to stamp the image
+  /*! \brief Propagate the latest visual odometry with a new IMU sample and publish the high-rate odometry
+   * \param imuData : the IMU sample
+   * \param t : the timestamp of the IMU sample
    */
-  void publishOdomTF(ros::Time t);
+  void propagateImuOdom(const sl::SensorsData::IMUData& imuData, ros::Time t);
 
-  /*! \brief Publish the map -> odom TF
-   * \param t : the ros::Time to stamp the image
+  /*! \brief Publish the odom -> base_link TF and, if enabled, the map -> odom TF
+   *         with a single `sendTransform` call
+   * \param t : the ros::Time to stamp the TFs
    */
-  void publishPoseTF(ros::Time t);
+  void publishTFs(ros::Time t);
+
+  /*! \brief Fill a TF message from a transform
+   * \param msg : the message to be filled
+   * \param transf : the transform
+   * \param frameId : the parent frame
+   * \param childFrameId : the child frame
+   * \param t : the ros::Time to stamp the TF
+   */
+  void fillTransformStamped(geometry_msgs::TransformStamped& msg, const tf2::Transform& transf,
+                            const std::string& frameId, const std::string& childFrameId, ros::Time t);
 
   /*!
    * \brief Publish IMU frame once as static TF
@@ -242,14 +415,31 @@ protected:
    */
   void publishDepth(sensor_msgs::ImagePtr imgMsgPtr, sl::Mat depth, ros::Time t);
 
+  /*! \brief Publish a 16 bit millimeter depth image compressed with `sl_tools::depth_codec`
+   * \param depthMm : the `U16_C1` depth image to publish
+   * \param t : the ros::Time to stamp the depth image
+   */
+  void publishDepthCompressed(sl::Mat depthMm, ros::Time t);
+
+  /*! \brief Publish the depth image masked by confidence and range limits
+   * \param depth : the float depth image in meters
+   * \param conf : the confidence map
+   * \param t : the ros::Time to stamp the depth image
+   */
+  void publishDepthFiltered(sl::Mat depth, sl::Mat conf, ros::Time t);
+
   /*! \brief Publish a single pointCloud with a ros Publisher
    */
   void publishPointCloud();
 
-  /*! \brief Publish a fused pointCloud with a ros Publisher
+  /*! \brief Callback to publish the fused pointCloud at the requested frequency
    */
   void callback_pubFusedPointCloud(const ros::TimerEvent& e);
 
+  /*! \brief Publish a fused pointCloud with a ros Publisher
+   */
+  void publishFusedPointCloud();
+
   /*!
    * @brief Publish Color and Depth images
    */
@@ -273,28 +463,55 @@ protected:
    */
   void publishSensData(ros::Time t = ros::Time(0));
 
-  /*! \brief Get the information of the ZED cameras and store them in an
-   * information message
-   * \param zed : the sl::zed::Camera* pointer to an instance
+  /*! \brief Fill the camera information messages with the ZED calibration
+   * \param zedParam : the calibration parameters at the publishing resolution
    * \param left_cam_info_msg : the information message to fill with the left
    * camera informations
    * \param right_cam_info_msg : the information message to fill with the right
    * camera informations
    * \param left_frame_id : the id of the reference frame of the left camera
    * \param right_frame_id : the id of the reference frame of the right camera
+   * \param rawParam : true if `zedParam` are the unrectified parameters
    */
-  void fillCamInfo(sl::Camera& zed, sensor_msgs::CameraInfoPtr leftCamInfoMsg,
-                   sensor_msgs::CameraInfoPtr rightCamInfoMsg, std::string leftFrameId, std::string rightFrameId,
+  void fillCamInfo(sl::CalibrationParameters zedParam, sensor_msgs::CameraInfo& leftCamInfoMsg,
+                   sensor_msgs::CameraInfo& rightCamInfoMsg, std::string leftFrameId, std::string rightFrameId,
                    bool rawParam = false);
 
-  /*! \brief Get the information of the ZED cameras and store them in an
-   * information message for depth topics
-   * \param zed : the sl::zed::Camera* pointer to an instance
+  /*! \brief Fill the camera information message for depth topics with the ZED calibration
+   * \param zedParam : the rectified calibration parameters at the publishing resolution
    * \param depth_info_msg : the information message to fill with the left
    * camera informations
    * \param frame_id : the id of the reference frame of the left camera
    */
-  void fillCamDepthInfo(sl::Camera& zed, sensor_msgs::CameraInfoPtr depth_info_msg, std::string frame_id);
+  void fillCamDepthInfo(sl::CalibrationParameters zedParam, sensor_msgs::CameraInfo& depth_info_msg,
+                        std::string frame_id);
+
+  /*! \brief Query the calibration of the camera at the publishing resolution and replace the current snapshot.
+   *  Must be called by the grab thread, it also refreshes the camera information messages used for publishing
+   */
+  void updateCalibSnapshot();
+
+  /*! \brief Get the current calibration snapshot
+   * \return the snapshot, `nullptr` if the camera has not been opened yet
+   */
+  CalibSnapshotPtr getCalibSnapshot() const
+  {
+    return std::atomic_load(&mCalibSnapshot);
+  }
+
+  /*! \brief Publish the current dynamic transforms as a new pose snapshot.
+   *  `mOdomMutex` must be locked by the caller
+   * \param t : the timestamp of the transforms
+   */
+  void updatePoseSnapshot(ros::Time t);
+
+  /*! \brief Get the current pose snapshot
+   * \return the snapshot, never `nullptr` after the initialization
+   */
+  PoseSnapshotPtr getPoseSnapshot() const
+  {
+    return std::atomic_load(&mPoseSnapshot);
+  }
 
   /*! \brief Check if FPS and Resolution chosen by user are correct.
    *        Modifies FPS to match correct value.
@@ -339,6 +556,11 @@ protected:
    */
   bool on_reset_odometry(zed_interfaces::reset_odometry::Request& req, zed_interfaces::reset_odometry::Response& res);
 
+  /*! \brief Service callback to get_pose_at_time service
+   *        Poses of the base frame at past times, interpolated from the pose history
+   */
+  bool on_get_pose_at_time(zed_nodelets::GetPoseAtTime::Request& req, zed_nodelets::GetPoseAtTime::Response& res);
+
   /*! \brief Service callback to set_pose service
    *        Tracking pose is set to the new values
    */
@@ -427,6 +649,17 @@ protected:
    */
   void start_pos_tracking();
 
+  /*! \brief Start tracking from a given pose
+   * \param basePose : the pose of the base in map frame as [x,y,z,R,P,Y]
+   */
+  void start_pos_tracking(const std::vector<float>& basePose);
+
+  /*! \brief Reopen the camera after a disconnection and restore the state of the SDK session. Called by the grab
+   *         thread
+   * \return false if the node is stopping
+   */
+  bool reconnectCamera();
+
   /*! \brief Start spatial mapping
    */
   bool start_3d_mapping();
@@ -443,13 +676,48 @@ protected:
    */
   void stop_obj_detect();
 
-  /*! \brief Publish object detection results
+  /*! \brief Retrieve the latest object detection results and queue them for publishing.
+   *         Called by the grab thread, a queued result not yet published is replaced by the new one
+   * \param t : the timestamp of the current frame
    */
   void processDetectedObjects(ros::Time t);
 
-  /*! \brief Process camera settings
+  /*! \brief Publish object detection results, called by the object detection thread or task
+   * \param objects : the detected objects
+   * \param t : the timestamp of the frame the objects have been retrieved with
+   * \param queueTime : the time when the objects have been queued
    */
-  void processCameraSettings();
+  void publishDetectedObjects(sl::Objects& objects, ros::Time t, std::chrono::steady_clock::time_point queueTime);
+
+  /*! \brief Publish the depth of each detected object, measured in parallel on the depth map retrieved with the
+   *         objects. Called by the object detection thread or task
+   * \param objects : the detected objects
+   * \param depth : the `F32_C1` depth map at publishing resolution
+   * \param t : the timestamp of the depth map
+   */
+  void publishObjectsDepth(const sl::Objects& objects, sl::Mat depth, ros::Time t);
+
+  /*! \brief Apply the camera settings changed since the last call
+   * \param dirty : the settings to be applied
+   * \param values : the values of the settings, indexed by `sl::VIDEO_SETTINGS`
+   * \param autoExposure : the auto exposure/gain status
+   * \param autoWB : the auto white balance status
+   */
+  void applyCameraSettings(const CamSettingsMask& dirty, const std::vector<int>& values, bool autoExposure,
+                           bool autoWB);
+
+  /*! \brief Read exposure, gain and white balance temperature when controlled by the camera and copy them to the
+   *         dynamic parameters
+   * \return true if a dynamic parameter changed
+   */
+  bool readbackCameraSettings();
+
+  /*! \brief Mark a camera setting to be applied by the camera controls thread. Requires `mDynParMutex` locked
+   */
+  inline void setCamSettingDirty(sl::VIDEO_SETTINGS setting)
+  {
+    mCamSettingsDirty.set(static_cast<size_t>(setting));
+  }
 
   /*! \brief Process point cloud
    * \param ts Frame timestamp
@@ -490,9 +758,31 @@ private:
   std::thread mDevicePollThread;
   std::thread mPcThread;    // Point Cloud thread
   std::thread mSensThread;  // Sensors data thread
+  std::thread mObjDetThread;  // Object detection publishing thread
+  std::thread mCamCtrlThread;  // Camera settings thread
+  std::thread mWarmupThread;   // Optional modules start thread
+
+  // Threads scheduling
+  sl_tools::ThreadSchedParams mGrabThreadSched;
+  sl_tools::ThreadSchedParams mPcThreadSched;
+  sl_tools::ThreadSchedParams mSensThreadSched;
+  sl_tools::ThreadSchedParams mCamCtrlThreadSched;
+  sl_tools::ThreadSchedParams mExecThreadSched;  // Shared executor workers
 
   bool mStopNode = false;
 
+  // Shared executor (replaces the point cloud and sensors threads when enabled)
+  bool mUseSharedExecutor = false;
+  int mSharedExecutorThreads = 0;
+  int mExecutorPriority = 0;
+  std::shared_ptr<sl_tools::SharedExecutor> mExecutor;
+  int mExecutorClientId = -1;
+  std::chrono::steady_clock::time_point mNextSensRelease;
+  std::atomic<bool> mFusedPcPending{ false };
+  uint64_t mExecLastClient_nsec = 0;
+  uint64_t mExecLastTotal_nsec = 0;
+  std::chrono::steady_clock::time_point mExecLastStatsTime;
+
   // Publishers
   image_transport::CameraPublisher mPubRgb;       //
   image_transport::CameraPublisher mPubRawRgb;    //
@@ -501,6 +791,8 @@ private:
   image_transport::CameraPublisher mPubRight;     //
   image_transport::CameraPublisher mPubRawRight;  //
   image_transport::CameraPublisher mPubDepth;     //
+  ros::Publisher mPubDepthRvl;                    // Compressed 16UC1 depth
+  image_transport::CameraPublisher mPubDepthFiltered;  // Depth masked by confidence and range
   image_transport::Publisher mPubStereo;
   image_transport::Publisher mPubRawStereo;
 
@@ -518,8 +810,11 @@ private:
   ros::Publisher mPubPose;
   ros::Publisher mPubPoseCov;
   ros::Publisher mPubOdom;
+  ros::Publisher mPubImuOdom;
   ros::Publisher mPubOdomPath;
   ros::Publisher mPubMapPath;
+  ros::Publisher mPubOdomPathAppend;  // Only the poses added to the odometry path since the previous message
+  ros::Publisher mPubMapPathAppend;   // Only the poses added to the map path since the previous message
   ros::Publisher mPubImu;
   ros::Publisher mPubImuRaw;
   ros::Publisher mPubImuTemp;
@@ -535,6 +830,7 @@ private:
 
   ros::Publisher mPubPoseStatus;
   ros::Publisher mPubOdomStatus;
+  ros::Publisher mPubGovStatus;
 
   // Subscribers
   ros::Subscriber mClickedPtSub;
@@ -560,6 +856,7 @@ private:
   ros::ServiceServer mSrvSaveAreaMemory;
   ros::ServiceServer mSrvSetRoi;
   ros::ServiceServer mSrvResetRoi;
+  ros::ServiceServer mSrvGetPoseAtTime;
 
   // ----> Topics (ONLY THOSE NOT CHANGING WHILE NODE RUNS)
   // Camera info
@@ -571,11 +868,21 @@ private:
   sensor_msgs::CameraInfoPtr mRightCamInfoRawMsg;
   sensor_msgs::CameraInfoPtr mDepthCamInfoMsg;
 
+  CalibSnapshotPtr mCalibSnapshot;  // Swapped atomically, see `getCalibSnapshot`
+  PoseSnapshotPtr mPoseSnapshot;    // Swapped atomically, see `getPoseSnapshot`
+
+  std::shared_ptr<sl_tools::PoseHistory> mPoseHistory;  // Also readable by the nodelets in the same manager
+
+  stereo_msgs::DisparityImagePtr mDisparityMsg;  // Reused when not held by intra-process subscribers
+  sl::Mat mMatDepthMm;                           // 16 bit millimeter depth converted from the float depth
+  sl::Mat mFrameDepth;                           // Float depth of the current frame if retrieved for publishing
+
   geometry_msgs::TransformPtr mCameraImuTransfMgs;
   // <---- Topics
 
   // ROS TF
   tf2_ros::TransformBroadcaster mTfBroadcaster;
+  std::vector<geometry_msgs::TransformStamped> mTfBatch;  // Dynamic TFs sent together for each frame
   tf2_ros::StaticTransformBroadcaster mStaticTfBroadcaster;
 
   std::string mRgbFrameId;
@@ -626,13 +933,38 @@ private:
   bool mSensTimestampSync;
   double mSensPubRate = 400.0;
   double mPathPubRate;
-  int mPathMaxCount;
+  int mPathMaxCount = 3600;
+  double mPathMinDist = 0.0;   // [m] minimum translation between two stored path poses
+  double mPathMinAngle = 0.0;  // [rad] minimum rotation between two stored path poses
+  int mPoseHistorySize = 0;
+  bool mImuOdomEnabled = false;
+  double mImuOdomRate = 100.0;
+  bool mPublishImuOdomTf = false;
   int mSdkVerbose = 1;
   std::vector<std::vector<float>> mRoiParam;
   bool mSvoMode = false;
   double mCamMinDepth;
   double mCamMaxDepth;
   double mStartupDelay{0};
+
+  // Startup
+  bool mAsyncModulesStart = true;  // Start tracking, mapping and object detection in the warmup thread
+  std::mutex mWarmupMutex;
+  std::condition_variable mWarmupCondVar;
+  unsigned mWarmupPending = 0;  // `WarmupModule` flags requested and not yet processed. Protected by `mWarmupMutex`
+  std::chrono::steady_clock::time_point mStartupTime;
+  std::atomic<bool> mStartupPhaseDone[STARTUP_PHASE_COUNT]{};
+  double mStartupPhaseTime[STARTUP_PHASE_COUNT] = {};  // [sec] since the nodelet start. Protected by `mStartupMutex`
+  std::mutex mStartupMutex;
+  ros::Publisher mPubStartupTimeline;
+
+  // Camera connection
+  std::unique_ptr<sl_tools::CameraConnector> mConnector;
+  sl_tools::CameraConnector::Params mConnParams;
+  double mReconnectGrace = 0.5;  // [sec] time without frames before reopening the camera
+  std::chrono::steady_clock::time_point mRecoveryStart;  // Last frame before the current disconnection
+  double mLastRecovery_sec = 0.0;  // Time without frames of the last reconnection
+  double mMaxRecovery_sec = 0.0;
   std::string mClickedPtTopic = "/clicked_point";
 
   bool mFillMode = false;
@@ -641,7 +973,7 @@ private:
   bool mPosTrackingEnabled = false;
   sl::POSITIONAL_TRACKING_MODE mPosTrkMode = sl::POSITIONAL_TRACKING_MODE::GEN_2;
   bool mPosTrackingReady = false;
-  bool mPosTrackingStarted = false;
+  std::atomic<bool> mPosTrackingStarted{ false };  // Set by `start_pos_tracking`, called with `mPosTrkMutex` locked
   bool mPosTrackingRequired = false;
   bool mTwoDMode = false;
   double mFixedZValue = 0.0;
@@ -670,12 +1002,35 @@ private:
   ros::Time mPrevFrameTimestamp;
   ros::Time mFrameTimestamp;
 
+  // ----> Per-instance state
+  // Note: never use function-local statics for this, they are shared by all the cameras in the same nodelet manager
+  sl_tools::StampTracker mVideoDepthStamp;  // Used to calculate stable publish frequency
+  sl_tools::StampTracker mImuStamp;
+  sl_tools::StampTracker mBaroStamp;
+  sl_tools::StampTracker mMagStamp;
+  sl::Timestamp mLastSensImuTs = 0;  // Hardware timestamp of the latest IMU sample retrieved
+  sl_tools::StampTracker mTfStamp;  // Avoid duplicated TF publishing
+  std::chrono::steady_clock::time_point mLastPcThreadTime = std::chrono::steady_clock::now();
+  std::chrono::steady_clock::time_point mLastPcPubTime = std::chrono::steady_clock::now();
+  std::chrono::steady_clock::time_point mLastSensPubTime = std::chrono::steady_clock::now();
+  std::chrono::steady_clock::time_point mLastGrabTime = std::chrono::steady_clock::now();
+  std::chrono::steady_clock::time_point mLastObjDetTime = std::chrono::steady_clock::now();
+  int mElabWarnCount = 0;
+  int mHitPtMarkerId = 0;
+  int mPlaneMeshMarkerId = 0;
+  bool mCamera2BaseTfFirstErr = true;
+  bool mSens2CameraTfFirstErr = true;
+  bool mSens2BaseTfFirstErr = true;
+  // <---- Per-instance state
+
   // Positional Tracking variables
   sl::Pose mLastZedPose;  // Sensor to Map transform
   sl::Transform mInitialPoseSl;
   std::vector<float> mInitialBasePose;
-  std::vector<geometry_msgs::PoseStamped> mOdomPath;
-  std::vector<geometry_msgs::PoseStamped> mMapPath;
+  sl_tools::RingBuffer<geometry_msgs::PoseStamped> mOdomPath;
+  sl_tools::RingBuffer<geometry_msgs::PoseStamped> mMapPath;
+  nav_msgs::PathPtr mOdomPathMsg;  // Reused when not held by intra-process subscribers
+  nav_msgs::PathPtr mMapPathMsg;   // Reused when not held by intra-process subscribers
   ros::Time mLastTs_odom;
   ros::Time mLastTs_pose;
 
@@ -695,6 +1050,27 @@ private:
   bool mCamera2BaseTransfValid = false;
   bool mStaticImuFramePublished = false;
 
+  // ----> IMU propagated odometry
+  struct ImuOdomSample
+  {
+    ros::Time stamp;
+    tf2::Vector3 angVel;  // [rad/s] in base frame
+  };
+
+  std::string mImuOdomFrameId;
+  std::mutex mImuOdomMutex;
+  sl_tools::RingBuffer<ImuOdomSample> mImuOdomSamples{ 512 };  // Replayed when a new visual solution arrives
+  bool mImuOdomAnchorValid = false;
+  bool mImuOdomReanchor = false;  // A new visual solution must be used
+  tf2::Transform mImuOdomAnchor;  // Latest visual odometry solution
+  ros::Time mImuOdomAnchorTs;
+  tf2::Vector3 mImuOdomLinVel{ 0.0, 0.0, 0.0 };  // [m/s] in odometry frame, from the last two visual solutions
+  tf2::Quaternion mImuOdomBase2Imu{ tf2::Quaternion::getIdentity() };  // Rotation of the IMU frame in base frame
+  tf2::Transform mImuOdomTransf;  // Propagated pose
+  ros::Time mImuOdomTs;           // Timestamp of the propagated pose
+  ros::Time mImuOdomLastPubTs;
+  // <---- IMU propagated odometry
+
   // initialization Transform listener
   boost::shared_ptr<tf2_ros::Buffer> mTfBuffer;
   boost::shared_ptr<tf2_ros::TransformListener> mTfListener;
@@ -729,10 +1105,12 @@ private:
   double mCustomDownscaleFactor = 1.0;     // Used to rescale data with user factor
 
   // flags
-  bool mTriggerAutoExposure = true;
-  bool mTriggerAutoWB = true;
   bool mComputeDepth;
   bool mOpenniDepthMode;  // 16 bit UC data in mm else 32F in m, for more info -> http://www.ros.org/reps/rep-0118.html
+  bool mDepthRvlEnabled = false;  // Publish the compressed 16 bit depth topic
+  int mDepthRvlMaxError = 0;      // [mm] maximum error of the compressed depth, 0 for lossless
+  bool mDepthFilteredEnabled = false;  // Publish the depth masked by confidence and range
+  sl_tools::DepthFilterParams mDepthFilterParams;
   bool mPoseSmoothing = false;  // Always disabled. Enable only for AR/VR applications
   bool mAreaMemory;
   bool mInitOdomWithPose;
@@ -753,13 +1131,17 @@ private:
   sl::Resolution mMatResol;
 
   // Thread Sync
-  std::mutex mCloseZedMutex;
+  std::shared_mutex mCloseZedMutex;  // Exclusive to close or reopen the camera, shared to use the opened camera
   std::mutex mCamDataMutex;
   std::mutex mPcMutex;
   std::mutex mRecMutex;
   std::mutex mPosTrkMutex;
-  std::mutex mOdomMutex;
+  std::mutex mOdomMutex;  // Serializes the writers of the dynamic transforms
+  std::mutex mPathMutex;
   std::mutex mDynParMutex;
+  std::condition_variable mCamSettingsCondVar;  // Signals changes of `mCamSettingsDirty` and `mUpdateDynParams`
+  CamSettingsMask mCamSettingsDirty;            // Camera settings to be applied. Protected by `mDynParMutex`
+  double mCamSettingsReadback = 1.0;            // [sec] period of the readback of the automatic camera settings
   std::mutex mMappingMutex;
   std::mutex mObjDetMutex;
   std::condition_variable mPcDataReadyCondVar;
@@ -778,11 +1160,34 @@ private:
   float mTempLeft = -273.15f;
   float mTempRight = -273.15f;
   std::unique_ptr<sl_tools::CSmartMean> mElabPeriodMean_sec;
+  std::unique_ptr<sl_tools::CSmartMean> mProcPeriodMean_sec;  // From `grab` return to the end of publishing
   std::unique_ptr<sl_tools::CSmartMean> mGrabPeriodMean_usec;
   std::unique_ptr<sl_tools::CSmartMean> mVideoDepthPeriodMean_sec;
   std::unique_ptr<sl_tools::CSmartMean> mPcPeriodMean_usec;
   std::unique_ptr<sl_tools::CSmartMean> mSensPeriodMean_usec;
   std::unique_ptr<sl_tools::CSmartMean> mObjDetPeriodMean_msec;
+  std::unique_ptr<sl_tools::CSmartMean> mObjDetLatencyMean_msec;
+  std::atomic<uint64_t> mGrabLoopCount{ 0 };
+  std::atomic<uint64_t> mGrabDeadlineMiss{ 0 };
+  std::atomic<uint64_t> mSensLoopCount{ 0 };
+  std::atomic<uint64_t> mSensDeadlineMiss{ 0 };
+  std::atomic<uint64_t> mPcLoopCount{ 0 };
+  std::atomic<uint64_t> mSensDuplicateReads{ 0 };  // IMU polled before a new sample was available
+  std::atomic<uint64_t> mSensMissedSamples{ 0 };   // IMU samples skipped between two reads
+  std::atomic<double> mImuPeriodEst_msec{ 0.0 };   // IMU period estimated from the hardware timestamps
+
+  std::atomic<uint64_t> mPcDeadlineMiss{ 0 };
+
+  // Load governor
+  bool mGovEnabled = false;
+  std::vector<GovStep> mGovShedOrder;
+  double mGovOverloadThresh = 0.95;  // Processing time/frame period ratio that triggers load shedding
+  double mGovRestoreThresh = 0.7;    // Processing time/frame period ratio that allows restoring processing
+  double mGovOverloadTime = 1.0;     // [sec] overload persistence before shedding the next step
+  double mGovRestoreTime = 3.0;      // [sec] headroom persistence before restoring the last shed step
+  std::atomic<int> mGovLevel{ 0 };   // Number of shed steps
+  int mGovOverCount = 0;
+  int mGovUnderCount = 0;
 
   diagnostic_updater::Updater mDiagUpdater;  // Diagnostic Updater
 
@@ -815,11 +1220,37 @@ private:
   bool mObjDetElectronicsEnable = true;
   bool mObjDetFruitsEnable = true;
   bool mObjDetSportEnable = true;
+  bool mObjDetAsync = true;            // Inference not synchronized with the grab
+  double mObjDetMaxRate = 0.0;         // [Hz] `0` for the grab rate
+  bool mObjDetDepth = false;           // Publish the depth of each object
+  int mObjDetDepthPatchSize = 32;      // [pixel] Maximum side of the depth patches, `0` to disable them
+  float mObjDetDepthInlierTol = 0.1f;  // Relative tolerance around the median depth of the centroid pixels
 
   sl::OBJECT_DETECTION_MODEL mObjDetModel = sl::OBJECT_DETECTION_MODEL::MULTI_CLASS_BOX_MEDIUM;
   sl::OBJECT_FILTERING_MODE mObjFilterMode = sl::OBJECT_FILTERING_MODE::NMS3D;
 
   ros::Publisher mPubObjDet;
+  zed_interfaces::ObjectsStampedPtr mObjDetMsg;  // Reused when not held by intra-process subscribers
+  ros::Publisher mPubObjDetDepth;
+  zed_nodelets::ObjectsDepthStampedPtr mObjDetDepthMsg;  // Reused when not held by intra-process subscribers
+  std::vector<std::vector<float>> mObjDetDepthScratch;   // Per object buffers of the median computation
+
+  // ----> Object detection stage: single slot queue, the latest results replace the queued ones
+  std::mutex mObjDetDataMutex;
+  std::condition_variable mObjDetDataCondVar;
+  bool mObjDetDataReady = false;
+  bool mObjDetTaskPosted = false;  // Shared executor only, cleared when the task has published the results
+  sl::Objects mObjDetData;
+  ros::Time mObjDetDataTime;
+  std::chrono::steady_clock::time_point mObjDetQueueTime;
+  std::chrono::steady_clock::time_point mObjDetLastTakeTime;  // Used for the rate control
+  std::atomic<uint64_t> mObjDetDropCount{ 0 };
+  // The depth maps rotate between the grab thread, the queue and the publishing stage without reallocation
+  sl::Mat mObjDetDepthGrab;
+  sl::Mat mObjDetDepthData;
+  sl::Mat mObjDetDepthOut;
+  bool mObjDetDepthReady = false;  // `mObjDetDepthData` refers to the queued objects
+  // <---- Object detection stage
 };  // class ZEDROSWrapperNodelet
 }  // namespace zed_nodelets
 
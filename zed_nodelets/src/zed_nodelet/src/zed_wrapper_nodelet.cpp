@@ -18,8 +18,12 @@
 //
 ///////////////////////////////////////////////////////////////////////////
 
+#include <algorithm>
+#include <cerrno>
 #include <chrono>
 #include <csignal>
+#include <ctime>
+#include <limits>
 #include <sstream>
 
 #include "zed_wrapper_nodelet.hpp"
@@ -47,6 +51,14 @@ namespace zed_nodelets
 #define MAG_FREQ 50.
 #define BARO_FREQ 25.
 
+#define PATH_MAX_COUNT_DFLT 3600  // 30 minutes at 2 Hz
+
+// Keys of the startup timeline, indexed by `StartupPhase`
+static const char* const STARTUP_PHASE_NAMES[STARTUP_PHASE_COUNT] = {
+  "parameters", "camera_open", "publishers", "nodelet_ready", "first_frame", "first_imu", "pos_tracking", "mapping",
+  "obj_det"
+};
+
 ZEDWrapperNodelet::ZEDWrapperNodelet() : Nodelet()
 {
 }
@@ -70,6 +82,35 @@ ZEDWrapperNodelet::~ZEDWrapperNodelet()
     mSensThread.join();
   }
 
+  if (mObjDetThread.joinable())
+  {
+    mObjDetThread.join();
+  }
+
+  if (mCamCtrlThread.joinable())
+  {
+    mCamSettingsCondVar.notify_all();
+    mCamCtrlThread.join();
+  }
+
+  if (mWarmupThread.joinable())
+  {
+    mWarmupCondVar.notify_all();
+    mWarmupThread.join();
+  }
+
+  if (mExecutor)
+  {
+    // Drop the queued tasks and wait for the running ones
+    mExecutor->unregisterClient(mExecutorClientId);
+    mExecutor.reset();
+  }
+
+  if (mConnector)
+  {
+    mConnector->stop();
+  }
+
   if (mZed.isOpened())
   {
     mZed.close();
@@ -82,6 +123,8 @@ ZEDWrapperNodelet::~ZEDWrapperNodelet()
 
 void ZEDWrapperNodelet::onInit()
 {
+  mStartupTime = std::chrono::steady_clock::now();
+
   // Node handlers
   mNh = getMTNodeHandle();
 
@@ -114,6 +157,17 @@ void ZEDWrapperNodelet::onInit()
 
   readParameters();
 
+  // Advertised first to time all the startup phases
+  mPubStartupTimeline = mNhNs.advertise<diagnostic_msgs::DiagnosticStatus>("startup_timeline", 1, true);
+  NODELET_INFO_STREAM(" * Advertised on topic " << mPubStartupTimeline.getTopic() << " [LATCHED]");
+  markStartupPhase(STARTUP_PARAMETERS);
+
+  if (mPoseHistorySize > 0)
+  {
+    // Registered with the namespace of the nodelet, see `sl_tools::PoseHistory::find`
+    mPoseHistory = sl_tools::PoseHistory::create(mNhNs.getNamespace(), mPoseHistorySize);
+  }
+
   initTransforms();
 
   // Set the video topic names
@@ -153,6 +207,8 @@ void ZEDWrapperNodelet::onInit()
     NODELET_INFO_STREAM("Openni depth mode activated -> Units: mm, Encoding: TYPE_16UC1");
   }
   depth_topic_root += "/depth_registered";
+  std::string depth_rvl_topic = depth_topic_root + "/rvl";
+  std::string depth_filtered_topic = "depth/depth_filtered";
 
   std::string pointcloud_topic = "point_cloud/cloud_registered";
 
@@ -160,6 +216,7 @@ void ZEDWrapperNodelet::onInit()
 
   std::string object_det_topic_root = "obj_det";
   std::string object_det_topic = object_det_topic_root + "/objects";
+  std::string object_det_depth_topic = object_det_topic_root + "/objects_depth";
 
   std::string confImgRoot = "confidence";
   std::string conf_map_topic_name = "confidence_map";
@@ -173,8 +230,11 @@ void ZEDWrapperNodelet::onInit()
   std::string odometryTopic = "odom";
   std::string odom_path_topic = "path_odom";
   std::string map_path_topic = "path_map";
+  std::string odom_path_append_topic = odom_path_topic + "/append";
+  std::string map_path_append_topic = map_path_topic + "/append";
 
   std::string odomStatusTopic = odometryTopic + "/status";
+  std::string imuOdomTopic = odometryTopic + "/imu_propagated";
   std::string poseStatusTopic = poseTopic + "/status";
 
   // Extracted plane topics
@@ -281,18 +341,37 @@ void ZEDWrapperNodelet::onInit()
     ros::Duration(mStartupDelay).sleep();
   }
 
+  // ----> Camera connection
+  // The camera is opened and reopened after a disconnection by the connection thread, with exponential backoff
+  mConnector.reset(new sl_tools::CameraConnector(
+      [this]() {
+        // The sensors and the camera controls use the camera only when the opening is completed
+        std::lock_guard<std::shared_mutex> lock(mCloseZedMutex);
+        mConnStatus = mZed.open(mZedParams);
+        NODELET_INFO_STREAM("ZED connection: " << sl::toString(mConnStatus));
+        return mConnStatus;
+      },
+      [this]() {
+        std::lock_guard<std::shared_mutex> lock(mCloseZedMutex);
+        mConnStatus = sl::ERROR_CODE::CAMERA_NOT_DETECTED;
+        if (mZed.isOpened())
+        {
+          mZed.close();
+        }
+      },
+      mConnParams));
+  // <---- Camera connection
+
   NODELET_INFO_STREAM(" *** Opening " << sl::toString(mZedUserCamModel) << " - " << ss.str().c_str() << " ***");
-  while (mConnStatus != sl::ERROR_CODE::SUCCESS)
+  mConnector->requestConnection();
+  while (!mConnector->waitConnected(std::chrono::milliseconds(100)))
   {
-    mConnStatus = mZed.open(mZedParams);
-    NODELET_INFO_STREAM("ZED connection [" << cam_id.c_str() << "]: " << sl::toString(mConnStatus));
-    std::this_thread::sleep_for(std::chrono::milliseconds(2000));
-
     if (!mNhNs.ok())
     {
       mStopNode = true;
+      mConnector->stop();
 
-      std::lock_guard<std::mutex> lock(mCloseZedMutex);
+      std::lock_guard<std::shared_mutex> lock(mCloseZedMutex);
       NODELET_INFO_STREAM("Closing ZED " << mZedSerialNumber << "...");
       if (mRecording)
       {
@@ -312,6 +391,7 @@ void ZEDWrapperNodelet::onInit()
     mDiagUpdater.update();
   }
   NODELET_INFO_STREAM(" ...  " << sl::toString(mZedRealCamModel) << " ready");
+  markStartupPhase(STARTUP_CAMERA_OPEN);
 
   // CUdevice devid;
   cuCtxGetDevice(&mGpuId);
@@ -507,6 +587,19 @@ void ZEDWrapperNodelet::onInit()
     NODELET_INFO_STREAM(" * Advertised on topic " << mPubDepth.getTopic());
     NODELET_INFO_STREAM(" * Advertised on topic " << mPubDepth.getInfoTopic());
 
+    if (mDepthRvlEnabled)
+    {
+      mPubDepthRvl = mNhNs.advertise<sensor_msgs::CompressedImage>(depth_rvl_topic, 1);  // compressed depth
+      NODELET_INFO_STREAM(" * Advertised on topic " << mPubDepthRvl.getTopic());
+    }
+
+    if (mDepthFilteredEnabled)
+    {
+      mPubDepthFiltered = it_zed.advertiseCamera(depth_filtered_topic, 1);  // depth masked by confidence
+      NODELET_INFO_STREAM(" * Advertised on topic " << mPubDepthFiltered.getTopic());
+      NODELET_INFO_STREAM(" * Advertised on topic " << mPubDepthFiltered.getInfoTopic());
+    }
+
     // Confidence Map publisher
     mPubConfMap = mNhNs.advertise<sensor_msgs::Image>(conf_map_topic, 1);  // confidence map
     NODELET_INFO_STREAM(" * Advertised on topic " << mPubConfMap.getTopic());
@@ -530,6 +623,12 @@ void ZEDWrapperNodelet::onInit()
     {
       mPubObjDet = mNhNs.advertise<zed_interfaces::ObjectsStamped>(object_det_topic, 1);
       NODELET_INFO_STREAM(" * Advertised on topic " << mPubObjDet.getTopic());
+
+      if (mObjDetDepth)
+      {
+        mPubObjDetDepth = mNhNs.advertise<zed_nodelets::ObjectsDepthStamped>(object_det_depth_topic, 1);
+        NODELET_INFO_STREAM(" * Advertised on topic " << mPubObjDetDepth.getTopic());
+      }
     }
 
     // Odometry and Pose publisher
@@ -541,6 +640,12 @@ void ZEDWrapperNodelet::onInit()
     mPubOdom = mNhNs.advertise<nav_msgs::Odometry>(odometryTopic, 1);
     NODELET_INFO_STREAM(" * Advertised on topic " << mPubOdom.getTopic());
 
+    if (mImuOdomEnabled)
+    {
+      mPubImuOdom = mNhNs.advertise<nav_msgs::Odometry>(imuOdomTopic, 1);
+      NODELET_INFO_STREAM(" * Advertised on topic " << mPubImuOdom.getTopic());
+    }
+
     mPubOdomStatus = mNhNs.advertise<zed_interfaces::PosTrackStatus>(odomStatusTopic, 1);
     NODELET_INFO_STREAM(" * Advertised on topic " << mPubOdomStatus.getTopic());
     mPubPoseStatus = mNhNs.advertise<zed_interfaces::PosTrackStatus>(poseStatusTopic, 1);
@@ -557,16 +662,16 @@ void ZEDWrapperNodelet::onInit()
       mPubMapPath = mNhNs.advertise<nav_msgs::Path>(map_path_topic, 1, true);
       NODELET_INFO_STREAM(" * Advertised on topic " << mPubMapPath.getTopic());
 
-      mPathTimer = mNhNs.createTimer(ros::Duration(1.0 / mPathPubRate), &ZEDWrapperNodelet::callback_pubPath, this);
+      mPubOdomPathAppend = mNhNs.advertise<nav_msgs::Path>(odom_path_append_topic, 10);
+      NODELET_INFO_STREAM(" * Advertised on topic " << mPubOdomPathAppend.getTopic());
+      mPubMapPathAppend = mNhNs.advertise<nav_msgs::Path>(map_path_append_topic, 10);
+      NODELET_INFO_STREAM(" * Advertised on topic " << mPubMapPathAppend.getTopic());
 
-      if (mPathMaxCount != -1)
-      {
-        NODELET_DEBUG_STREAM("Path vectors reserved " << mPathMaxCount << " poses.");
-        mOdomPath.reserve(mPathMaxCount);
-        mMapPath.reserve(mPathMaxCount);
+      mPathTimer = mNhNs.createTimer(ros::Duration(1.0 / mPathPubRate), &ZEDWrapperNodelet::callback_pubPath, this);
 
-        NODELET_DEBUG_STREAM("Path vector sizes: " << mOdomPath.size() << " " << mMapPath.size());
-      }
+      NODELET_DEBUG_STREAM("Path buffers reserved " << mPathMaxCount << " poses.");
+      mOdomPath.setCapacity(mPathMaxCount);
+      mMapPath.setCapacity(mPathMaxCount);
     }
     else
     {
@@ -644,6 +749,14 @@ void ZEDWrapperNodelet::onInit()
       mSensPeriodMean_usec.reset(new sl_tools::CSmartMean(mCamFrameRate / 2));
     }
   }
+
+  if (mGovEnabled)
+  {
+    std::string gov_status_topic = "governor/status";
+    mPubGovStatus = mNhNs.advertise<diagnostic_msgs::DiagnosticStatus>(gov_status_topic, 1, true);
+    NODELET_INFO_STREAM(" * Advertised on topic " << mPubGovStatus.getTopic() << " [LATCHED]");
+    publishGovernorStatus();
+  }
   // <---- Publishers
 
   // ----> Subscribers
@@ -656,20 +769,68 @@ void ZEDWrapperNodelet::onInit()
   initServices();
   // <---- Services
 
+  markStartupPhase(STARTUP_PUBLISHERS);
+
   // ----> Threads
-  if (!mDepthDisabled)
+  if (mUseSharedExecutor)
+  {
+    // Point cloud and Sensors publishing are executed by the worker pool shared by all the cameras
+    // in the same nodelet manager
+    // The workers are shared: the scheduling of the first camera started is applied
+    sl_tools::ThreadSchedParams execSched = mExecThreadSched;
+    auto workerInit = [execSched]() {
+      if (execSched.policy == "SCHED_OTHER" && execSched.cpus.empty())
+      {
+        return;  // Default scheduling
+      }
+
+      std::string error;
+      if (!sl_tools::setThreadScheduling(execSched, error))
+      {
+        ROS_WARN_STREAM("Shared executor worker scheduling partially applied, the default is used for the rest: "
+                        << error);
+      }
+    };
+    mExecutor = sl_tools::SharedExecutor::getInstance(mSharedExecutorThreads, workerInit);
+    mExecutorClientId = mExecutor->registerClient(getName(), mExecutorPriority);
+    mExecLastStatsTime = std::chrono::steady_clock::now();
+
+    mNextSensRelease = std::chrono::steady_clock::now();
+    mExecutor->post(mExecutorClientId, sl_tools::TaskClass::SENSORS, mNextSensRelease, mNextSensRelease,
+                    std::bind(&ZEDWrapperNodelet::sensors_task_func, this));
+  }
+  else
+  {
+    if (!mDepthDisabled)
+    {
+      // Start Pointcloud thread
+      mPcThread = std::thread(&ZEDWrapperNodelet::pointcloud_thread_func, this);
+
+      // Start Object Detection thread
+      mObjDetThread = std::thread(&ZEDWrapperNodelet::obj_det_thread_func, this);
+    }
+
+    // Start Sensors thread
+    mSensThread = std::thread(&ZEDWrapperNodelet::sensors_thread_func, this);
+  }
+
+  // Start camera controls thread, all the settings are applied to the opened camera
+  mDynParMutex.lock();
+  mCamSettingsDirty.set();
+  mDynParMutex.unlock();
+  mCamCtrlThread = std::thread(&ZEDWrapperNodelet::cam_ctrl_thread_func, this);
+
+  if (mAsyncModulesStart)
   {
-    // Start Pointcloud thread
-    mPcThread = std::thread(&ZEDWrapperNodelet::pointcloud_thread_func, this);
+    // Start the thread enabling the optional modules
+    mWarmupThread = std::thread(&ZEDWrapperNodelet::warmup_thread_func, this);
   }
 
   // Start pool thread
   mDevicePollThread = std::thread(&ZEDWrapperNodelet::device_poll_thread_func, this);
-
-  // Start Sensors thread
-  mSensThread = std::thread(&ZEDWrapperNodelet::sensors_thread_func, this);
   // <---- Threads
 
+  markStartupPhase(STARTUP_NODELET_READY);
   NODELET_INFO("+++ ZED Node started +++");
 }
 
@@ -685,6 +846,12 @@ void ZEDWrapperNodelet::initServices()
     mSrvResetTracking = mNhNs.advertiseService("reset_tracking", &ZEDWrapperNodelet::on_reset_tracking, this);
     NODELET_INFO_STREAM(" * Advertised on service " << mSrvResetTracking.getService().c_str());
 
+    if (mPoseHistory)
+    {
+      mSrvGetPoseAtTime = mNhNs.advertiseService("get_pose_at_time", &ZEDWrapperNodelet::on_get_pose_at_time, this);
+      NODELET_INFO_STREAM(" * Advertised on service " << mSrvGetPoseAtTime.getService().c_str());
+    }
+
     mSrvSaveAreaMemory = mNhNs.advertiseService("save_area_memory", &ZEDWrapperNodelet::on_save_area_memory, this);
     NODELET_INFO_STREAM(" * Advertised on service " << mSrvSaveAreaMemory.getService().c_str());
 
@@ -901,6 +1068,29 @@ void ZEDWrapperNodelet::readGeneralParams()
   NODELET_INFO_STREAM(" * Startup Delay-> " << parsed_str.c_str());
 
   mNhNs.getParam("general/startup_delay", mStartupDelay);
+
+  mNhNs.getParam("general/shared_executor", mUseSharedExecutor);
+  NODELET_INFO_STREAM(" * Shared executor\t\t-> " << (mUseSharedExecutor ? "ENABLED" : "DISABLED"));
+  if (mUseSharedExecutor)
+  {
+    mNhNs.getParam("general/shared_executor_threads", mSharedExecutorThreads);
+    NODELET_INFO_STREAM(" * Shared executor threads\t-> " << mSharedExecutorThreads);
+    mNhNs.getParam("general/executor_priority", mExecutorPriority);
+    NODELET_INFO_STREAM(" * Executor priority\t\t-> " << mExecutorPriority);
+  }
+
+  mNhNs.getParam("general/camera_settings_readback", mCamSettingsReadback);
+  NODELET_INFO_STREAM(" * Camera settings readback\t-> " << mCamSettingsReadback << " sec");
+
+  mNhNs.getParam("general/async_modules_start", mAsyncModulesStart);
+  NODELET_INFO_STREAM(" * Async. modules start\t\t-> " << (mAsyncModulesStart ? "ENABLED" : "DISABLED"));
+
+  mNhNs.getParam("general/reconnect_grace", mReconnectGrace);
+  NODELET_INFO_STREAM(" * Reconnection grace time\t-> " << mReconnectGrace << " sec");
+  mNhNs.getParam("general/reconnect_min_delay", mConnParams.minDelay);
+  mNhNs.getParam("general/reconnect_max_delay", mConnParams.maxDelay);
+  NODELET_INFO_STREAM(" * Reconnection retry delay\t-> [" << mConnParams.minDelay << "," << mConnParams.maxDelay
+                                                          << "] sec");
 }
 
 void ZEDWrapperNodelet::readDepthParams()
@@ -949,6 +1139,48 @@ void ZEDWrapperNodelet::readDepthParams()
   {
     mNhNs.getParam("depth/openni_depth_mode", mOpenniDepthMode);
     NODELET_INFO_STREAM(" * OpenNI mode\t\t\t-> " << (mOpenniDepthMode ? "ENABLED" : "DISABLED"));
+    mNhNs.getParam("depth/compressed_depth", mDepthRvlEnabled);
+    NODELET_INFO_STREAM(" * Compressed depth\t\t-> " << (mDepthRvlEnabled ? "ENABLED" : "DISABLED"));
+    if (mDepthRvlEnabled)
+    {
+      mNhNs.getParam("depth/compressed_depth_max_error", mDepthRvlMaxError);
+      if (mDepthRvlMaxError < 0 || mDepthRvlMaxError > 100)
+      {
+        NODELET_WARN_STREAM("'depth/compressed_depth_max_error' must be in the range [0,100]. Using lossless compression");
+        mDepthRvlMaxError = 0;
+      }
+      NODELET_INFO_STREAM(" * Compressed depth max error\t-> " << mDepthRvlMaxError << " mm");
+    }
+    mNhNs.getParam("depth/filtered_depth", mDepthFilteredEnabled);
+    NODELET_INFO_STREAM(" * Filtered depth\t\t-> " << (mDepthFilteredEnabled ? "ENABLED" : "DISABLED"));
+    if (mDepthFilteredEnabled)
+    {
+      double conf = mDepthFilterParams.confThreshold;
+      double min_range = mDepthFilterParams.minRange;
+      double max_range = mDepthFilterParams.maxRange;
+      mNhNs.getParam("depth/filter_confidence", conf);
+      mNhNs.getParam("depth/filter_min_range", min_range);
+      mNhNs.getParam("depth/filter_max_range", max_range);
+      if (conf < 1. || conf > 100.)
+      {
+        NODELET_WARN_STREAM("'depth/filter_confidence' must be in the range [1,100]. Using 100");
+        conf = 100.;
+      }
+      if (min_range < 0. || (max_range > 0. && max_range <= min_range))
+      {
+        NODELET_WARN_STREAM("Not valid 'depth/filter_min_range' and 'depth/filter_max_range' values. Range "
+                            "filtering disabled");
+        min_range = 0.;
+        max_range = 0.;
+      }
+      mDepthFilterParams.confThreshold = static_cast<float>(conf);
+      mDepthFilterParams.minRange = static_cast<float>(min_range);
+      mDepthFilterParams.maxRange = static_cast<float>(max_range);
+      NODELET_INFO_STREAM(" * Filter confidence\t\t-> " << conf);
+      NODELET_INFO_STREAM(" * Filter range\t\t-> [" << min_range << ","
+                                                       << (max_range > 0. ? std::to_string(max_range) : "inf")
+                                                       << "] m");
+    }
     mNhNs.getParam("depth/depth_stabilization", mDepthStabilization);
     NODELET_INFO_STREAM(" * Depth Stabilization\t\t-> " << mDepthStabilization);
     mNhNs.getParam("depth/min_depth", mCamMinDepth);
@@ -997,13 +1229,43 @@ void ZEDWrapperNodelet::readPosTrkParams()
     mNhNs.getParam("pos_tracking/path_pub_rate", mPathPubRate);
     NODELET_INFO_STREAM(" * Path rate\t\t\t-> " << mPathPubRate << " Hz");
     mNhNs.getParam("pos_tracking/path_max_count", mPathMaxCount);
-    NODELET_INFO_STREAM(" * Path history size\t\t-> " << ((mPathMaxCount == -1) ? std::string("INFINITE") :
-                                                                                 std::to_string(mPathMaxCount)));
-
-    if (mPathMaxCount < 2 && mPathMaxCount != -1)
+    if (mPathMaxCount <= 0)
+    {
+      // The path is published as a whole at each update, it cannot grow without limits
+      NODELET_WARN_STREAM("'pos_tracking/path_max_count' must be positive, using the default value: "
+                          << PATH_MAX_COUNT_DFLT);
+      mPathMaxCount = PATH_MAX_COUNT_DFLT;
+    }
+    else if (mPathMaxCount < 2)
     {
       mPathMaxCount = 2;
     }
+    NODELET_INFO_STREAM(" * Path history size\t\t-> " << mPathMaxCount);
+
+    mNhNs.getParam("pos_tracking/path_min_distance", mPathMinDist);
+    NODELET_INFO_STREAM(" * Path min. distance\t\t-> " << mPathMinDist << " m");
+    double min_angle_deg = 0.0;
+    mNhNs.getParam("pos_tracking/path_min_angle", min_angle_deg);
+    NODELET_INFO_STREAM(" * Path min. angle\t\t-> " << min_angle_deg << " deg");
+    mPathMinAngle = min_angle_deg * M_PI / 180.0;
+
+    mNhNs.getParam("pos_tracking/pose_history_size", mPoseHistorySize);
+    NODELET_INFO_STREAM(" * Pose history size\t\t-> "
+                        << ((mPoseHistorySize > 0) ? std::to_string(mPoseHistorySize) : std::string("DISABLED")));
+
+    mNhNs.getParam("pos_tracking/imu_odometry", mImuOdomEnabled);
+    NODELET_INFO_STREAM(" * IMU propagated odometry\t-> " << (mImuOdomEnabled ? "ENABLED" : "DISABLED"));
+    if (mImuOdomEnabled)
+    {
+      mNhNs.getParam("pos_tracking/imu_odometry_rate", mImuOdomRate);
+      if (mImuOdomRate <= 0.0)
+      {
+        mImuOdomRate = 100.0;
+      }
+      NODELET_INFO_STREAM(" * IMU odometry rate\t\t-> " << mImuOdomRate << " Hz");
+      mNhNs.getParam("pos_tracking/publish_imu_odometry_tf", mPublishImuOdomTf);
+      NODELET_INFO_STREAM(" * IMU odometry TF\t\t-> " << (mPublishImuOdomTf ? "ENABLED" : "DISABLED"));
+    }
 
     mNhNs.getParam("pos_tracking/initial_base_pose", mInitialBasePose);
 
@@ -1099,6 +1361,22 @@ void ZEDWrapperNodelet::readObjDetParams()
     NODELET_INFO_STREAM(" * Allow reduced precision\t-> " << (mObjDetReducedPrecision ? "ENABLED" : "DISABLED"));
     mNhNs.getParam("object_detection/prediction_timeout", mObjDetPredTimeout);
     NODELET_INFO_STREAM(" * Prediction Timeout\t\t-> " << mObjDetPredTimeout);
+    mNhNs.getParam("object_detection/async_detection", mObjDetAsync);
+    NODELET_INFO_STREAM(" * Asynchronous detection\t-> " << (mObjDetAsync ? "ENABLED" : "DISABLED"));
+    mNhNs.getParam("object_detection/max_pub_rate", mObjDetMaxRate);
+    NODELET_INFO_STREAM(" * Max. publishing rate\t\t-> "
+                        << ((mObjDetMaxRate > 0.0) ? std::to_string(mObjDetMaxRate) : std::string("GRAB RATE")));
+    mNhNs.getParam("object_detection/object_depth", mObjDetDepth);
+    NODELET_INFO_STREAM(" * Objects depth\t\t-> " << (mObjDetDepth ? "ENABLED" : "DISABLED"));
+    if (mObjDetDepth)
+    {
+      mNhNs.getParam("object_detection/object_depth_patch_size", mObjDetDepthPatchSize);
+      mObjDetDepthPatchSize = std::max(0, mObjDetDepthPatchSize);
+      NODELET_INFO_STREAM(" * Objects depth patch size\t-> " << mObjDetDepthPatchSize);
+      mNhNs.getParam("object_detection/object_depth_inlier_tolerance", mObjDetDepthInlierTol);
+      mObjDetDepthInlierTol = std::max(0.0f, mObjDetDepthInlierTol);
+      NODELET_INFO_STREAM(" * Objects depth inlier tol.\t-> " << mObjDetDepthInlierTol);
+    }
 
     std::string model_str;
     mNhNs.getParam("object_detection/model", model_str);
@@ -1207,6 +1485,207 @@ void ZEDWrapperNodelet::readSvoParams()
   NODELET_INFO_STREAM(" * SVO REC compression\t\t-> " << sl::toString(mSvoComprMode));
 }
 
+void ZEDWrapperNodelet::readThreadsParams()
+{
+  NODELET_INFO_STREAM("*** THREADS PARAMETERS ***");
+
+  auto readSched = [this](const std::string& name, sl_tools::ThreadSchedParams& sched) {
+    mNhNs.getParam("threads/" + name + "_sched_policy", sched.policy);
+    mNhNs.getParam("threads/" + name + "_priority", sched.priority);
+    mNhNs.getParam("threads/" + name + "_cpus", sched.cpus);
+
+    std::stringstream ss;
+    ss << sched.policy;
+    if (sched.policy != "SCHED_OTHER")
+    {
+      ss << " - priority " << sched.priority;
+    }
+    ss << " - CPUs [";
+    for (size_t i = 0; i < sched.cpus.size(); i++)
+    {
+      ss << (i > 0 ? "," : "") << sched.cpus[i];
+    }
+    ss << "]";
+
+    NODELET_INFO_STREAM(" * " << name << " thread\t\t-> " << ss.str());
+  };
+
+  readSched("grab", mGrabThreadSched);
+  readSched("camera_control", mCamCtrlThreadSched);
+  if (mUseSharedExecutor)
+  {
+    // Sensors and point cloud are processed by the worker threads of the shared executor
+    readSched("executor_workers", mExecThreadSched);
+    NODELET_INFO(" * 'sensors' and 'pointcloud' thread parameters are not used with the shared executor");
+  }
+  else
+  {
+    readSched("sensors", mSensThreadSched);
+    readSched("pointcloud", mPcThreadSched);
+  }
+}
+
+void ZEDWrapperNodelet::applyThreadSched(const std::string& threadName, const sl_tools::ThreadSchedParams& sched)
+{
+  if (sched.policy == "SCHED_OTHER" && sched.cpus.empty())
+  {
+    return;  // Default scheduling
+  }
+
+  std::string error;
+  if (sl_tools::setThreadScheduling(sched, error))
+  {
+    NODELET_INFO_STREAM(threadName << " thread scheduling applied: " << sched.policy);
+  }
+  else
+  {
+    NODELET_WARN_STREAM(threadName << " thread scheduling partially applied, the default is used for the rest: "
+                                   << error);
+  }
+}
+
+void ZEDWrapperNodelet::readGovernorParams()
+{
+  NODELET_INFO_STREAM("*** LOAD GOVERNOR PARAMETERS ***");
+
+  mNhNs.getParam("governor/governor_enabled", mGovEnabled);
+  NODELET_INFO_STREAM(" * Load governor\t\t-> " << (mGovEnabled ? "ENABLED" : "DISABLED"));
+
+  if (!mGovEnabled)
+  {
+    return;
+  }
+
+  std::vector<std::string> order = { "pointcloud", "stereo", "depth", "obj_det" };
+  mNhNs.getParam("governor/shed_order", order);
+
+  mGovShedOrder.clear();
+  std::string order_str;
+  for (const auto& step : order)
+  {
+    if (step == "pointcloud")
+    {
+      mGovShedOrder.push_back(GOV_POINTCLOUD);
+    }
+    else if (step == "stereo")
+    {
+      mGovShedOrder.push_back(GOV_STEREO);
+    }
+    else if (step == "depth")
+    {
+      mGovShedOrder.push_back(GOV_DEPTH);
+    }
+    else if (step == "obj_det")
+    {
+      mGovShedOrder.push_back(GOV_OBJ_DET);
+    }
+    else
+    {
+      NODELET_WARN_STREAM("Not valid 'governor/shed_order' value: '" << step << "'. Ignored.");
+      continue;
+    }
+    order_str += (order_str.empty() ? "" : ", ") + step;
+  }
+  NODELET_INFO_STREAM(" * Shed order\t\t\t-> [" << order_str << "]");
+
+  mNhNs.getParam("governor/overload_threshold", mGovOverloadThresh);
+  NODELET_INFO_STREAM(" * Overload threshold\t\t-> " << mGovOverloadThresh);
+  mNhNs.getParam("governor/restore_threshold", mGovRestoreThresh);
+  if (mGovRestoreThresh >= mGovOverloadThresh)
+  {
+    mGovRestoreThresh = 0.75 * mGovOverloadThresh;
+    NODELET_WARN_STREAM("'governor/restore_threshold' must be lower than 'governor/overload_threshold'. Using "
+                        << mGovRestoreThresh);
+  }
+  NODELET_INFO_STREAM(" * Restore threshold\t\t-> " << mGovRestoreThresh);
+  mNhNs.getParam("governor/overload_time", mGovOverloadTime);
+  NODELET_INFO_STREAM(" * Overload time\t\t-> " << mGovOverloadTime << " sec");
+  mNhNs.getParam("governor/restore_time", mGovRestoreTime);
+  NODELET_INFO_STREAM(" * Restore time\t\t-> " << mGovRestoreTime << " sec");
+}
+
+void ZEDWrapperNodelet::updateGovernor(double mean_proc_sec)
+{
+  if (!mGovEnabled || mGovShedOrder.empty())
+  {
+    return;
+  }
+
+  double load = mean_proc_sec * mPubFrameRate;
+  int level = mGovLevel;
+
+  if (load > mGovOverloadThresh && level < static_cast<int>(mGovShedOrder.size()))
+  {
+    mGovUnderCount = 0;
+    if (++mGovOverCount >= mGovOverloadTime * mPubFrameRate)
+    {
+      mGovOverCount = 0;
+      mGovLevel = level + 1;
+      NODELET_WARN_STREAM("Load governor: processing load " << load * 100. << "% - degradation level "
+                                                             << mGovLevel << "/" << mGovShedOrder.size());
+      publishGovernorStatus();
+    }
+  }
+  else if (load < mGovRestoreThresh && level > 0)
+  {
+    mGovOverCount = 0;
+    if (++mGovUnderCount >= mGovRestoreTime * mPubFrameRate)
+    {
+      mGovUnderCount = 0;
+      mGovLevel = level - 1;
+      NODELET_INFO_STREAM("Load governor: processing load " << load * 100. << "% - degradation level "
+                                                             << mGovLevel << "/" << mGovShedOrder.size());
+      publishGovernorStatus();
+    }
+  }
+  else
+  {
+    mGovOverCount = 0;
+    mGovUnderCount = 0;
+  }
+}
+
+bool ZEDWrapperNodelet::isGovShed(GovStep step)
+{
+  int level = mGovLevel;
+  for (int i = 0; i < level && i < static_cast<int>(mGovShedOrder.size()); i++)
+  {
+    if (mGovShedOrder[i] == step)
+    {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool ZEDWrapperNodelet::govSkipFrame(GovStep step)
+{
+  return isGovShed(step) && (mFrameCount % 2) != 0;
+}
+
+void ZEDWrapperNodelet::publishGovernorStatus()
+{
+  static const char* stepNames[] = { "pointcloud", "stereo", "depth", "obj_det" };
+
+  diagnostic_msgs::DiagnosticStatusPtr govMsg = boost::make_shared<diagnostic_msgs::DiagnosticStatus>();
+
+  int level = mGovLevel;
+  govMsg->name = getName() + ": load governor";
+  govMsg->hardware_id = std::to_string(mZedSerialNumber);
+  govMsg->level = (level == 0) ? diagnostic_msgs::DiagnosticStatus::OK : diagnostic_msgs::DiagnosticStatus::WARN;
+  govMsg->message = "Degradation level " + std::to_string(level) + "/" + std::to_string(mGovShedOrder.size());
+
+  for (size_t i = 0; i < mGovShedOrder.size(); i++)
+  {
+    diagnostic_msgs::KeyValue kv;
+    kv.key = stepNames[mGovShedOrder[i]];
+    kv.value = (static_cast<int>(i) < level) ? "SHED" : "ACTIVE";
+    govMsg->values.push_back(kv);
+  }
+
+  mPubGovStatus.publish(govMsg);
+}
+
 void ZEDWrapperNodelet::readDynParams()
 {
   std::cerr << "Ci sei o no?" << std::endl << std::flush;
@@ -1242,15 +1721,6 @@ void ZEDWrapperNodelet::readDynParams()
     NODELET_INFO_STREAM("  * [DYN] whitebalance_temperature\t\t-> " << mCamWB);
   }
 
-  if (mCamAutoExposure)
-  {
-    mTriggerAutoExposure = true;
-  }
-  if (mCamAutoWB)
-  {
-    mTriggerAutoWB = true;
-  }
-
   if (!mDepthDisabled)
   {
     mNhNs.getParam("depth_confidence", mCamDepthConfidence);
@@ -1308,6 +1778,14 @@ void ZEDWrapperNodelet::readParameters()
   readSvoParams();
   // <---- SVO
 
+  // ----> Threads
+  readThreadsParams();
+  // <---- Threads
+
+  // ----> Load governor
+  readGovernorParams();
+  // <---- Load governor
+
   // Remote Stream
   mNhNs.getParam("stream", mRemoteStreamAddr);
 
@@ -1330,6 +1808,8 @@ void ZEDWrapperNodelet::readParameters()
   mTempLeftFrameId = mCameraName + "_temp_left_link";
   mTempRightFrameId = mCameraName + "_temp_right_link";
 
+  mImuOdomFrameId = mBaseFrameId + "_imu_odom";
+
   mDepthFrameId = mLeftCamFrameId;
   mDepthOptFrameId = mLeftCamOptFrameId;
 
@@ -1645,6 +2125,25 @@ void ZEDWrapperNodelet::initTransforms()
   mMap2OdomTransf.setIdentity();   // broadcasted if `publish_map_tf` is true
   mMap2BaseTransf.setIdentity();   // used internally, but not broadcasted
                                    // <---- Dynamic transforms
+
+  std::lock_guard<std::mutex> lock(mOdomMutex);
+  updatePoseSnapshot(ros::Time(0));
+
+  if (mPoseHistory)
+  {
+    mPoseHistory->clear();  // The stored poses refer to the previous origin
+  }
+}
+
+void ZEDWrapperNodelet::updatePoseSnapshot(ros::Time t)
+{
+  std::shared_ptr<PoseSnapshot> pose = std::make_shared<PoseSnapshot>();
+  pose->stamp = t;
+  pose->odom2base = mOdom2BaseTransf;
+  pose->map2base = mMap2BaseTransf;
+  pose->map2odom = mMap2OdomTransf;
+
+  std::atomic_store(&mPoseSnapshot, PoseSnapshotPtr(pose));
 }
 
 bool ZEDWrapperNodelet::getCamera2BaseTransform()
@@ -1674,8 +2173,7 @@ bool ZEDWrapperNodelet::getCamera2BaseTransform()
   }
   catch (tf2::TransformException& ex)
   {
-    static bool first_error = true;
-    if (!first_error)
+    if (!mCamera2BaseTfFirstErr)
     {
       NODELET_DEBUG_THROTTLE(1.0, "Transform error: %s", ex.what());
       NODELET_WARN_THROTTLE(1.0, "The tf from '%s' to '%s' is not available.", mCameraFrameId.c_str(),
@@ -1686,7 +2184,7 @@ bool ZEDWrapperNodelet::getCamera2BaseTransform()
                             "or a modified URDF not correctly reproducing the ZED "
                             "TF chain '%s' -> '%s' -> '%s'",
                             mBaseFrameId.c_str(), mCameraFrameId.c_str(), mDepthFrameId.c_str());
-      first_error = false;
+      mCamera2BaseTfFirstErr = false;
     }
 
     mCamera2BaseTransf.setIdentity();
@@ -1724,8 +2222,7 @@ bool ZEDWrapperNodelet::getSens2CameraTransform()
   }
   catch (tf2::TransformException& ex)
   {
-    static bool first_error = true;
-    if (!first_error)
+    if (!mSens2CameraTfFirstErr)
     {
       NODELET_DEBUG_THROTTLE(1.0, "Transform error: %s", ex.what());
       NODELET_WARN_THROTTLE(1.0, "The tf from '%s' to '%s' is not available.", mDepthFrameId.c_str(),
@@ -1736,7 +2233,7 @@ bool ZEDWrapperNodelet::getSens2CameraTransform()
                             "or a modified URDF not correctly reproducing the ZED "
                             "TF chain '%s' -> '%s' -> '%s'",
                             mBaseFrameId.c_str(), mCameraFrameId.c_str(), mDepthFrameId.c_str());
-      first_error = false;
+      mSens2CameraTfFirstErr = false;
     }
 
     mSensor2CameraTransf.setIdentity();
@@ -1775,8 +2272,7 @@ bool ZEDWrapperNodelet::getSens2BaseTransform()
   }
   catch (tf2::TransformException& ex)
   {
-    static bool first_error = true;
-    if (!first_error)
+    if (!mSens2BaseTfFirstErr)
     {
       NODELET_DEBUG_THROTTLE(1.0, "Transform error: %s", ex.what());
       NODELET_WARN_THROTTLE(1.0, "The tf from '%s' to '%s' is not available.", mDepthFrameId.c_str(),
@@ -1787,7 +2283,7 @@ bool ZEDWrapperNodelet::getSens2BaseTransform()
                             "or a modified URDF not correctly reproducing the ZED "
                             "TF chain '%s' -> '%s' -> '%s'",
                             mBaseFrameId.c_str(), mCameraFrameId.c_str(), mDepthFrameId.c_str());
-      first_error = false;
+      mSens2BaseTfFirstErr = false;
     }
 
     mSensor2BaseTransf.setIdentity();
@@ -1889,14 +2385,67 @@ bool ZEDWrapperNodelet::on_reset_tracking(zed_interfaces::reset_tracking::Reques
 bool ZEDWrapperNodelet::on_reset_odometry(zed_interfaces::reset_odometry::Request& req,
                                           zed_interfaces::reset_odometry::Response& res)
 {
-  std::lock_guard<std::mutex> lock(mOdomMutex);
+  mOdomMutex.lock();
   mOdom2BaseTransf.setIdentity();
+
+  // The map pose is owned by the grab thread: update only the odometry of the current snapshot
+  std::shared_ptr<PoseSnapshot> pose = std::make_shared<PoseSnapshot>(*getPoseSnapshot());
+  pose->odom2base.setIdentity();
+  std::atomic_store(&mPoseSnapshot, PoseSnapshotPtr(pose));
+  mOdomMutex.unlock();
+
+  mPathMutex.lock();
   mOdomPath.clear();
+  mPathMutex.unlock();
+
+  if (mPoseHistory)
+  {
+    mPoseHistory->clear();  // The stored poses refer to the previous odometry origin
+  }
+
+  mImuOdomMutex.lock();
+  mImuOdomAnchorValid = false;  // Do not estimate the velocity across the reset
+  mImuOdomMutex.unlock();
 
   res.reset_done = true;
   return true;
 }
 
+bool ZEDWrapperNodelet::on_get_pose_at_time(zed_nodelets::GetPoseAtTime::Request& req,
+                                            zed_nodelets::GetPoseAtTime::Response& res)
+{
+  bool mapFrame = false;
+  if (req.frame_id == mMapFrameId)
+  {
+    mapFrame = true;
+  }
+  else if (!req.frame_id.empty() && req.frame_id != mOdomFrameId)
+  {
+    NODELET_WARN_STREAM("get_pose_at_time: frame '" << req.frame_id << "' not supported. Use '" << mOdomFrameId
+                                                    << "' or '" << mMapFrameId << "'");
+    return false;
+  }
+
+  std::vector<sl_tools::PoseHistory::Sample> samples;
+  std::vector<uint8_t> valid;
+  mPoseHistory->lookup(req.stamps, samples, valid);
+
+  res.poses.resize(samples.size());
+  res.valid.resize(samples.size());
+  for (size_t i = 0; i < samples.size(); i++)
+  {
+    res.valid[i] = valid[i] != 0;
+    res.poses[i].header.stamp = req.stamps[i];
+    res.poses[i].header.frame_id = mapFrame ? mMapFrameId : mOdomFrameId;
+    if (valid[i])
+    {
+      tf2::toMsg(mapFrame ? samples[i].map2base : samples[i].odom2base, res.poses[i].pose);
+    }
+  }
+
+  return true;
+}
+
 bool ZEDWrapperNodelet::start_3d_mapping()
 {
   if (!mMappingEnabled)
@@ -1966,6 +2515,7 @@ bool ZEDWrapperNodelet::start_3d_mapping()
     }
 
     mMappingRunning = true;
+    markStartupPhase(STARTUP_MAPPING);
 
     mFusedPcTimer =
         mNhNs.createTimer(ros::Duration(1.0 / mFusedPcPubFreq), &ZEDWrapperNodelet::callback_pubFusedPointCloud, this);
@@ -2032,6 +2582,7 @@ bool ZEDWrapperNodelet::start_obj_detect()
   od_p.prediction_timeout_s = mObjDetPredTimeout;
   od_p.allow_reduced_precision_inference = mObjDetReducedPrecision;
   od_p.max_range = mObjDetMaxRange;
+  od_p.image_sync = !mObjDetAsync;  // Asynchronous: the inference does not slow down the grab
 
   mObjDetFilter.clear();
   if (mObjDetPeopleEnable)
@@ -2081,8 +2632,16 @@ bool ZEDWrapperNodelet::start_obj_detect()
     mPubObjDet = mNhNs.advertise<zed_interfaces::ObjectsStamped>(object_det_topic, 1);
     NODELET_INFO_STREAM(" * Advertised on topic " << mPubObjDet.getTopic());
   }
+  if (mObjDetDepth && mPubObjDetDepth.getTopic().empty())
+  {
+    std::string object_det_depth_topic = "obj_det/objects_depth";
+
+    mPubObjDetDepth = mNhNs.advertise<zed_nodelets::ObjectsDepthStamped>(object_det_depth_topic, 1);
+    NODELET_INFO_STREAM(" * Advertised on topic " << mPubObjDetDepth.getTopic());
+  }
 
   mObjDetRunning = true;
+  markStartupPhase(STARTUP_OBJ_DET);
   return true;
 }
 
@@ -2095,6 +2654,12 @@ void ZEDWrapperNodelet::stop_obj_detect()
     mObjDetEnabled = false;
     mZed.disableObjectDetection();
 
+    // Drop the queued results
+    mObjDetDataMutex.lock();
+    mObjDetDataReady = false;
+    mObjDetDepthReady = false;
+    mObjDetDataMutex.unlock();
+
     // ----> Send an empty message to indicate that no more objects are tracked
     // (e.g clean Rviz2)
     zed_interfaces::ObjectsStampedPtr objMsg = boost::make_shared<zed_interfaces::ObjectsStamped>();
@@ -2112,6 +2677,11 @@ void ZEDWrapperNodelet::stop_obj_detect()
 }
 
 void ZEDWrapperNodelet::start_pos_tracking()
+{
+  start_pos_tracking(mInitialBasePose);
+}
+
+void ZEDWrapperNodelet::start_pos_tracking(const std::vector<float>& basePose)
 {
   NODELET_INFO_STREAM("*** Starting Positional Tracking ***");
 
@@ -2132,13 +2702,15 @@ void ZEDWrapperNodelet::start_pos_tracking()
 
   do
   {
-    transformOk = set_pose(mInitialBasePose[0], mInitialBasePose[1], mInitialBasePose[2], mInitialBasePose[3],
-                           mInitialBasePose[4], mInitialBasePose[5]);
+    transformOk = set_pose(basePose[0], basePose[1], basePose[2], basePose[3], basePose[4], basePose[5]);
 
     elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::high_resolution_clock::now() - start)
                   .count();
 
-    std::this_thread::sleep_for(std::chrono::milliseconds(500));
+    if (!transformOk)
+    {
+      std::this_thread::sleep_for(std::chrono::milliseconds(500));
+    }
 
     if (elapsed > 10000)
     {
@@ -2197,6 +2769,7 @@ void ZEDWrapperNodelet::start_pos_tracking()
   if (err == sl::ERROR_CODE::SUCCESS)
   {
     mPosTrackingStarted = true;
+    markStartupPhase(STARTUP_POS_TRACKING);
   }
   else
   {
@@ -2342,21 +2915,166 @@ void ZEDWrapperNodelet::publishOdom(tf2::Transform odom2baseTransf, sl::Pose& sl
   }
 }
 
-void ZEDWrapperNodelet::publishPose()
+void ZEDWrapperNodelet::updateImuOdomAnchor(const tf2::Transform& odom2baseTransf, ros::Time t)
 {
-  size_t poseSub = mPubPose.getNumSubscribers();
-  size_t poseCovSub = mPubPoseCov.getNumSubscribers();
+  // Rotation of the IMU in base frame: base -> sensor -> IMU
+  sl::Orientation sl_or = mSlCamImuTransf.getOrientation();
+  tf2::Quaternion sens2imu(sl_or.ox, sl_or.oy, sl_or.oz, sl_or.ow);
 
-  std_msgs::Header header;
-  header.stamp = mFrameTimestamp;
-  header.frame_id = mMapFrameId;  // frame
+  std::lock_guard<std::mutex> lock(mImuOdomMutex);
 
-  geometry_msgs::Pose pose;
+  mImuOdomBase2Imu = mSensor2BaseTransf.getRotation().inverse() * sens2imu;
 
-  // Add all value in Pose message
-  pose.position.x = mMap2BaseTransf.getOrigin().x();
-  pose.position.y = mMap2BaseTransf.getOrigin().y();
-  pose.position.z = mMap2BaseTransf.getOrigin().z();
+  // ----> Linear velocity from the last two visual solutions
+  double dt = (t - mImuOdomAnchorTs).toSec();
+  if (mImuOdomAnchorValid && dt > 0.0 && dt < 0.5)
+  {
+    mImuOdomLinVel = (odom2baseTransf.getOrigin() - mImuOdomAnchor.getOrigin()) / dt;
+  }
+  else
+  {
+    mImuOdomLinVel.setZero();
+  }
+  // <---- Linear velocity from the last two visual solutions
+
+  mImuOdomAnchor = odom2baseTransf;
+  mImuOdomAnchorTs = t;
+  mImuOdomAnchorValid = true;
+  mImuOdomReanchor = true;
+}
+
+void ZEDWrapperNodelet::propagateImuOdom(const sl::SensorsData::IMUData& imuData, ros::Time t)
+{
+  // Maximum propagation time without a new visual solution
+  const double max_horizon_sec = 0.5;
+
+  std::lock_guard<std::mutex> lock(mImuOdomMutex);
+
+  // ----> Store the sample
+  if (!mImuOdomSamples.empty() && t <= mImuOdomSamples.back().stamp)
+  {
+    return;  // Already processed
+  }
+
+  ImuOdomSample sample;
+  sample.stamp = t;
+  sample.angVel = tf2::quatRotate(mImuOdomBase2Imu, tf2::Vector3(imuData.angular_velocity[0] * DEG2RAD,
+                                                                 imuData.angular_velocity[1] * DEG2RAD,
+                                                                 imuData.angular_velocity[2] * DEG2RAD));
+  mImuOdomSamples.push(sample);
+  // <---- Store the sample
+
+  if (!mImuOdomAnchorValid || (t - mImuOdomAnchorTs).toSec() > max_horizon_sec)
+  {
+    return;
+  }
+
+  // Integrate the rotation of one sample in base frame
+  auto integrate = [this](const ImuOdomSample& s, ros::Time prev) {
+    double dt = (s.stamp - prev).toSec();
+    double angle = s.angVel.length() * dt;
+    if (dt > 0.0 && angle > 1e-12)
+    {
+      mImuOdomTransf.setRotation(mImuOdomTransf.getRotation() * tf2::Quaternion(s.angVel.normalized(), angle));
+    }
+  };
+
+  if (mImuOdomReanchor)
+  {
+    // ----> Snap to the visual solution and replay the samples received after the frame
+    mImuOdomTransf = mImuOdomAnchor;
+    mImuOdomTs = mImuOdomAnchorTs;
+
+    size_t count = mImuOdomSamples.size();
+    for (size_t i = 0; i < count; i++)
+    {
+      const ImuOdomSample& s = mImuOdomSamples[i];
+      if (s.stamp > mImuOdomTs)
+      {
+        integrate(s, mImuOdomTs);
+        mImuOdomTs = s.stamp;
+      }
+    }
+    mImuOdomReanchor = false;
+    // <---- Snap to the visual solution and replay the samples received after the frame
+  }
+  else if (t > mImuOdomTs)
+  {
+    integrate(sample, mImuOdomTs);
+    mImuOdomTs = t;
+  }
+
+  // Constant velocity for the translation, the accelerometer integration drifts too fast
+  mImuOdomTransf.setOrigin(mImuOdomAnchor.getOrigin() + mImuOdomLinVel * (mImuOdomTs - mImuOdomAnchorTs).toSec());
+
+  if (mTwoDMode)
+  {
+    tf2::Vector3 tr_2d = mImuOdomTransf.getOrigin();
+    tr_2d.setZ(mFixedZValue);
+    mImuOdomTransf.setOrigin(tr_2d);
+
+    double roll, pitch, yaw;
+    tf2::Matrix3x3(mImuOdomTransf.getRotation()).getRPY(roll, pitch, yaw);
+
+    tf2::Quaternion quat_2d;
+    quat_2d.setRPY(0.0, 0.0, yaw);
+
+    mImuOdomTransf.setRotation(quat_2d);
+  }
+
+  // ----> Publish at the requested rate
+  if ((mImuOdomTs - mImuOdomLastPubTs).toSec() < 0.95 / mImuOdomRate)
+  {
+    return;
+  }
+  mImuOdomLastPubTs = mImuOdomTs;
+
+  if (mPubImuOdom.getNumSubscribers() > 0)
+  {
+    nav_msgs::OdometryPtr odomMsg = boost::make_shared<nav_msgs::Odometry>();
+
+    odomMsg->header.stamp = mImuOdomTs;
+    odomMsg->header.frame_id = mOdomFrameId;
+    odomMsg->child_frame_id = mBaseFrameId;
+
+    tf2::toMsg(mImuOdomTransf, odomMsg->pose.pose);
+
+    // The twist is expressed in the child frame
+    tf2::Vector3 linVel = tf2::quatRotate(mImuOdomTransf.getRotation().inverse(), mImuOdomLinVel);
+    odomMsg->twist.twist.linear.x = linVel.x();
+    odomMsg->twist.twist.linear.y = linVel.y();
+    odomMsg->twist.twist.linear.z = linVel.z();
+    odomMsg->twist.twist.angular.x = sample.angVel.x();
+    odomMsg->twist.twist.angular.y = sample.angVel.y();
+    odomMsg->twist.twist.angular.z = sample.angVel.z();
+
+    mPubImuOdom.publish(odomMsg);
+  }
+
+  if (mPublishImuOdomTf)
+  {
+    geometry_msgs::TransformStamped transformStamped;
+    fillTransformStamped(transformStamped, mImuOdomTransf, mOdomFrameId, mImuOdomFrameId, mImuOdomTs);
+    mTfBroadcaster.sendTransform(transformStamped);
+  }
+  // <---- Publish at the requested rate
+}
+
+void ZEDWrapperNodelet::publishPose()
+{
+  size_t poseSub = mPubPose.getNumSubscribers();
+  size_t poseCovSub = mPubPoseCov.getNumSubscribers();
+
+  std_msgs::Header header;
+  header.stamp = mFrameTimestamp;
+  header.frame_id = mMapFrameId;  // frame
+
+  geometry_msgs::Pose pose;
+
+  // Add all value in Pose message
+  pose.position.x = mMap2BaseTransf.getOrigin().x();
+  pose.position.y = mMap2BaseTransf.getOrigin().y();
+  pose.position.z = mMap2BaseTransf.getOrigin().z();
   pose.orientation.x = mMap2BaseTransf.getRotation().x();
   pose.orientation.y = mMap2BaseTransf.getRotation().y();
   pose.orientation.z = mMap2BaseTransf.getRotation().z();
@@ -2466,34 +3184,95 @@ void ZEDWrapperNodelet::publishDepth(sensor_msgs::ImagePtr imgMsgPtr, sl::Mat de
   mPubDepth.publish(imgMsgPtr, mDepthCamInfoMsg);
 }
 
-void ZEDWrapperNodelet::publishDisparity(sl::Mat disparity, ros::Time t)
+void ZEDWrapperNodelet::publishDepthCompressed(sl::Mat depthMm, ros::Time t)
 {
-  sl::CameraInformation zedParam = mZed.getCameraInformation(mMatResol);
+  sensor_msgs::CompressedImagePtr depthMsg = boost::make_shared<sensor_msgs::CompressedImage>();
 
-  sensor_msgs::ImagePtr disparityImgMsg = boost::make_shared<sensor_msgs::Image>();
-  stereo_msgs::DisparityImagePtr disparityMsg = boost::make_shared<stereo_msgs::DisparityImage>();
+  depthMsg->header.stamp = t;
+  depthMsg->header.frame_id = mDepthOptFrameId;
+  depthMsg->format = sl_tools::depth_codec::FORMAT;
 
-  sl_tools::imageToROSmsg(disparityImgMsg, disparity, mDisparityFrameId, t);
+  if (!sl_tools::depth_codec::compress(depthMm.getPtr<sl::ushort1>(), depthMm.getWidth(), depthMm.getHeight(),
+                                       depthMm.getStepBytes(), mDepthRvlMaxError, depthMsg->data))
+  {
+    NODELET_WARN_THROTTLE(5.0, "Depth compression failed");
+    return;
+  }
+
+  NODELET_DEBUG_STREAM_THROTTLE(5.0, "Depth compression ratio: "
+                                         << static_cast<double>(depthMm.getStepBytes() * depthMm.getHeight()) /
+                                                depthMsg->data.size());
+
+  mPubDepthRvl.publish(depthMsg);
+}
+
+void ZEDWrapperNodelet::publishDepthFiltered(sl::Mat depth, sl::Mat conf, ros::Time t)
+{
+  sensor_msgs::ImagePtr depthMsg = boost::make_shared<sensor_msgs::Image>();
 
-  disparityMsg->image = *disparityImgMsg;
+  depthMsg->header.stamp = t;
+  depthMsg->header.frame_id = mDepthOptFrameId;
+  depthMsg->height = depth.getHeight();
+  depthMsg->width = depth.getWidth();
+
+  int num = 1;  // for endianness detection
+  depthMsg->is_bigendian = !(*(char*)&num == 1);
+
+  // The filter writes directly into the message buffer
+  if (!mOpenniDepthMode)
+  {
+    depthMsg->encoding = sensor_msgs::image_encodings::TYPE_32FC1;
+    depthMsg->step = depthMsg->width * sizeof(float);
+    depthMsg->data.resize(depthMsg->step * depthMsg->height);
+    sl_tools::filterDepth(depth, conf, mDepthFilterParams, reinterpret_cast<float*>(depthMsg->data.data()),
+                          depthMsg->step);
+  }
+  else
+  {
+    depthMsg->encoding = sensor_msgs::image_encodings::TYPE_16UC1;
+    depthMsg->step = depthMsg->width * sizeof(uint16_t);
+    depthMsg->data.resize(depthMsg->step * depthMsg->height);
+    sl_tools::filterDepthU16mm(depth, conf, mDepthFilterParams, reinterpret_cast<uint16_t*>(depthMsg->data.data()),
+                               depthMsg->step);
+  }
+
+  mDepthCamInfoMsg->header.stamp = t;
+  mPubDepthFiltered.publish(depthMsg, mDepthCamInfoMsg);
+}
+
+void ZEDWrapperNodelet::publishDisparity(sl::Mat disparity, ros::Time t)
+{
+  CalibSnapshotPtr calib = getCalibSnapshot();
+
+  // Reuse the previous message, and its data buffer, if no intra-process subscriber still holds it
+  if (!mDisparityMsg || !mDisparityMsg.unique())
+  {
+    mDisparityMsg = boost::make_shared<stereo_msgs::DisparityImage>();
+  }
+  stereo_msgs::DisparityImagePtr disparityMsg = mDisparityMsg;
+
+  // The disparity is copied only once, directly into the embedded image
+  sl_tools::imageToROSmsg(disparityMsg->image, disparity, mDisparityFrameId, t);
   disparityMsg->header = disparityMsg->image.header;
 
-  disparityMsg->f = zedParam.camera_configuration.calibration_parameters.left_cam.fx;
-  disparityMsg->T = zedParam.camera_configuration.calibration_parameters.getCameraBaseline();
+  disparityMsg->f = calib->fx;
+  disparityMsg->T = calib->baseline;
 
   if (disparityMsg->T > 0)
   {
     disparityMsg->T *= -1.0f;
   }
 
-  disparityMsg->min_disparity = disparityMsg->f * disparityMsg->T / mZed.getInitParameters().depth_minimum_distance;
-  disparityMsg->max_disparity = disparityMsg->f * disparityMsg->T / mZed.getInitParameters().depth_maximum_distance;
+  disparityMsg->min_disparity = calib->minDisparity;
+  disparityMsg->max_disparity = calib->maxDisparity;
 
   mPubDisparity.publish(disparityMsg);
 }
 
 void ZEDWrapperNodelet::pointcloud_thread_func()
 {
+  applyThreadSched("Pointcloud", mPcThreadSched);
+
   std::unique_lock<std::mutex> lock(mPcMutex);
 
   while (!mStopNode)
@@ -2517,18 +3296,27 @@ void ZEDWrapperNodelet::pointcloud_thread_func()
     // ----> Check publishing frequency
     double pc_period_msec = 1000.0 / mPointCloudFreq;
 
-    static std::chrono::steady_clock::time_point last_time = std::chrono::steady_clock::now();
     std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
 
-    double elapsed_msec = std::chrono::duration_cast<std::chrono::milliseconds>(now - last_time).count();
+    double elapsed_msec = std::chrono::duration_cast<std::chrono::milliseconds>(now - mLastPcThreadTime).count();
 
     if (elapsed_msec < pc_period_msec)
     {
       std::this_thread::sleep_for(std::chrono::milliseconds(static_cast<long int>(pc_period_msec - elapsed_msec)));
     }
+    else
+    {
+      // The point cloud cannot be faster than the grab
+      double expected_msec = std::max(pc_period_msec, 1000.0 / mPubFrameRate);
+      if (elapsed_msec > 1.5 * expected_msec)
+      {
+        mPcDeadlineMiss++;
+      }
+    }
+    mPcLoopCount++;
     // <---- Check publishing frequency
 
-    last_time = std::chrono::steady_clock::now();
+    mLastPcThreadTime = std::chrono::steady_clock::now();
     publishPointCloud();
 
     mPcDataReady = false;
@@ -2537,16 +3325,30 @@ void ZEDWrapperNodelet::pointcloud_thread_func()
   NODELET_DEBUG("Pointcloud thread finished");
 }
 
+void ZEDWrapperNodelet::pointcloud_task_func()
+{
+  std::lock_guard<std::mutex> lock(mPcMutex);
+
+  if (mStopNode || !mPcDataReady)
+  {
+    return;
+  }
+
+  mLastPcThreadTime = std::chrono::steady_clock::now();
+  publishPointCloud();
+
+  mPcDataReady = false;
+}
+
 void ZEDWrapperNodelet::publishPointCloud()
 {
   sensor_msgs::PointCloud2Ptr pointcloudMsg = boost::make_shared<sensor_msgs::PointCloud2>();
 
   // Publish freq calculation
-  static std::chrono::steady_clock::time_point last_time = std::chrono::steady_clock::now();
   std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
 
-  double elapsed_usec = std::chrono::duration_cast<std::chrono::microseconds>(now - last_time).count();
-  last_time = now;
+  double elapsed_usec = std::chrono::duration_cast<std::chrono::microseconds>(now - mLastPcPubTime).count();
+  mLastPcPubTime = now;
 
   mPcPeriodMean_usec->addValue(elapsed_usec);
 
@@ -2584,6 +3386,34 @@ void ZEDWrapperNodelet::publishPointCloud()
 }
 
 void ZEDWrapperNodelet::callback_pubFusedPointCloud(const ros::TimerEvent& e)
+{
+  if (!mUseSharedExecutor)
+  {
+    publishFusedPointCloud();
+    return;
+  }
+
+  // Lowest priority task, never queue more than one request
+  if (mFusedPcPending.exchange(true))
+  {
+    return;
+  }
+
+  std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+  std::chrono::steady_clock::time_point deadline =
+      now + std::chrono::microseconds(static_cast<int64_t>(1e6 / mFusedPcPubFreq));
+  bool posted = mExecutor->post(mExecutorClientId, sl_tools::TaskClass::FUSED_CLOUD, now, deadline, [this]() {
+    publishFusedPointCloud();
+    mFusedPcPending = false;
+  });
+
+  if (!posted)
+  {
+    mFusedPcPending = false;
+  }
+}
+
+void ZEDWrapperNodelet::publishFusedPointCloud()
 {
   sensor_msgs::PointCloud2Ptr pointcloudFusedMsg = boost::make_shared<sensor_msgs::PointCloud2>();
 
@@ -2594,7 +3424,7 @@ void ZEDWrapperNodelet::callback_pubFusedPointCloud(const ros::TimerEvent& e)
     return;
   }
 
-  std::lock_guard<std::mutex> lock(mCloseZedMutex);
+  std::shared_lock<std::shared_mutex> lock(mCloseZedMutex);
 
   if (!mZed.isOpened())
   {
@@ -2688,124 +3518,148 @@ void ZEDWrapperNodelet::callback_pubFusedPointCloud(const ros::TimerEvent& e)
 //   seq++;
 // }
 
-void ZEDWrapperNodelet::fillCamInfo(sl::Camera& zed, sensor_msgs::CameraInfoPtr leftCamInfoMsg,
-                                    sensor_msgs::CameraInfoPtr rightCamInfoMsg, std::string leftFrameId,
-                                    std::string rightFrameId, bool rawParam /*= false*/)
+void ZEDWrapperNodelet::fillCamInfo(sl::CalibrationParameters zedParam,
+                                    sensor_msgs::CameraInfo& leftCamInfoMsg, sensor_msgs::CameraInfo& rightCamInfoMsg,
+                                    std::string leftFrameId, std::string rightFrameId, bool rawParam /*= false*/)
 {
-  sl::CalibrationParameters zedParam;
-
-  if (rawParam)
-  {
-    zedParam = zed.getCameraInformation(mMatResol).camera_configuration.calibration_parameters_raw;
-  }
-  else
-  {
-    zedParam = zed.getCameraInformation(mMatResol).camera_configuration.calibration_parameters;
-  }
-
   float baseline = zedParam.getCameraBaseline();
-  leftCamInfoMsg->distortion_model = sensor_msgs::distortion_models::PLUMB_BOB;
-  rightCamInfoMsg->distortion_model = sensor_msgs::distortion_models::PLUMB_BOB;
-  leftCamInfoMsg->D.resize(5);
-  rightCamInfoMsg->D.resize(5);
-  leftCamInfoMsg->D[0] = zedParam.left_cam.disto[0];    // k1
-  leftCamInfoMsg->D[1] = zedParam.left_cam.disto[1];    // k2
-  leftCamInfoMsg->D[2] = zedParam.left_cam.disto[4];    // k3
-  leftCamInfoMsg->D[3] = zedParam.left_cam.disto[2];    // p1
-  leftCamInfoMsg->D[4] = zedParam.left_cam.disto[3];    // p2
-  rightCamInfoMsg->D[0] = zedParam.right_cam.disto[0];  // k1
-  rightCamInfoMsg->D[1] = zedParam.right_cam.disto[1];  // k2
-  rightCamInfoMsg->D[2] = zedParam.right_cam.disto[4];  // k3
-  rightCamInfoMsg->D[3] = zedParam.right_cam.disto[2];  // p1
-  rightCamInfoMsg->D[4] = zedParam.right_cam.disto[3];  // p2
-  leftCamInfoMsg->K.fill(0.0);
-  rightCamInfoMsg->K.fill(0.0);
-  leftCamInfoMsg->K[0] = static_cast<double>(zedParam.left_cam.fx);
-  leftCamInfoMsg->K[2] = static_cast<double>(zedParam.left_cam.cx);
-  leftCamInfoMsg->K[4] = static_cast<double>(zedParam.left_cam.fy);
-  leftCamInfoMsg->K[5] = static_cast<double>(zedParam.left_cam.cy);
-  leftCamInfoMsg->K[8] = 1.0;
-  rightCamInfoMsg->K[0] = static_cast<double>(zedParam.right_cam.fx);
-  rightCamInfoMsg->K[2] = static_cast<double>(zedParam.right_cam.cx);
-  rightCamInfoMsg->K[4] = static_cast<double>(zedParam.right_cam.fy);
-  rightCamInfoMsg->K[5] = static_cast<double>(zedParam.right_cam.cy);
-  rightCamInfoMsg->K[8] = 1.0;
-  leftCamInfoMsg->R.fill(0.0);
-  rightCamInfoMsg->R.fill(0.0);
+  leftCamInfoMsg.distortion_model = sensor_msgs::distortion_models::PLUMB_BOB;
+  rightCamInfoMsg.distortion_model = sensor_msgs::distortion_models::PLUMB_BOB;
+  leftCamInfoMsg.D.resize(5);
+  rightCamInfoMsg.D.resize(5);
+  leftCamInfoMsg.D[0] = zedParam.left_cam.disto[0];    // k1
+  leftCamInfoMsg.D[1] = zedParam.left_cam.disto[1];    // k2
+  leftCamInfoMsg.D[2] = zedParam.left_cam.disto[4];    // k3
+  leftCamInfoMsg.D[3] = zedParam.left_cam.disto[2];    // p1
+  leftCamInfoMsg.D[4] = zedParam.left_cam.disto[3];    // p2
+  rightCamInfoMsg.D[0] = zedParam.right_cam.disto[0];  // k1
+  rightCamInfoMsg.D[1] = zedParam.right_cam.disto[1];  // k2
+  rightCamInfoMsg.D[2] = zedParam.right_cam.disto[4];  // k3
+  rightCamInfoMsg.D[3] = zedParam.right_cam.disto[2];  // p1
+  rightCamInfoMsg.D[4] = zedParam.right_cam.disto[3];  // p2
+  leftCamInfoMsg.K.fill(0.0);
+  rightCamInfoMsg.K.fill(0.0);
+  leftCamInfoMsg.K[0] = static_cast<double>(zedParam.left_cam.fx);
+  leftCamInfoMsg.K[2] = static_cast<double>(zedParam.left_cam.cx);
+  leftCamInfoMsg.K[4] = static_cast<double>(zedParam.left_cam.fy);
+  leftCamInfoMsg.K[5] = static_cast<double>(zedParam.left_cam.cy);
+  leftCamInfoMsg.K[8] = 1.0;
+  rightCamInfoMsg.K[0] = static_cast<double>(zedParam.right_cam.fx);
+  rightCamInfoMsg.K[2] = static_cast<double>(zedParam.right_cam.cx);
+  rightCamInfoMsg.K[4] = static_cast<double>(zedParam.right_cam.fy);
+  rightCamInfoMsg.K[5] = static_cast<double>(zedParam.right_cam.cy);
+  rightCamInfoMsg.K[8] = 1.0;
+  leftCamInfoMsg.R.fill(0.0);
+  rightCamInfoMsg.R.fill(0.0);
 
   for (size_t i = 0; i < 3; i++)
   {
     // identity
-    rightCamInfoMsg->R[i + i * 3] = 1;
-    leftCamInfoMsg->R[i + i * 3] = 1;
+    rightCamInfoMsg.R[i + i * 3] = 1;
+    leftCamInfoMsg.R[i + i * 3] = 1;
   }
 
   if (rawParam)
   {
     for (int i = 0; i < 9; i++)
     {
-      rightCamInfoMsg->R[i] = zedParam.stereo_transform.getRotationMatrix().r[i];
+      rightCamInfoMsg.R[i] = zedParam.stereo_transform.getRotationMatrix().r[i];
     }
   }
 
-  leftCamInfoMsg->P.fill(0.0);
-  rightCamInfoMsg->P.fill(0.0);
-  leftCamInfoMsg->P[0] = static_cast<double>(zedParam.left_cam.fx);
-  leftCamInfoMsg->P[2] = static_cast<double>(zedParam.left_cam.cx);
-  leftCamInfoMsg->P[5] = static_cast<double>(zedParam.left_cam.fy);
-  leftCamInfoMsg->P[6] = static_cast<double>(zedParam.left_cam.cy);
-  leftCamInfoMsg->P[10] = 1.0;
+  leftCamInfoMsg.P.fill(0.0);
+  rightCamInfoMsg.P.fill(0.0);
+  leftCamInfoMsg.P[0] = static_cast<double>(zedParam.left_cam.fx);
+  leftCamInfoMsg.P[2] = static_cast<double>(zedParam.left_cam.cx);
+  leftCamInfoMsg.P[5] = static_cast<double>(zedParam.left_cam.fy);
+  leftCamInfoMsg.P[6] = static_cast<double>(zedParam.left_cam.cy);
+  leftCamInfoMsg.P[10] = 1.0;
   // http://docs.ros.org/api/sensor_msgs/html/msg/CameraInfo.html
-  rightCamInfoMsg->P[3] = static_cast<double>(-1 * zedParam.left_cam.fx * baseline);
-  rightCamInfoMsg->P[0] = static_cast<double>(zedParam.right_cam.fx);
-  rightCamInfoMsg->P[2] = static_cast<double>(zedParam.right_cam.cx);
-  rightCamInfoMsg->P[5] = static_cast<double>(zedParam.right_cam.fy);
-  rightCamInfoMsg->P[6] = static_cast<double>(zedParam.right_cam.cy);
-  rightCamInfoMsg->P[10] = 1.0;
-  leftCamInfoMsg->width = rightCamInfoMsg->width = static_cast<uint32_t>(mMatResol.width);
-  leftCamInfoMsg->height = rightCamInfoMsg->height = static_cast<uint32_t>(mMatResol.height);
-  leftCamInfoMsg->header.frame_id = leftFrameId;
-  rightCamInfoMsg->header.frame_id = rightFrameId;
+  rightCamInfoMsg.P[3] = static_cast<double>(-1 * zedParam.left_cam.fx * baseline);
+  rightCamInfoMsg.P[0] = static_cast<double>(zedParam.right_cam.fx);
+  rightCamInfoMsg.P[2] = static_cast<double>(zedParam.right_cam.cx);
+  rightCamInfoMsg.P[5] = static_cast<double>(zedParam.right_cam.fy);
+  rightCamInfoMsg.P[6] = static_cast<double>(zedParam.right_cam.cy);
+  rightCamInfoMsg.P[10] = 1.0;
+  leftCamInfoMsg.width = rightCamInfoMsg.width = static_cast<uint32_t>(mMatResol.width);
+  leftCamInfoMsg.height = rightCamInfoMsg.height = static_cast<uint32_t>(mMatResol.height);
+  leftCamInfoMsg.header.frame_id = leftFrameId;
+  rightCamInfoMsg.header.frame_id = rightFrameId;
 }
 
-void ZEDWrapperNodelet::fillCamDepthInfo(sl::Camera& zed, sensor_msgs::CameraInfoPtr depth_info_msg,
-                                         std::string frame_id)
+void ZEDWrapperNodelet::fillCamDepthInfo(sl::CalibrationParameters zedParam,
+                                         sensor_msgs::CameraInfo& depth_info_msg, std::string frame_id)
 {
-  sl::CalibrationParameters zedParam;
-
-  zedParam = zed.getCameraInformation(mMatResol).camera_configuration.calibration_parameters;
-
-  depth_info_msg->distortion_model = sensor_msgs::distortion_models::PLUMB_BOB;
-  depth_info_msg->D.resize(5);
-  depth_info_msg->D[0] = zedParam.left_cam.disto[0];  // k1
-  depth_info_msg->D[1] = zedParam.left_cam.disto[1];  // k2
-  depth_info_msg->D[2] = zedParam.left_cam.disto[4];  // k3
-  depth_info_msg->D[3] = zedParam.left_cam.disto[2];  // p1
-  depth_info_msg->D[4] = zedParam.left_cam.disto[3];  // p2
-  depth_info_msg->K.fill(0.0);
-  depth_info_msg->K[0] = static_cast<double>(zedParam.left_cam.fx);
-  depth_info_msg->K[2] = static_cast<double>(zedParam.left_cam.cx);
-  depth_info_msg->K[4] = static_cast<double>(zedParam.left_cam.fy);
-  depth_info_msg->K[5] = static_cast<double>(zedParam.left_cam.cy);
-  depth_info_msg->K[8] = 1.0;
-  depth_info_msg->R.fill(0.0);
+  depth_info_msg.distortion_model = sensor_msgs::distortion_models::PLUMB_BOB;
+  depth_info_msg.D.resize(5);
+  depth_info_msg.D[0] = zedParam.left_cam.disto[0];  // k1
+  depth_info_msg.D[1] = zedParam.left_cam.disto[1];  // k2
+  depth_info_msg.D[2] = zedParam.left_cam.disto[4];  // k3
+  depth_info_msg.D[3] = zedParam.left_cam.disto[2];  // p1
+  depth_info_msg.D[4] = zedParam.left_cam.disto[3];  // p2
+  depth_info_msg.K.fill(0.0);
+  depth_info_msg.K[0] = static_cast<double>(zedParam.left_cam.fx);
+  depth_info_msg.K[2] = static_cast<double>(zedParam.left_cam.cx);
+  depth_info_msg.K[4] = static_cast<double>(zedParam.left_cam.fy);
+  depth_info_msg.K[5] = static_cast<double>(zedParam.left_cam.cy);
+  depth_info_msg.K[8] = 1.0;
+  depth_info_msg.R.fill(0.0);
 
   for (size_t i = 0; i < 3; i++)
   {
     // identity
-    depth_info_msg->R[i + i * 3] = 1;
+    depth_info_msg.R[i + i * 3] = 1;
   }
 
-  depth_info_msg->P.fill(0.0);
-  depth_info_msg->P[0] = static_cast<double>(zedParam.left_cam.fx);
-  depth_info_msg->P[2] = static_cast<double>(zedParam.left_cam.cx);
-  depth_info_msg->P[5] = static_cast<double>(zedParam.left_cam.fy);
-  depth_info_msg->P[6] = static_cast<double>(zedParam.left_cam.cy);
-  depth_info_msg->P[10] = 1.0;
+  depth_info_msg.P.fill(0.0);
+  depth_info_msg.P[0] = static_cast<double>(zedParam.left_cam.fx);
+  depth_info_msg.P[2] = static_cast<double>(zedParam.left_cam.cx);
+  depth_info_msg.P[5] = static_cast<double>(zedParam.left_cam.fy);
+  depth_info_msg.P[6] = static_cast<double>(zedParam.left_cam.cy);
+  depth_info_msg.P[10] = 1.0;
   // http://docs.ros.org/api/sensor_msgs/html/msg/CameraInfo.html
-  depth_info_msg->width = static_cast<uint32_t>(mMatResol.width);
-  depth_info_msg->height = static_cast<uint32_t>(mMatResol.height);
-  depth_info_msg->header.frame_id = frame_id;
+  depth_info_msg.width = static_cast<uint32_t>(mMatResol.width);
+  depth_info_msg.height = static_cast<uint32_t>(mMatResol.height);
+  depth_info_msg.header.frame_id = frame_id;
+}
+
+void ZEDWrapperNodelet::updateCalibSnapshot()
+{
+  sl::CameraConfiguration camConf = mZed.getCameraInformation(mMatResol).camera_configuration;
+  sl::InitParameters initParams = mZed.getInitParameters();
+
+  std::shared_ptr<CalibSnapshot> calib = std::make_shared<CalibSnapshot>();
+
+  calib->resol = mMatResol;
+  calib->fx = camConf.calibration_parameters.left_cam.fx;
+  calib->fy = camConf.calibration_parameters.left_cam.fy;
+  calib->cx = camConf.calibration_parameters.left_cam.cx;
+  calib->cy = camConf.calibration_parameters.left_cam.cy;
+  calib->baseline = camConf.calibration_parameters.getCameraBaseline();
+
+  // DisparityImage uses a negative baseline for the left camera as reference
+  float T = calib->baseline > 0 ? -calib->baseline : calib->baseline;
+  calib->minDisparity = calib->fx * T / initParams.depth_minimum_distance;
+  calib->maxDisparity = calib->fx * T / initParams.depth_maximum_distance;
+
+  fillCamInfo(camConf.calibration_parameters, calib->leftCamInfo, calib->rightCamInfo, mLeftCamOptFrameId,
+              mRightCamOptFrameId);
+  fillCamInfo(camConf.calibration_parameters_raw, calib->leftCamInfoRaw, calib->rightCamInfoRaw, mLeftCamOptFrameId,
+              mRightCamOptFrameId, true);
+  fillCamDepthInfo(camConf.calibration_parameters, calib->depthCamInfo, mLeftCamOptFrameId);
+
+  std::atomic_store(&mCalibSnapshot, CalibSnapshotPtr(calib));
+
+  // New messages: the previous ones can still be referenced by intra-process subscribers
+  mLeftCamInfoMsg = boost::make_shared<sensor_msgs::CameraInfo>(calib->leftCamInfo);
+  mRightCamInfoMsg = boost::make_shared<sensor_msgs::CameraInfo>(calib->rightCamInfo);
+  mLeftCamInfoRawMsg = boost::make_shared<sensor_msgs::CameraInfo>(calib->leftCamInfoRaw);
+  mRightCamInfoRawMsg = boost::make_shared<sensor_msgs::CameraInfo>(calib->rightCamInfoRaw);
+  mDepthCamInfoMsg = boost::make_shared<sensor_msgs::CameraInfo>(calib->depthCamInfo);
+
+  // the reference camera is the Left one (next to the ZED logo)
+  mRgbCamInfoMsg = mLeftCamInfoMsg;
+  mRgbCamInfoRawMsg = mLeftCamInfoRawMsg;
 }
 
 void ZEDWrapperNodelet::updateDynamicReconfigure()
@@ -2834,8 +3688,6 @@ void ZEDWrapperNodelet::updateDynamicReconfigure()
   mDynRecServer->updateConfig(config);
   mDynServerMutex.unlock();
 
-  mUpdateDynParams = false;
-
   // NODELET_DEBUG_STREAM( "updateDynamicReconfigure MUTEX UNLOCK");
 }
 
@@ -2883,6 +3735,7 @@ void ZEDWrapperNodelet::callback_dynamicReconf(zed_nodelets::ZedConfig& config,
     case BRIGHTNESS:
       mCamBrightness = config.brightness;
       NODELET_INFO("Reconfigure image brightness: %d", mCamBrightness);
+      setCamSettingDirty(sl::VIDEO_SETTINGS::BRIGHTNESS);
       mDynParMutex.unlock();
       // NODELET_DEBUG_STREAM( "dynamicReconfCallback MUTEX UNLOCK");
       break;
@@ -2890,6 +3743,7 @@ void ZEDWrapperNodelet::callback_dynamicReconf(zed_nodelets::ZedConfig& config,
     case CONTRAST:
       mCamContrast = config.contrast;
       NODELET_INFO("Reconfigure image contrast: %d", mCamContrast);
+      setCamSettingDirty(sl::VIDEO_SETTINGS::CONTRAST);
       mDynParMutex.unlock();
       // NODELET_DEBUG_STREAM( "dynamicReconfCallback MUTEX UNLOCK");
       break;
@@ -2897,6 +3751,7 @@ void ZEDWrapperNodelet::callback_dynamicReconf(zed_nodelets::ZedConfig& config,
     case HUE:
       mCamHue = config.hue;
       NODELET_INFO("Reconfigure image hue: %d", mCamHue);
+      setCamSettingDirty(sl::VIDEO_SETTINGS::HUE);
       mDynParMutex.unlock();
       // NODELET_DEBUG_STREAM( "dynamicReconfCallback MUTEX UNLOCK");
       break;
@@ -2904,6 +3759,7 @@ void ZEDWrapperNodelet::callback_dynamicReconf(zed_nodelets::ZedConfig& config,
     case SATURATION:
       mCamSaturation = config.saturation;
       NODELET_INFO("Reconfigure image saturation: %d", mCamSaturation);
+      setCamSettingDirty(sl::VIDEO_SETTINGS::SATURATION);
       mDynParMutex.unlock();
       // NODELET_DEBUG_STREAM( "dynamicReconfCallback MUTEX UNLOCK");
       break;
@@ -2911,6 +3767,7 @@ void ZEDWrapperNodelet::callback_dynamicReconf(zed_nodelets::ZedConfig& config,
     case SHARPNESS:
       mCamSharpness = config.sharpness;
       NODELET_INFO("Reconfigure image sharpness: %d", mCamSharpness);
+      setCamSettingDirty(sl::VIDEO_SETTINGS::SHARPNESS);
       mDynParMutex.unlock();
       // NODELET_DEBUG_STREAM( "dynamicReconfCallback MUTEX UNLOCK");
       break;
@@ -2918,6 +3775,7 @@ void ZEDWrapperNodelet::callback_dynamicReconf(zed_nodelets::ZedConfig& config,
     case GAMMA:
       mCamGamma = config.gamma;
       NODELET_INFO("Reconfigure image gamma: %d", mCamGamma);
+      setCamSettingDirty(sl::VIDEO_SETTINGS::GAMMA);
       mDynParMutex.unlock();
       // NODELET_DEBUG_STREAM( "dynamicReconfCallback MUTEX UNLOCK");
       break;
@@ -2927,6 +3785,13 @@ void ZEDWrapperNodelet::callback_dynamicReconf(zed_nodelets::ZedConfig& config,
       {
         mCamAutoExposure = config.auto_exposure_gain;
         NODELET_INFO_STREAM("Reconfigure auto exposure/gain: " << (mCamAutoExposure ? "ENABLED" : "DISABLED"));
+        setCamSettingDirty(sl::VIDEO_SETTINGS::AEC_AGC);
+        if (!mCamAutoExposure)
+        {
+          // Apply the manual values, the last ones read from the camera if not changed by the user
+          setCamSettingDirty(sl::VIDEO_SETTINGS::EXPOSURE);
+          setCamSettingDirty(sl::VIDEO_SETTINGS::GAIN);
+        }
       }
       mDynParMutex.unlock();
       // NODELET_DEBUG_STREAM( "dynamicReconfCallback MUTEX UNLOCK");
@@ -2941,6 +3806,7 @@ void ZEDWrapperNodelet::callback_dynamicReconf(zed_nodelets::ZedConfig& config,
       else
       {
         NODELET_INFO("Reconfigure gain: %d", mCamGain);
+        setCamSettingDirty(sl::VIDEO_SETTINGS::GAIN);
       }
       mDynParMutex.unlock();
       // NODELET_DEBUG_STREAM( "dynamicReconfCallback MUTEX UNLOCK");
@@ -2955,6 +3821,7 @@ void ZEDWrapperNodelet::callback_dynamicReconf(zed_nodelets::ZedConfig& config,
       else
       {
         NODELET_INFO("Reconfigure exposure: %d", mCamExposure);
+        setCamSettingDirty(sl::VIDEO_SETTINGS::EXPOSURE);
       }
       mDynParMutex.unlock();
       // NODELET_DEBUG_STREAM( "dynamicReconfCallback MUTEX UNLOCK");
@@ -2965,11 +3832,11 @@ void ZEDWrapperNodelet::callback_dynamicReconf(zed_nodelets::ZedConfig& config,
       {
         mCamAutoWB = config.auto_whitebalance;
         NODELET_INFO_STREAM("Reconfigure auto white balance: " << (mCamAutoWB ? "ENABLED" : "DISABLED"));
-        mTriggerAutoWB = true;
-      }
-      else
-      {
-        mTriggerAutoWB = false;
+        setCamSettingDirty(sl::VIDEO_SETTINGS::WHITEBALANCE_AUTO);
+        if (!mCamAutoWB)
+        {
+          setCamSettingDirty(sl::VIDEO_SETTINGS::WHITEBALANCE_TEMPERATURE);
+        }
       }
       mDynParMutex.unlock();
       // NODELET_DEBUG_STREAM( "dynamicReconfCallback MUTEX UNLOCK");
@@ -2984,6 +3851,7 @@ void ZEDWrapperNodelet::callback_dynamicReconf(zed_nodelets::ZedConfig& config,
       else
       {
         NODELET_INFO("Reconfigure white balance temperature: %d", mCamWB);
+        setCamSettingDirty(sl::VIDEO_SETTINGS::WHITEBALANCE_TEMPERATURE);
       }
       mDynParMutex.unlock();
       // NODELET_DEBUG_STREAM( "dynamicReconfCallback MUTEX UNLOCK");
@@ -2994,12 +3862,12 @@ void ZEDWrapperNodelet::callback_dynamicReconf(zed_nodelets::ZedConfig& config,
       mDynParMutex.unlock();
       // NODELET_DEBUG_STREAM( "dynamicReconfCallback MUTEX UNLOCK");
   }
+
+  mCamSettingsCondVar.notify_one();
 }
 
 void ZEDWrapperNodelet::pubVideoDepth()
 {
-  static sl::Timestamp lastZedTs = 0;  // Used to calculate stable publish frequency
-
   uint32_t rgbSubnumber = mPubRgb.getNumSubscribers();
   uint32_t rgbRawSubnumber = mPubRawRgb.getNumSubscribers();
   uint32_t leftSubnumber = mPubLeft.getNumSubscribers();
@@ -3015,19 +3883,40 @@ void ZEDWrapperNodelet::pubVideoDepth()
   uint32_t stereoSubNumber = mPubStereo.getNumSubscribers();
   uint32_t stereoRawSubNumber = mPubRawStereo.getNumSubscribers();
   uint32_t depthSubnumber = 0;
+  uint32_t depthRvlSubnumber = 0;
+  uint32_t depthFiltSubnumber = 0;
   uint32_t disparitySubnumber = 0;
   uint32_t confMapSubnumber = 0;
   if (!mDepthDisabled)
   {
     depthSubnumber = mPubDepth.getNumSubscribers();
+    depthRvlSubnumber = mPubDepthRvl.getNumSubscribers();
+    depthFiltSubnumber = mPubDepthFiltered.getNumSubscribers();
     disparitySubnumber = mPubDisparity.getNumSubscribers();
     confMapSubnumber = mPubConfMap.getNumSubscribers();
   }
 
+  // ----> Load governor
+  if (isGovShed(GOV_STEREO))
+  {
+    stereoSubNumber = 0;
+    stereoRawSubNumber = 0;
+  }
+  if (govSkipFrame(GOV_DEPTH))
+  {
+    depthSubnumber = 0;
+    depthRvlSubnumber = 0;
+    depthFiltSubnumber = 0;
+    disparitySubnumber = 0;
+    confMapSubnumber = 0;
+  }
+  // <---- Load governor
+
   uint32_t tot_sub = rgbSubnumber + rgbRawSubnumber + leftSubnumber + leftRawSubnumber + rightSubnumber +
                      rightRawSubnumber + rgbGraySubnumber + rgbGrayRawSubnumber + leftGraySubnumber +
                      leftGrayRawSubnumber + rightGraySubnumber + rightGrayRawSubnumber + depthSubnumber +
-                     disparitySubnumber + confMapSubnumber + stereoSubNumber + stereoRawSubNumber;
+                     depthRvlSubnumber + depthFiltSubnumber + disparitySubnumber + confMapSubnumber + stereoSubNumber +
+                     stereoRawSubNumber;
 
 
   // NODELET_DEBUG_STREAM("tot_sub = " << tot_sub << " - rgb: " << rgbSubnumber << " - rgb_raw: " << rgbRawSubnumber
@@ -3045,13 +3934,15 @@ void ZEDWrapperNodelet::pubVideoDepth()
   sl::Mat mat_right, mat_right_raw;
   sl::Mat mat_left_gray, mat_left_raw_gray;
   sl::Mat mat_right_gray, mat_right_raw_gray;
-  sl::Mat mat_depth, mat_disp, mat_conf;
+  sl::Mat mat_depth, mat_depth_mm, mat_disp, mat_conf;
 
   sl::Timestamp ts_rgb = 0;      // used to check RGB/Depth sync
   sl::Timestamp ts_depth;    // used to check RGB/Depth sync
   sl::Timestamp grab_ts = 0;
 
   // ----> Retrieve all required image data
+  mFrameDepth = sl::Mat();  // Releases the depth of the previous frame
+
   if (rgbSubnumber + leftSubnumber + stereoSubNumber > 0)
   {
     mZed.retrieveImage(mat_left, sl::VIEW::LEFT, sl::MEM::CPU, mMatResol);
@@ -3101,15 +3992,15 @@ void ZEDWrapperNodelet::pubVideoDepth()
     retrieved = true;
     grab_ts = mat_right_raw_gray.timestamp;
   }
-  if (depthSubnumber > 0)
+  if (depthSubnumber > 0 || depthRvlSubnumber > 0 || depthFiltSubnumber > 0)
   {
-    if (!mOpenniDepthMode)
+    // Single float retrieval, the 16 bit millimeter depth is converted on CPU when required
+    mZed.retrieveMeasure(mat_depth, sl::MEASURE::DEPTH, sl::MEM::CPU, mMatResol);
+    mFrameDepth = mat_depth;  // shallow copy, reused by the object detection
+    if ((depthSubnumber > 0 && mOpenniDepthMode) || depthRvlSubnumber > 0)
     {
-      mZed.retrieveMeasure(mat_depth, sl::MEASURE::DEPTH, sl::MEM::CPU, mMatResol);
-    }
-    else
-    {
-      mZed.retrieveMeasure(mat_depth, sl::MEASURE::DEPTH_U16_MM, sl::MEM::CPU, mMatResol);
+      sl_tools::depthToU16mm(mat_depth, mMatDepthMm);
+      mat_depth_mm = mMatDepthMm;  // shallow copy
     }
     retrieved = true;
     grab_ts = mat_depth.timestamp;
@@ -3128,7 +4019,7 @@ void ZEDWrapperNodelet::pubVideoDepth()
     retrieved = true;
     grab_ts = mat_disp.timestamp;
   }
-  if (confMapSubnumber > 0)
+  if (confMapSubnumber > 0 || depthFiltSubnumber > 0)
   {
     mZed.retrieveMeasure(mat_conf, sl::MEASURE::CONFIDENCE, sl::MEM::CPU, mMatResol);
     retrieved = true;
@@ -3150,8 +4041,8 @@ void ZEDWrapperNodelet::pubVideoDepth()
     if (mSensTimestampSync)
     {
       // NODELET_INFO_STREAM("tot_sub: " << tot_sub << " - retrieved: " << retrieved << " -
-      // grab_ts.data_ns!=lastZedTs.data_ns: " << (grab_ts.data_ns!=lastZedTs.data_ns));
-      if (tot_sub > 0 && retrieved && (grab_ts.data_ns != lastZedTs.data_ns))
+      // new grab: " << mVideoDepthStamp.isNew(grab_ts.data_ns));
+      if (tot_sub > 0 && retrieved && mVideoDepthStamp.isNew(grab_ts.data_ns))
       {
         // NODELET_INFO("CALLBACK");
         publishSensData(stamp);
@@ -3167,27 +4058,26 @@ void ZEDWrapperNodelet::pubVideoDepth()
   if (!retrieved)
   {
     mPublishingData = false;
-    lastZedTs = 0;
+    mVideoDepthStamp.reset();
     return;
   }
   mPublishingData = true;
 
   // ----> Check if a grab has been done before publishing the same images
-  if (grab_ts.data_ns == lastZedTs.data_ns)
+  double period_sec;
+  if (!mVideoDepthStamp.update(grab_ts.data_ns, period_sec))
   {
     // Data not updated by a grab calling in the grab thread
     return;
   }
-  if (lastZedTs.data_ns != 0)
+  if (period_sec > 0.0)
   {
-    double period_sec = static_cast<double>(grab_ts.data_ns - lastZedTs.data_ns) / 1e9;
     // NODELET_DEBUG_STREAM( "PUBLISHING PERIOD: " << period_sec << " sec @" << 1./period_sec << " Hz") ;
 
     mVideoDepthPeriodMean_sec->addValue(period_sec);
     // NODELET_DEBUG_STREAM( "MEAN PUBLISHING PERIOD: " << mVideoDepthPeriodMean_sec->getMean() << " sec @"
     // << 1./mVideoDepthPeriodMean_sec->getMean() << " Hz") ;
   }
-  lastZedTs = grab_ts;
   // <---- Check if a grab has been done before publishing the same images
 
   // Publish the left = rgb image if someone has subscribed to
@@ -3288,7 +4178,19 @@ void ZEDWrapperNodelet::pubVideoDepth()
   if (depthSubnumber > 0)
   {
     sensor_msgs::ImagePtr depthImgMsg = boost::make_shared<sensor_msgs::Image>();
-    publishDepth(depthImgMsg, mat_depth, stamp);
+    publishDepth(depthImgMsg, mOpenniDepthMode ? mat_depth_mm : mat_depth, stamp);
+  }
+
+  // Publish the compressed depth image if someone has subscribed to
+  if (depthRvlSubnumber > 0)
+  {
+    publishDepthCompressed(mat_depth_mm, stamp);
+  }
+
+  // Publish the filtered depth image if someone has subscribed to
+  if (depthFiltSubnumber > 0)
+  {
+    publishDepthFiltered(mat_depth, mat_conf, stamp);
   }
 
   // Publish the disparity image if someone has subscribed to
@@ -3311,131 +4213,295 @@ void ZEDWrapperNodelet::callback_pubPath(const ros::TimerEvent& e)
   uint32_t mapPathSub = mPubMapPath.getNumSubscribers();
   uint32_t odomPathSub = mPubOdomPath.getNumSubscribers();
 
+  // Consistent odom/map poses without blocking the grab thread
+  PoseSnapshotPtr poseSnap = getPoseSnapshot();
+  const ros::Time stamp = poseSnap->stamp;
+
   geometry_msgs::PoseStamped odomPose;
   geometry_msgs::PoseStamped mapPose;
 
-  odomPose.header.stamp = mFrameTimestamp;
+  odomPose.header.stamp = stamp;
   odomPose.header.frame_id = mMapFrameId;  // map_frame
-  mOdomMutex.lock();                       //
-  odomPose.pose.position.x = mOdom2BaseTransf.getOrigin().x();
-  odomPose.pose.position.y = mOdom2BaseTransf.getOrigin().y();
-  odomPose.pose.position.z = mOdom2BaseTransf.getOrigin().z();
-  odomPose.pose.orientation.x = mOdom2BaseTransf.getRotation().x();
-  odomPose.pose.orientation.y = mOdom2BaseTransf.getRotation().y();
-  odomPose.pose.orientation.z = mOdom2BaseTransf.getRotation().z();
-  odomPose.pose.orientation.w = mOdom2BaseTransf.getRotation().w();
-  mOdomMutex.unlock();  //
-
-  mapPose.header.stamp = mFrameTimestamp;
+  tf2::toMsg(poseSnap->odom2base, odomPose.pose);
+
+  mapPose.header.stamp = stamp;
   mapPose.header.frame_id = mMapFrameId;  // map_frame
-  mapPose.pose.position.x = mMap2BaseTransf.getOrigin().x();
-  mapPose.pose.position.y = mMap2BaseTransf.getOrigin().y();
-  mapPose.pose.position.z = mMap2BaseTransf.getOrigin().z();
-  mapPose.pose.orientation.x = mMap2BaseTransf.getRotation().x();
-  mapPose.pose.orientation.y = mMap2BaseTransf.getRotation().y();
-  mapPose.pose.orientation.z = mMap2BaseTransf.getRotation().z();
-  mapPose.pose.orientation.w = mMap2BaseTransf.getRotation().w();
+  tf2::toMsg(poseSnap->map2base, mapPose.pose);
+
+  std::lock_guard<std::mutex> lock(mPathMutex);
 
-  // Circular vector
-  std::lock_guard<std::mutex> lock(mOdomMutex);  //
-  if (mPathMaxCount != -1)
+  // ----> Decimation
+  if (!mMapPath.empty() && !mOdomPath.empty() && (mPathMinDist > 0.0 || mPathMinAngle > 0.0))
   {
-    if (mOdomPath.size() == mPathMaxCount)
-    {
-      NODELET_DEBUG("Path vectors full: rotating ");
-      std::rotate(mOdomPath.begin(), mOdomPath.begin() + 1, mOdomPath.end());
-      std::rotate(mMapPath.begin(), mMapPath.begin() + 1, mMapPath.end());
+    tf2::Transform lastMap, lastOdom, currMap, currOdom;
+    tf2::fromMsg(mMapPath.back().pose, lastMap);
+    tf2::fromMsg(mOdomPath.back().pose, lastOdom);
+    tf2::fromMsg(mapPose.pose, currMap);
+    tf2::fromMsg(odomPose.pose, currOdom);
 
-      mMapPath[mPathMaxCount - 1] = mapPose;
-      mOdomPath[mPathMaxCount - 1] = odomPose;
-    }
-    else
+    tf2::Transform deltaMap = lastMap.inverseTimes(currMap);
+    tf2::Transform deltaOdom = lastOdom.inverseTimes(currOdom);
+
+    double dist = std::max(deltaMap.getOrigin().length(), deltaOdom.getOrigin().length());
+    double angle = std::max(deltaMap.getRotation().getAngleShortestPath(),
+                            deltaOdom.getRotation().getAngleShortestPath());
+
+    // A disabled threshold ('0') does not prevent the other one from decimating
+    if ((mPathMinDist <= 0.0 || dist < mPathMinDist) && (mPathMinAngle <= 0.0 || angle < mPathMinAngle))
     {
-      // NODELET_DEBUG( "Path vectors adding last available poses");
-      mMapPath.push_back(mapPose);
-      mOdomPath.push_back(odomPose);
+      return;
     }
   }
-  else
-  {
-    // NODELET_DEBUG( "No limit path vectors, adding last available poses");
-    mMapPath.push_back(mapPose);
-    mOdomPath.push_back(odomPose);
-  }
+  // <---- Decimation
+
+  // Ring buffers, the oldest poses are overwritten when full
+  mMapPath.push(mapPose);
+  mOdomPath.push(odomPose);
 
   if (mapPathSub > 0)
   {
-    nav_msgs::PathPtr mapPathMsg = boost::make_shared<nav_msgs::Path>();
-    mapPathMsg->header.frame_id = mMapFrameId;
-    mapPathMsg->header.stamp = mFrameTimestamp;
-    mapPathMsg->poses = mMapPath;
+    if (!mMapPathMsg || !mMapPathMsg.unique())
+    {
+      mMapPathMsg = boost::make_shared<nav_msgs::Path>();
+    }
+    mMapPathMsg->header.frame_id = mMapFrameId;
+    mMapPathMsg->header.stamp = stamp;
+    mMapPath.copyTo(mMapPathMsg->poses);
 
     NODELET_DEBUG("Publishing MAP PATH message");
-    mPubMapPath.publish(mapPathMsg);
+    mPubMapPath.publish(mMapPathMsg);
   }
 
   if (odomPathSub > 0)
   {
-    nav_msgs::PathPtr odomPathMsg = boost::make_shared<nav_msgs::Path>();
-    odomPathMsg->header.frame_id = mOdomFrameId;
-    odomPathMsg->header.stamp = mFrameTimestamp;
-    odomPathMsg->poses = mOdomPath;
+    if (!mOdomPathMsg || !mOdomPathMsg.unique())
+    {
+      mOdomPathMsg = boost::make_shared<nav_msgs::Path>();
+    }
+    mOdomPathMsg->header.frame_id = mOdomFrameId;
+    mOdomPathMsg->header.stamp = stamp;
+    mOdomPath.copyTo(mOdomPathMsg->poses);
 
     NODELET_DEBUG("Publishing ODOM PATH message");
-    mPubOdomPath.publish(odomPathMsg);
+    mPubOdomPath.publish(mOdomPathMsg);
+  }
+
+  // ----> Incremental paths: O(1) per new pose
+  if (mPubMapPathAppend.getNumSubscribers() > 0)
+  {
+    nav_msgs::PathPtr mapAppendMsg = boost::make_shared<nav_msgs::Path>();
+    mapAppendMsg->header.frame_id = mMapFrameId;
+    mapAppendMsg->header.stamp = stamp;
+    mapAppendMsg->poses.push_back(mapPose);
+    mPubMapPathAppend.publish(mapAppendMsg);
+  }
+
+  if (mPubOdomPathAppend.getNumSubscribers() > 0)
+  {
+    nav_msgs::PathPtr odomAppendMsg = boost::make_shared<nav_msgs::Path>();
+    odomAppendMsg->header.frame_id = mOdomFrameId;
+    odomAppendMsg->header.stamp = stamp;
+    odomAppendMsg->poses.push_back(odomPose);
+    mPubOdomPathAppend.publish(odomAppendMsg);
   }
+  // <---- Incremental paths
 }
 
 void ZEDWrapperNodelet::sensors_thread_func()
 {
-  ros::Rate loop_rate(mSensPubRate);
-
-  std::chrono::steady_clock::time_point prev_usec = std::chrono::steady_clock::now();
+  applyThreadSched("Sensors", mSensThreadSched);
+
+  // ----> Clock helpers
+  auto clockNsec = [](clockid_t clk) -> int64_t {
+    timespec ts;
+    clock_gettime(clk, &ts);
+    return static_cast<int64_t>(ts.tv_sec) * 1000000000LL + ts.tv_nsec;
+  };
+
+  auto sleepUntil = [this](int64_t wakeup_nsec) {
+    timespec ts;
+    ts.tv_sec = wakeup_nsec / 1000000000LL;
+    ts.tv_nsec = wakeup_nsec % 1000000000LL;
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, nullptr) == EINTR && !mStopNode)
+    {
+    }
+  };
+  // <---- Clock helpers
+
+  // The sensors data are polled until the IMU period has been estimated from the hardware timestamps,
+  // then the wake ups are phase-locked just after the expected arrival of the next sample.
+  // Timestamps are not real time when playing SVO or when synchronized with the frames: in this case
+  // the data are sampled at a fixed rate
+  const bool phase_lock = !mSvoMode && !mSensTimestampSync;
+  const int64_t pub_period_nsec = static_cast<int64_t>(1e9 / mSensPubRate);
+  const int64_t bootstrap_period_nsec = 1000000;  // 1 kHz polling to estimate the IMU period
+  const int bootstrap_samples = 20;
+
+  sl_tools::CSmartMean imuPeriodMean(50);
+  int64_t imu_period_nsec = 0;
+  int64_t bootstrap_min_nsec = std::numeric_limits<int64_t>::max();
+  int bootstrap_count = 0;
+  sl::Timestamp last_imu_ts = 0;
 
   int count_warn = 0;
+  int64_t next_wakeup_nsec = clockNsec(CLOCK_MONOTONIC);
 
   while (!mStopNode)
   {
-    std::chrono::steady_clock::time_point start_elab = std::chrono::steady_clock::now();
+    sleepUntil(next_wakeup_nsec);
 
-    mCloseZedMutex.lock();
+    mCloseZedMutex.lock_shared();
     if (!mZed.isOpened())
     {
-      mCloseZedMutex.unlock();
-      loop_rate.sleep();
+      mCloseZedMutex.unlock_shared();
+      next_wakeup_nsec = clockNsec(CLOCK_MONOTONIC) + pub_period_nsec;
       continue;
     }
 
     publishSensData();
-    mCloseZedMutex.unlock();
+    sl::Timestamp imu_ts = mLastSensImuTs;
+    mCloseZedMutex.unlock_shared();
+
+    mSensLoopCount++;
+
+    int64_t now_nsec = clockNsec(CLOCK_MONOTONIC);
+
+    if (!phase_lock)
+    {
+      // ----> Fixed rate sampling
+      next_wakeup_nsec += pub_period_nsec;
+      if (next_wakeup_nsec < now_nsec)
+      {
+        mSensDeadlineMiss++;
+        next_wakeup_nsec = now_nsec;
+      }
+      continue;
+      // <---- Fixed rate sampling
+    }
+
+    // ----> Duplicated data
+    if (imu_ts.data_ns == last_imu_ts.data_ns)
+    {
+      if (imu_ts.data_ns == 0)
+      {
+        // No IMU data available (e.g. ZED camera)
+        next_wakeup_nsec = now_nsec + pub_period_nsec;
+      }
+      else if (imu_period_nsec > 0)
+      {
+        // The sample is late: retry shortly without moving the phase reference
+        mSensDuplicateReads++;
+        next_wakeup_nsec = now_nsec + std::max<int64_t>(imu_period_nsec / 8, 100000);
+      }
+      else
+      {
+        next_wakeup_nsec = now_nsec + bootstrap_period_nsec;
+      }
+      continue;
+    }
+    // <---- Duplicated data
+
+    // ----> IMU period estimation
+    int64_t delta_nsec = static_cast<int64_t>(imu_ts.data_ns) - static_cast<int64_t>(last_imu_ts.data_ns);
+    bool valid_delta = last_imu_ts.data_ns != 0 && delta_nsec > 0 && delta_nsec < 1000000000LL;
+    last_imu_ts = imu_ts;
+
+    if (imu_period_nsec == 0)
+    {
+      if (valid_delta)
+      {
+        bootstrap_min_nsec = std::min(bootstrap_min_nsec, delta_nsec);
+        if (++bootstrap_count >= bootstrap_samples)
+        {
+          imu_period_nsec = bootstrap_min_nsec;
+          imuPeriodMean.addValue(static_cast<double>(imu_period_nsec));
+          mImuPeriodEst_msec = imu_period_nsec / 1e6;
+          NODELET_DEBUG_STREAM("Estimated IMU period: " << mImuPeriodEst_msec << " msec");
+        }
+      }
+      next_wakeup_nsec = now_nsec + bootstrap_period_nsec;
+      continue;
+    }
+
+    // Decimation required to respect the maximum publishing rate
+    int64_t decimation = std::max<int64_t>(1, (pub_period_nsec + imu_period_nsec / 2) / imu_period_nsec);
+
+    if (valid_delta)
+    {
+      int64_t n_periods = std::max<int64_t>(1, (delta_nsec + imu_period_nsec / 2) / imu_period_nsec);
+      if (n_periods > decimation)
+      {
+        mSensMissedSamples += n_periods - decimation;
+      }
+
+      imu_period_nsec = static_cast<int64_t>(imuPeriodMean.addValue(static_cast<double>(delta_nsec) / n_periods));
+      mImuPeriodEst_msec = imu_period_nsec / 1e6;
+    }
+    // <---- IMU period estimation
+
+    // ----> Phase lock on the next expected sample
+    int64_t realtime_offset_nsec = clockNsec(CLOCK_REALTIME) - now_nsec;
+    int64_t sample_mono_nsec = static_cast<int64_t>(imu_ts.data_ns) - realtime_offset_nsec;
+    int64_t margin_nsec = imu_period_nsec / 10;
 
-    if (!loop_rate.sleep())
+    next_wakeup_nsec = sample_mono_nsec + decimation * imu_period_nsec + margin_nsec;
+
+    if (next_wakeup_nsec < now_nsec)
     {
+      mSensDeadlineMiss++;
+      next_wakeup_nsec = now_nsec;
+
       if (++count_warn > 10)
       {
         NODELET_INFO_THROTTLE(1.0, "Sensors thread is not synchronized with the Sensors rate");
-        NODELET_INFO_STREAM_THROTTLE(1.0, "Expected cycle time: " << loop_rate.expectedCycleTime()
-                                                                  << " - Real cycle time: " << loop_rate.cycleTime());
-        NODELET_WARN_STREAM_THROTTLE(10.0, "Sensors data publishing takes longer ("
-                                               << loop_rate.cycleTime() << " sec) than requested  by the Sensors rate ("
-                                               << loop_rate.expectedCycleTime()
+        NODELET_WARN_STREAM_THROTTLE(10.0, "Sensors data publishing takes longer than requested by the Sensors rate ("
+                                               << (decimation * imu_period_nsec) / 1e9
                                                << " sec). Please consider to "
                                                   "lower the 'max_pub_rate' setting or to "
                                                   "reduce the power requirements reducing "
                                                   "the resolutions.");
       }
-
-      loop_rate.reset();
     }
     else
     {
       count_warn = 0;
     }
+    // <---- Phase lock on the next expected sample
   }
 
   NODELET_DEBUG("Sensors thread finished");
 }
 
+void ZEDWrapperNodelet::sensors_task_func()
+{
+  if (mStopNode)
+  {
+    return;
+  }
+
+  mCloseZedMutex.lock_shared();
+  if (mZed.isOpened())
+  {
+    publishSensData();
+  }
+  mCloseZedMutex.unlock_shared();
+
+  // ----> Schedule the next execution
+  std::chrono::nanoseconds period(static_cast<int64_t>(1e9 / mSensPubRate));
+  std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+
+  mNextSensRelease += period;
+  if (mNextSensRelease < now)
+  {
+    // Late: do not try to recover the lost cycles
+    mNextSensRelease = now;
+  }
+
+  mExecutor->post(mExecutorClientId, sl_tools::TaskClass::SENSORS, mNextSensRelease, mNextSensRelease + period,
+                  std::bind(&ZEDWrapperNodelet::sensors_task_func, this));
+  // <---- Schedule the next execution
+}
+
 void ZEDWrapperNodelet::publishSensData(ros::Time t)
 {
   // NODELET_INFO("publishSensData");
@@ -3479,10 +4545,6 @@ void ZEDWrapperNodelet::publishSensData(ros::Time t)
   ros::Time ts_baro;
   ros::Time ts_mag;
 
-  static ros::Time lastTs_imu = ros::Time();
-  static ros::Time lastTs_baro = ros::Time();
-  static ros::Time lastT_mag = ros::Time();
-
   sl::SensorsData sens_data;
 
   if (mSvoMode || mSensTimestampSync)
@@ -3502,6 +4564,13 @@ void ZEDWrapperNodelet::publishSensData(ros::Time t)
     }
   }
 
+  mLastSensImuTs = sens_data.imu.timestamp;  // Used by the sensors thread to lock on the IMU rate
+
+  if (mImuOdomEnabled && sens_data.imu.is_available)
+  {
+    propagateImuOdom(sens_data.imu, t != ros::Time(0) ? t : sl_tools::slTime2Ros(sens_data.imu.timestamp));
+  }
+
   if (t != ros::Time(0))
   {
     ts_imu = t;
@@ -3515,9 +4584,9 @@ void ZEDWrapperNodelet::publishSensData(ros::Time t)
     ts_mag = sl_tools::slTime2Ros(sens_data.magnetometer.timestamp);
   }
 
-  bool new_imu_data = ts_imu != lastTs_imu;
-  bool new_baro_data = ts_baro != lastTs_baro;
-  bool new_mag_data = ts_mag != lastT_mag;
+  bool new_imu_data = mImuStamp.isNew(ts_imu.toNSec());
+  bool new_baro_data = mBaroStamp.isNew(ts_baro.toNSec());
+  bool new_mag_data = mMagStamp.isNew(ts_mag.toNSec());
 
   if (!new_imu_data && !new_baro_data && !new_mag_data)
   {
@@ -3540,7 +4609,7 @@ void ZEDWrapperNodelet::publishSensData(ros::Time t)
 
   if (imu_TempSubNumber > 0 && new_imu_data)
   {
-    lastTs_imu = ts_imu;
+    mImuStamp.update(ts_imu.toNSec());
 
     sensor_msgs::TemperaturePtr imuTempMsg = boost::make_shared<sensor_msgs::Temperature>();
 
@@ -3569,7 +4638,7 @@ void ZEDWrapperNodelet::publishSensData(ros::Time t)
 
   if (sens_data.barometer.is_available && new_baro_data)
   {
-    lastTs_baro = ts_baro;
+    mBaroStamp.update(ts_baro.toNSec());
 
     if (pressSubNumber > 0)
     {
@@ -3646,7 +4715,7 @@ void ZEDWrapperNodelet::publishSensData(ros::Time t)
   {
     if (sens_data.magnetometer.is_available && new_mag_data)
     {
-      lastT_mag = ts_mag;
+      mMagStamp.update(ts_mag.toNSec());
 
       sensor_msgs::MagneticFieldPtr magMsg = boost::make_shared<sensor_msgs::MagneticField>();
 
@@ -3684,7 +4753,7 @@ void ZEDWrapperNodelet::publishSensData(ros::Time t)
 
   if (imu_SubNumber > 0 && new_imu_data)
   {
-    lastTs_imu = ts_imu;
+    mImuStamp.update(ts_imu.toNSec());
 
     sensor_msgs::ImuPtr imuMsg = boost::make_shared<sensor_msgs::Imu>();
 
@@ -3753,13 +4822,14 @@ void ZEDWrapperNodelet::publishSensData(ros::Time t)
 
     sensors_data_published = true;
     mPubImu.publish(imuMsg);
+    markStartupPhase(STARTUP_FIRST_IMU);
   } /*else {
       NODELET_DEBUG("No new IMU DATA");
   }*/
 
   if (imu_RawSubNumber > 0 && new_imu_data)
   {
-    lastTs_imu = ts_imu;
+    mImuStamp.update(ts_imu.toNSec());
 
     sensor_msgs::ImuPtr imuRawMsg = boost::make_shared<sensor_msgs::Imu>();
 
@@ -3805,17 +4875,17 @@ void ZEDWrapperNodelet::publishSensData(ros::Time t)
     imuRawMsg->orientation_covariance[0] = -1;
     sensors_data_published = true;
     mPubImuRaw.publish(imuRawMsg);
+    markStartupPhase(STARTUP_FIRST_IMU);
   }
 
   // ----> Update Diagnostic
   if (sensors_data_published)
   {
     // Publish freq calculation
-    static std::chrono::steady_clock::time_point last_time = std::chrono::steady_clock::now();
     std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
 
-    double elapsed_usec = std::chrono::duration_cast<std::chrono::microseconds>(now - last_time).count();
-    last_time = now;
+    double elapsed_usec = std::chrono::duration_cast<std::chrono::microseconds>(now - mLastSensPubTime).count();
+    mLastSensPubTime = now;
 
     mSensPeriodMean_usec->addValue(elapsed_usec);
   }
@@ -3824,15 +4894,19 @@ void ZEDWrapperNodelet::publishSensData(ros::Time t)
 
 void ZEDWrapperNodelet::device_poll_thread_func()
 {
+  applyThreadSched("Grab", mGrabThreadSched);
+
   ros::Rate loop_rate(mPubFrameRate);
 
   mRecording = false;
 
   mElabPeriodMean_sec.reset(new sl_tools::CSmartMean(mCamFrameRate));
+  mProcPeriodMean_sec.reset(new sl_tools::CSmartMean(mCamFrameRate));
   mGrabPeriodMean_usec.reset(new sl_tools::CSmartMean(mCamFrameRate));
   mVideoDepthPeriodMean_sec.reset(new sl_tools::CSmartMean(mCamFrameRate));
   mPcPeriodMean_usec.reset(new sl_tools::CSmartMean(mCamFrameRate));
   mObjDetPeriodMean_msec.reset(new sl_tools::CSmartMean(mCamFrameRate));
+  mObjDetLatencyMean_msec.reset(new sl_tools::CSmartMean(mCamFrameRate));
 
   // Timestamp initialization
   if (mSvoMode)
@@ -3898,14 +4972,8 @@ void ZEDWrapperNodelet::device_poll_thread_func()
   }
   // <---- Set Region of Interest
 
-  // Create and fill the camera information messages
-  fillCamInfo(mZed, mLeftCamInfoMsg, mRightCamInfoMsg, mLeftCamOptFrameId, mRightCamOptFrameId);
-  fillCamInfo(mZed, mLeftCamInfoRawMsg, mRightCamInfoRawMsg, mLeftCamOptFrameId, mRightCamOptFrameId, true);
-  fillCamDepthInfo(mZed, mDepthCamInfoMsg, mLeftCamOptFrameId);
-
-  // the reference camera is the Left one (next to the ZED logo)
-  mRgbCamInfoMsg = mLeftCamInfoMsg;
-  mRgbCamInfoRawMsg = mLeftCamInfoRawMsg;
+  // Create and fill the calibration snapshot and the camera information messages
+  updateCalibSnapshot();
 
   sl::RuntimeParameters runParams;
 
@@ -3937,7 +5005,8 @@ void ZEDWrapperNodelet::device_poll_thread_func()
     uint32_t pathSubNumber = 0;
     if (!mDepthDisabled)
     {
-      depthSubnumber = mPubDepth.getNumSubscribers();
+      depthSubnumber =
+          mPubDepth.getNumSubscribers() + mPubDepthRvl.getNumSubscribers() + mPubDepthFiltered.getNumSubscribers();
       disparitySubnumber = mPubDisparity.getNumSubscribers();
       cloudSubnumber = mPubCloud.getNumSubscribers();
       fusedCloudSubnumber = mPubFusedCloud.getNumSubscribers();
@@ -3945,11 +5014,12 @@ void ZEDWrapperNodelet::device_poll_thread_func()
       poseCovSubnumber = mPubPoseCov.getNumSubscribers();
       odomSubnumber = mPubOdom.getNumSubscribers();
       confMapSubnumber = mPubConfMap.getNumSubscribers();
-      pathSubNumber = mPubMapPath.getNumSubscribers() + mPubOdomPath.getNumSubscribers();
+      pathSubNumber = mPubMapPath.getNumSubscribers() + mPubOdomPath.getNumSubscribers() +
+                      mPubMapPathAppend.getNumSubscribers() + mPubOdomPathAppend.getNumSubscribers();
 
       if (mObjDetEnabled && mObjDetRunning)
       {
-        objDetSubnumber = mPubObjDet.getNumSubscribers();
+        objDetSubnumber = mPubObjDet.getNumSubscribers() + mPubObjDetDepth.getNumSubscribers();
       }
     }
     uint32_t stereoSubNumber = mPubStereo.getNumSubscribers();
@@ -3967,38 +5037,65 @@ void ZEDWrapperNodelet::device_poll_thread_func()
     // Run the loop only if there is some subscribers or SVO is active
     if (mGrabActive)
     {
-      std::lock_guard<std::mutex> lock(mPosTrkMutex);
-
       // Note: once tracking is started it is never stopped anymore to not lose tracking information
       mPosTrackingRequired =
           !mDepthDisabled && (mPosTrackingEnabled || mPosTrackingStarted || mMappingEnabled || mObjDetEnabled ||
                               (mComputeDepth & mDepthStabilization) || poseSubnumber > 0 || poseCovSubnumber > 0 ||
                               odomSubnumber > 0 || pathSubNumber > 0);
 
+      // ----> Optional modules
+      // In asynchronous mode the modules are started by the warmup thread. The module mutexes are only tried: they
+      // are locked by the services and by the warmup thread while a module is being started or stopped
+
       // Start the tracking?
-      if (mPosTrackingRequired && !mPosTrackingStarted)
       {
-        start_pos_tracking();
+        std::unique_lock<std::mutex> posLock(mPosTrkMutex, std::try_to_lock);
+        if (posLock.owns_lock() && mPosTrackingRequired && !mPosTrackingStarted)
+        {
+          if (mAsyncModulesStart)
+          {
+            requestWarmup(WARMUP_POS_TRACKING);
+          }
+          else
+          {
+            start_pos_tracking();
+          }
+        }
       }
 
       // Start the mapping?
-      mMappingMutex.lock();
-      if (mMappingEnabled && !mMappingRunning)
       {
-        start_3d_mapping();
+        std::unique_lock<std::mutex> mapLock(mMappingMutex, std::try_to_lock);
+        if (mapLock.owns_lock() && mMappingEnabled && !mMappingRunning)
+        {
+          if (mAsyncModulesStart)
+          {
+            requestWarmup(WARMUP_MAPPING);
+          }
+          else
+          {
+            start_3d_mapping();
+          }
+        }
       }
-      mMappingMutex.unlock();
 
       // Start the object detection?
       if (!mDepthDisabled)
       {
-        mObjDetMutex.lock();
-        if (mObjDetEnabled && !mObjDetRunning)
+        std::unique_lock<std::mutex> odLock(mObjDetMutex, std::try_to_lock);
+        if (odLock.owns_lock() && mObjDetEnabled && !mObjDetRunning)
         {
-          start_obj_detect();
+          if (mAsyncModulesStart)
+          {
+            requestWarmup(WARMUP_OBJ_DET);
+          }
+          else
+          {
+            start_obj_detect();
+          }
         }
-        mObjDetMutex.unlock();
       }
+      // <---- Optional modules
 
       // Detect if one of the subscriber need to have the depth information
       mComputeDepth = !mDepthDisabled &&
@@ -4025,6 +5122,9 @@ void ZEDWrapperNodelet::device_poll_thread_func()
       // ZED Grab
       mGrabStatus = mZed.grab(runParams);
 
+      // The processing time excludes the wait for the new frame inside `grab`
+      std::chrono::steady_clock::time_point start_proc = std::chrono::steady_clock::now();
+
       // cout << toString(grab_status) << endl;
       if (mGrabStatus != sl::ERROR_CODE::SUCCESS)
       {
@@ -4032,76 +5132,55 @@ void ZEDWrapperNodelet::device_poll_thread_func()
 
         NODELET_INFO_STREAM_THROTTLE(1.0, "Camera grab error: " << sl::toString(mGrabStatus).c_str());
 
-        std::this_thread::sleep_for(std::chrono::milliseconds(1));
-        if (mGrabStatus != sl::ERROR_CODE::CAMERA_REBOOTING)
+        const double sinceLastFrame_sec =
+            std::chrono::duration<double>(std::chrono::steady_clock::now() - mLastGrabTime).count();
+        switch (sl_tools::grabErrorAction(mGrabStatus, mSvoMode, !mRemoteStreamAddr.empty(), sinceLastFrame_sec,
+                                          mReconnectGrace))
         {
-          std::this_thread::sleep_for(std::chrono::milliseconds(50));
-          continue;
-        }
-        else if (mSvoMode && mGrabStatus == sl::ERROR_CODE::END_OF_SVOFILE_REACHED)
-        {
-          NODELET_WARN("SVO reached the end. The node will be stopped.");
-          mZed.close();
-          exit(EXIT_SUCCESS);
-        }
-        else if (!mRemoteStreamAddr.empty())
-        {
-          NODELET_ERROR("Remote stream problem. The node will be stopped.");
-          mZed.close();
-          exit(EXIT_FAILURE);
-        }
-        else
-        {
-          if ((ros::Time::now() - mPrevFrameTimestamp).toSec() > 5 && !mSvoMode)
-          {
-            mCloseZedMutex.lock();
-            if (mZed.isOpened())
+          case sl_tools::GrabErrorAction::RETRY:
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+            break;
+
+          case sl_tools::GrabErrorAction::STOP:
+            if (mSvoMode)
             {
+              NODELET_WARN("SVO reached the end. The node will be stopped.");
               mZed.close();
+              exit(EXIT_SUCCESS);
             }
-            mCloseZedMutex.unlock();
+            NODELET_ERROR("Remote stream problem. The node will be stopped.");
+            mZed.close();
+            exit(EXIT_FAILURE);
 
-            mConnStatus = sl::ERROR_CODE::CAMERA_NOT_DETECTED;
+          case sl_tools::GrabErrorAction::RECONNECT:
+            if (mRecoveryStart == std::chrono::steady_clock::time_point())
+            {
+              mRecoveryStart = mLastGrabTime;
+            }
 
-            while (mConnStatus != sl::ERROR_CODE::SUCCESS)
+            if (!reconnectCamera())
             {
-              if (!mNhNs.ok())
+              mStopNode = true;
+
+              std::lock_guard<std::shared_mutex> stop_lock(mCloseZedMutex);
+              NODELET_INFO_STREAM("Closing ZED " << mZedSerialNumber << "...");
+              if (mRecording)
               {
-                mStopNode = true;
-
-                std::lock_guard<std::mutex> stop_lock(mCloseZedMutex);
-                NODELET_INFO_STREAM("Closing ZED " << mZedSerialNumber << "...");
-                if (mRecording)
-                {
-                  mRecording = false;
-                  mZed.disableRecording();
-                }
-                if (mZed.isOpened())
-                {
-                  mZed.close();
-                }
-                NODELET_INFO_STREAM("... ZED " << mZedSerialNumber << " closed.");
-
-                NODELET_DEBUG("ZED pool thread finished");
-                return;
+                mRecording = false;
+                mZed.disableRecording();
               }
+              if (mZed.isOpened())
+              {
+                mZed.close();
+              }
+              NODELET_INFO_STREAM("... ZED " << mZedSerialNumber << " closed.");
 
-              mZedParams.input.setFromSerialNumber(mZedSerialNumber);
-              mConnStatus = mZed.open(mZedParams);  // Try to initialize the ZED
-              NODELET_INFO_STREAM("Connection status: " << toString(mConnStatus));
-
-              mDiagUpdater.force_update();
-              std::this_thread::sleep_for(std::chrono::milliseconds(1000));
+              NODELET_DEBUG("ZED pool thread finished");
+              return;
             }
 
-            mPosTrackingStarted = false;
-
-            // Start the tracking?
-            if ((mPosTrackingRequired) && !mPosTrackingStarted && !mDepthDisabled)
-            {
-              start_pos_tracking();
-            }
-          }
+            mLastGrabTime = std::chrono::steady_clock::now();  // Grace time for the new session
+            break;
         }
 
         mDiagUpdater.update();
@@ -4110,6 +5189,17 @@ void ZEDWrapperNodelet::device_poll_thread_func()
       }
 
       mFrameCount++;
+      markStartupPhase(STARTUP_FIRST_FRAME);
+
+      // ----> Recovery time
+      if (mRecoveryStart != std::chrono::steady_clock::time_point())
+      {
+        mLastRecovery_sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - mRecoveryStart).count();
+        mMaxRecovery_sec = std::max(mMaxRecovery_sec, mLastRecovery_sec);
+        mRecoveryStart = std::chrono::steady_clock::time_point();
+        NODELET_INFO_STREAM("Camera recovered in " << mLastRecovery_sec << " sec");
+      }
+      // <---- Recovery time
 
       // ----> Timestamp
       if (mSvoMode)
@@ -4142,22 +5232,20 @@ void ZEDWrapperNodelet::device_poll_thread_func()
       // <---- SVO recording
 
       // ----> Grab freq calculation
-      static std::chrono::steady_clock::time_point last_time = std::chrono::steady_clock::now();
       std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
-      double elapsed_usec = std::chrono::duration_cast<std::chrono::microseconds>(now - last_time).count();
-      last_time = now;
+      double elapsed_usec = std::chrono::duration_cast<std::chrono::microseconds>(now - mLastGrabTime).count();
+      mLastGrabTime = now;
       mGrabPeriodMean_usec->addValue(elapsed_usec);
       // NODELET_INFO_STREAM("Grab time: " << elapsed_usec / 1000 << " msec");
       // <---- Grab freq calculation
 
-      // ----> Camera Settings
-      processCameraSettings();
-      // <---- Camera Settings
-
       // ----> Point Cloud
       if (!mDepthDisabled && cloudSubnumber > 0)
       {
-        processPointcloud(mFrameTimestamp);
+        if (!govSkipFrame(GOV_POINTCLOUD))
+        {
+          processPointcloud(mFrameTimestamp);
+        }
       }
       else
       {
@@ -4166,21 +5254,35 @@ void ZEDWrapperNodelet::device_poll_thread_func()
       // <---- Point Cloud
 
       // ----> Object Detection
-      mObjDetMutex.lock();
-      if (mObjDetRunning && objDetSubnumber > 0)
       {
-        processDetectedObjects(stamp);
+        // Not running while the object detection is being started or stopped
+        std::unique_lock<std::mutex> odLock(mObjDetMutex, std::try_to_lock);
+        if (odLock.owns_lock() && mObjDetRunning && objDetSubnumber > 0 && !govSkipFrame(GOV_OBJ_DET))
+        {
+          processDetectedObjects(stamp);
+        }
       }
-      mObjDetMutex.unlock();
       // <---- Object Detection
 
       // ----> Process Positional Tracking
       if (!mDepthDisabled)
       {
-        if (mPosTrackingStarted)
+        // Skipped for this frame while the tracking is being (re)started by a service or by the warmup thread
+        std::unique_lock<std::mutex> posLock(mPosTrkMutex, std::try_to_lock);
+        if (posLock.owns_lock() && mPosTrackingStarted)
         {
           processOdometry();
           processPose();
+
+          mOdomMutex.lock();
+          updatePoseSnapshot(mFrameTimestamp);
+          mOdomMutex.unlock();
+
+          if (mPoseHistory)
+          {
+            PoseSnapshotPtr poseSnap = getPoseSnapshot();
+            mPoseHistory->add(poseSnap->stamp, poseSnap->odom2base, poseSnap->map2base);
+          }
         }
 
         // Publish `odom` and `map` TFs at the grab frequency
@@ -4220,15 +5322,22 @@ void ZEDWrapperNodelet::device_poll_thread_func()
 
       double elab_usec = std::chrono::duration_cast<std::chrono::microseconds>(end_elab - start_elab).count();
 
-      double mean_elab_sec = mElabPeriodMean_sec->addValue(elab_usec / 1000000.);      
+      double mean_elab_sec = mElabPeriodMean_sec->addValue(elab_usec / 1000000.);
+
+      double proc_usec = std::chrono::duration_cast<std::chrono::microseconds>(end_elab - start_proc).count();
+      double mean_proc_sec = mProcPeriodMean_sec->addValue(proc_usec / 1000000.);
+
+      updateGovernor(mean_proc_sec);
 
+      mGrabLoopCount++;
       if (!loop_rate.sleep())
       {
-        static int count_warn = 0;
+        mGrabDeadlineMiss++;
+
         if (mean_elab_sec > (1. / mPubFrameRate))
         {
           
-          if (++count_warn > 10)
+          if (++mElabWarnCount > 10)
           {
             NODELET_DEBUG_THROTTLE(1.0, "Working thread is not synchronized with the Camera grab rate");
             NODELET_DEBUG_STREAM_THROTTLE(1.0, "Expected cycle time: " << loop_rate.expectedCycleTime()
@@ -4246,7 +5355,7 @@ void ZEDWrapperNodelet::device_poll_thread_func()
         }
         else
         {
-          count_warn = 0;
+          mElabWarnCount = 0;
         }
       }
     }
@@ -4256,6 +5365,7 @@ void ZEDWrapperNodelet::device_poll_thread_func()
 
       std::this_thread::sleep_for(std::chrono::milliseconds(10));  // No subscribers, we just wait
       loop_rate.reset();
+      mLastGrabTime = std::chrono::steady_clock::now();  // The reconnection grace time counts only while grabbing
     }
 
     mDiagUpdater.update();
@@ -4268,7 +5378,7 @@ void ZEDWrapperNodelet::device_poll_thread_func()
 
   mStopNode = true;  // Stops other threads
 
-  std::lock_guard<std::mutex> lock(mCloseZedMutex);
+  std::lock_guard<std::shared_mutex> lock(mCloseZedMutex);
   NODELET_DEBUG("Closing ZED");
 
   if (mRecording)
@@ -4282,6 +5392,70 @@ void ZEDWrapperNodelet::device_poll_thread_func()
   NODELET_DEBUG("ZED pool thread finished");
 }  // namespace zed_nodelets
 
+bool ZEDWrapperNodelet::reconnectCamera()
+{
+  NODELET_WARN_STREAM("No frames from ZED " << mZedSerialNumber << " for " << mReconnectGrace
+                                            << " sec. Reopening the camera");
+
+  mZedParams.input.setFromSerialNumber(mZedSerialNumber);
+  mConnector->requestConnection();
+
+  // The grab thread keeps serving the diagnostic and the node shutdown while the connection thread retries
+  while (!mConnector->waitConnected(std::chrono::milliseconds(100)))
+  {
+    if (!mNhNs.ok())
+    {
+      mConnector->stop();
+      return false;
+    }
+    mDiagUpdater.update();
+  }
+
+  // ----> Warm restart
+  // Same camera: publishers, transforms and dynamic parameters are kept, only the state of the new SDK session is
+  // restored
+  updateCalibSnapshot();
+
+  mDynParMutex.lock();
+  mCamSettingsDirty.set();
+  mDynParMutex.unlock();
+  mCamSettingsCondVar.notify_one();
+
+  // Restarted by the grab loop if still enabled
+  mMappingMutex.lock();
+  mMappingRunning = false;
+  mMappingMutex.unlock();
+  mObjDetMutex.lock();
+  mObjDetRunning = false;
+  mObjDetMutex.unlock();
+
+  // The positional tracking continues from the last pose instead of the initial one
+  if (mPosTrackingStarted && !mDepthDisabled)
+  {
+    std::vector<float> basePose = mInitialBasePose;
+    PoseSnapshotPtr pose = getPoseSnapshot();
+    if (pose)
+    {
+      const tf2::Vector3& t = pose->map2base.getOrigin();
+      double r, p, y;
+      pose->map2base.getBasis().getRPY(r, p, y);
+      basePose = { static_cast<float>(t.x()), static_cast<float>(t.y()), static_cast<float>(t.z()),
+                   static_cast<float>(r),     static_cast<float>(p),     static_cast<float>(y) };
+    }
+
+    std::lock_guard<std::mutex> posLock(mPosTrkMutex);
+    mPosTrackingStarted = false;
+    start_pos_tracking(basePose);
+  }
+  // <---- Warm restart
+
+  const sl_tools::CameraConnector::Stats stats = mConnector->getStats();
+  NODELET_INFO_STREAM("ZED " << mZedSerialNumber << " reopened in " << stats.lastConnect_sec << " sec ("
+                             << stats.attempts << " attempts)");
+
+  return true;
+}
+
 void ZEDWrapperNodelet::processPointcloud(ros::Time ts)
 {
   // Run the point cloud conversion asynchronously to avoid slowing down
@@ -4296,231 +5470,371 @@ void ZEDWrapperNodelet::processPointcloud(ros::Time ts)
     mPointCloudFrameId = mDepthFrameId;
     mPointCloudTime = ts;
 
-    // Signal Pointcloud thread that a new pointcloud is ready
-    mPcDataReadyCondVar.notify_one();
+    if (mUseSharedExecutor)
+    {
+      // Post a publishing task only if the previous one has been executed, the retrieved
+      // pointcloud is the latest in any case
+      if (!mPcDataReady)
+      {
+        std::chrono::microseconds period(static_cast<int64_t>(1e6 / mPointCloudFreq));
+        std::chrono::steady_clock::time_point release =
+            std::max(std::chrono::steady_clock::now(), mLastPcThreadTime + period);
+        mExecutor->post(mExecutorClientId, sl_tools::TaskClass::POINTCLOUD, release, release + period,
+                        std::bind(&ZEDWrapperNodelet::pointcloud_task_func, this));
+      }
+    }
+    else
+    {
+      // Signal Pointcloud thread that a new pointcloud is ready
+      mPcDataReadyCondVar.notify_one();
+    }
     mPcDataReady = true;
     mPcPublishing = true;
   }
 }
 
-void ZEDWrapperNodelet::processCameraSettings()
+void ZEDWrapperNodelet::requestWarmup(WarmupModule module)
 {
-  
-  sl::VIDEO_SETTINGS setting;
-  sl::ERROR_CODE err;
-
-  if (!mSvoMode && mFrameCount % 5 == 0)
+  std::lock_guard<std::mutex> lock(mWarmupMutex);
+  if (mWarmupPending & module)
   {
-    // NODELET_DEBUG_STREAM( "[" << mFrameCount << "] device_poll_thread_func MUTEX LOCK");
-    mDynParMutex.lock();
+    return;
+  }
+  mWarmupPending |= module;
+  mWarmupCondVar.notify_one();
+}
 
-    int value;
-    setting = sl::VIDEO_SETTINGS::BRIGHTNESS;
-    err = mZed.getCameraSettings(setting, value);
-    if (err == sl::ERROR_CODE::SUCCESS && value != mCamBrightness)
-    {
-      err = mZed.setCameraSettings(setting, mCamBrightness);
-    }
-    if (err != sl::ERROR_CODE::SUCCESS)
-    {
-      NODELET_WARN_STREAM("Error setting parameter " << sl::toString(setting) << ": " << sl::toString(err));
-    }
-    else
-    {
-      NODELET_DEBUG_STREAM(sl::toString(setting) << " changed: " << mCamBrightness << " <- " << value);
-      mUpdateDynParams = true;
-    }
+void ZEDWrapperNodelet::warmup_thread_func()
+{
+  NODELET_DEBUG("Warmup thread started");
 
-    setting = sl::VIDEO_SETTINGS::CONTRAST;
-    err = mZed.getCameraSettings(setting, value);
-    if (err == sl::ERROR_CODE::SUCCESS && value != mCamContrast)
+  std::unique_lock<std::mutex> lock(mWarmupMutex);
+  while (!mStopNode)
+  {
+    // The timeout only bounds the reaction time to the node stop
+    mWarmupCondVar.wait_for(lock, std::chrono::milliseconds(100), [this] { return mWarmupPending || mStopNode; });
+    if (mStopNode)
     {
-      err = mZed.setCameraSettings(setting, mCamContrast);
+      break;
     }
-    if (err != sl::ERROR_CODE::SUCCESS)
+    if (!mWarmupPending)
     {
-      NODELET_WARN_STREAM("Error setting parameter " << sl::toString(setting) << ": " << sl::toString(err));
+      continue;
     }
-    else
+
+    // The requests received while working are ignored, a module that failed is requested again by the grab loop
+    const unsigned todo = mWarmupPending;
+    lock.unlock();
+
+    // Tracking first, the mapping requires it
+    if (todo & WARMUP_POS_TRACKING)
     {
-      NODELET_DEBUG_STREAM(sl::toString(setting) << " changed: " << mCamContrast << " <- " << value);
-      mUpdateDynParams = true;
+      // The grab loop skips the tracking processing while the mutex is locked
+      std::lock_guard<std::mutex> posLock(mPosTrkMutex);
+      if (!mPosTrackingStarted)
+      {
+        start_pos_tracking();
+      }
     }
 
-    setting = sl::VIDEO_SETTINGS::HUE;
-    err = mZed.getCameraSettings(setting, value);
-    if (err == sl::ERROR_CODE::SUCCESS && value != mCamHue)
+    if (todo & WARMUP_MAPPING)
     {
-      err = mZed.setCameraSettings(setting, mCamHue);
+      std::lock_guard<std::mutex> mapLock(mMappingMutex);
+      if (mMappingEnabled && !mMappingRunning && mPosTrackingStarted)
+      {
+        start_3d_mapping();
+      }
     }
-    if (err != sl::ERROR_CODE::SUCCESS)
+
+    if (todo & WARMUP_OBJ_DET)
     {
-      NODELET_WARN_STREAM("Error setting parameter " << sl::toString(setting) << ": " << sl::toString(err));
+      std::lock_guard<std::mutex> odLock(mObjDetMutex);
+      if (mObjDetEnabled && !mObjDetRunning)
+      {
+        start_obj_detect();
+      }
     }
-    else
+
+    lock.lock();
+    mWarmupPending &= ~todo;
+  }
+
+  NODELET_DEBUG("Warmup thread finished");
+}
+
+void ZEDWrapperNodelet::markStartupPhase(StartupPhase phase)
+{
+  if (mStartupPhaseDone[phase].load(std::memory_order_acquire))
+  {
+    return;  // Fast path for the per frame calls
+  }
+
+  std::lock_guard<std::mutex> lock(mStartupMutex);
+  if (mStartupPhaseDone[phase].load(std::memory_order_relaxed))
+  {
+    return;
+  }
+
+  mStartupPhaseTime[phase] = std::chrono::duration<double>(std::chrono::steady_clock::now() - mStartupTime).count();
+  mStartupPhaseDone[phase].store(true, std::memory_order_release);
+
+  NODELET_INFO_STREAM("Startup phase '" << STARTUP_PHASE_NAMES[phase] << "' reached after " << mStartupPhaseTime[phase]
+                                        << " sec");
+
+  publishStartupTimeline();
+}
+
+void ZEDWrapperNodelet::publishStartupTimeline()
+{
+  if (mPubStartupTimeline.getTopic().empty())
+  {
+    return;
+  }
+
+  // Phases in the order they were reached
+  std::vector<int> reached;
+  for (int i = 0; i < STARTUP_PHASE_COUNT; i++)
+  {
+    if (mStartupPhaseDone[i].load(std::memory_order_relaxed))
     {
-      NODELET_DEBUG_STREAM(sl::toString(setting) << " changed: " << mCamHue << " <- " << value);
-      mUpdateDynParams = true;
+      reached.push_back(i);
     }
+  }
+  std::stable_sort(reached.begin(), reached.end(),
+                   [this](int a, int b) { return mStartupPhaseTime[a] < mStartupPhaseTime[b]; });
+
+  diagnostic_msgs::DiagnosticStatusPtr msg = boost::make_shared<diagnostic_msgs::DiagnosticStatus>();
+  msg->level = diagnostic_msgs::DiagnosticStatus::OK;
+  msg->name = getName() + ": startup timeline";
+  msg->hardware_id = std::to_string(mZedSerialNumber);
+  msg->message = "Seconds since the nodelet start";
+  msg->values.resize(reached.size());
+  for (size_t i = 0; i < reached.size(); i++)
+  {
+    char value[32];
+    snprintf(value, sizeof(value), "%.3f", mStartupPhaseTime[reached[i]]);
+    msg->values[i].key = STARTUP_PHASE_NAMES[reached[i]];
+    msg->values[i].value = value;
+  }
+
+  mPubStartupTimeline.publish(msg);
+}
+
+void ZEDWrapperNodelet::cam_ctrl_thread_func()
+{
+  NODELET_DEBUG("Camera controls thread started");
+
+  applyThreadSched("Camera controls", mCamCtrlThreadSched);
 
-    setting = sl::VIDEO_SETTINGS::SATURATION;
-    err = mZed.getCameraSettings(setting, value);
-    if (err == sl::ERROR_CODE::SUCCESS && value != mCamSaturation)
+  std::vector<int> values(static_cast<size_t>(sl::VIDEO_SETTINGS::LAST), 0);
+  auto value = [&values](sl::VIDEO_SETTINGS setting) -> int& { return values[static_cast<size_t>(setting)]; };
+
+  const bool readback = !mSvoMode && mCamSettingsReadback > 0.0;
+  const auto readbackPeriod = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+      std::chrono::duration<double>(readback ? mCamSettingsReadback : 1.0));
+  std::chrono::steady_clock::time_point nextReadback = std::chrono::steady_clock::now() + readbackPeriod;
+
+  while (!mStopNode)
+  {
+    CamSettingsMask dirty;
+    bool autoExposure;
+    bool autoWB;
+    bool updateDynParams;
+
+    // ----> Wait for changes
     {
-      err = mZed.setCameraSettings(setting, mCamSaturation);
+      std::unique_lock<std::mutex> lock(mDynParMutex);
+
+      // The timeout only bounds the reaction time to the node stop
+      std::chrono::steady_clock::time_point wakeup = std::chrono::steady_clock::now() + std::chrono::milliseconds(100);
+      if (readback)
+      {
+        wakeup = std::min(wakeup, nextReadback);
+      }
+      mCamSettingsCondVar.wait_until(lock, wakeup,
+                                     [this] { return mCamSettingsDirty.any() || mUpdateDynParams || mStopNode; });
+      if (mStopNode)
+      {
+        break;
+      }
+
+      dirty = mCamSettingsDirty;
+      mCamSettingsDirty.reset();
+      updateDynParams = mUpdateDynParams;
+      mUpdateDynParams = false;
+
+      autoExposure = mCamAutoExposure;
+      autoWB = mCamAutoWB;
+      if (dirty.any())
+      {
+        value(sl::VIDEO_SETTINGS::BRIGHTNESS) = mCamBrightness;
+        value(sl::VIDEO_SETTINGS::CONTRAST) = mCamContrast;
+        value(sl::VIDEO_SETTINGS::HUE) = mCamHue;
+        value(sl::VIDEO_SETTINGS::SATURATION) = mCamSaturation;
+        value(sl::VIDEO_SETTINGS::SHARPNESS) = mCamSharpness;
+        value(sl::VIDEO_SETTINGS::GAMMA) = mCamGamma;
+        value(sl::VIDEO_SETTINGS::AEC_AGC) = (autoExposure ? 1 : 0);
+        value(sl::VIDEO_SETTINGS::EXPOSURE) = mCamExposure;
+        value(sl::VIDEO_SETTINGS::GAIN) = mCamGain;
+        value(sl::VIDEO_SETTINGS::WHITEBALANCE_AUTO) = (autoWB ? 1 : 0);
+        value(sl::VIDEO_SETTINGS::WHITEBALANCE_TEMPERATURE) = mCamWB;
+      }
     }
-    if (err != sl::ERROR_CODE::SUCCESS)
+    // <---- Wait for changes
+
+    // Camera settings cannot be changed while playing an SVO
+    if (dirty.any() && !mSvoMode)
     {
-      NODELET_WARN_STREAM("Error setting parameter " << sl::toString(setting) << ": " << sl::toString(err));
+      applyCameraSettings(dirty, values, autoExposure, autoWB);
     }
-    else
+
+    if (readback && std::chrono::steady_clock::now() >= nextReadback)
     {
-      NODELET_DEBUG_STREAM(sl::toString(setting) << " changed: " << mCamSaturation << " <- " << value);
-      mUpdateDynParams = true;
+      nextReadback = std::chrono::steady_clock::now() + readbackPeriod;
+      updateDynParams |= readbackCameraSettings();
     }
 
-    setting = sl::VIDEO_SETTINGS::SHARPNESS;
-    err = mZed.getCameraSettings(setting, value);
-    if (err == sl::ERROR_CODE::SUCCESS && value != mCamSharpness)
+    if (updateDynParams)
     {
-      err = mZed.setCameraSettings(setting, mCamSharpness);
+      NODELET_DEBUG("Update Dynamic Parameters");
+      updateDynamicReconfigure();
     }
-    if (err != sl::ERROR_CODE::SUCCESS)
+  }
+
+  NODELET_DEBUG("Camera controls thread finished");
+}
+
+void ZEDWrapperNodelet::applyCameraSettings(const CamSettingsMask& dirty, const std::vector<int>& values,
+                                            bool autoExposure, bool autoWB)
+{
+  // Automatic modes first: the manual values are applied after the automatic control is disabled
+  static const sl::VIDEO_SETTINGS order[] = { sl::VIDEO_SETTINGS::AEC_AGC,    sl::VIDEO_SETTINGS::WHITEBALANCE_AUTO,
+                                              sl::VIDEO_SETTINGS::BRIGHTNESS, sl::VIDEO_SETTINGS::CONTRAST,
+                                              sl::VIDEO_SETTINGS::HUE,        sl::VIDEO_SETTINGS::SATURATION,
+                                              sl::VIDEO_SETTINGS::SHARPNESS,  sl::VIDEO_SETTINGS::GAMMA,
+                                              sl::VIDEO_SETTINGS::EXPOSURE,   sl::VIDEO_SETTINGS::GAIN,
+                                              sl::VIDEO_SETTINGS::WHITEBALANCE_TEMPERATURE };
+
+  std::shared_lock<std::shared_mutex> lock(mCloseZedMutex);
+  if (mConnStatus != sl::ERROR_CODE::SUCCESS || !mZed.isOpened())
+  {
+    return;  // All the settings are applied again when the camera is reopened
+  }
+
+  for (sl::VIDEO_SETTINGS setting : order)
+  {
+    if (!dirty.test(static_cast<size_t>(setting)))
     {
-      NODELET_WARN_STREAM("Error setting parameter " << sl::toString(setting) << ": " << sl::toString(err));
+      continue;
     }
-    else
+    if ((autoExposure && (setting == sl::VIDEO_SETTINGS::EXPOSURE || setting == sl::VIDEO_SETTINGS::GAIN)) ||
+        (autoWB && setting == sl::VIDEO_SETTINGS::WHITEBALANCE_TEMPERATURE))
     {
-      NODELET_DEBUG_STREAM(sl::toString(setting) << " changed: " << mCamSharpness << " <- " << value);
-      mUpdateDynParams = true;
+      continue;  // Controlled by the camera
     }
 
-    setting = sl::VIDEO_SETTINGS::GAMMA;
-    err = mZed.getCameraSettings(setting, value);
-    if (err == sl::ERROR_CODE::SUCCESS && value != mCamGamma)
-    {
-      err = mZed.setCameraSettings(setting, mCamGamma);
-    }
+    int value = values[static_cast<size_t>(setting)];
+    sl::ERROR_CODE err = mZed.setCameraSettings(setting, value);
     if (err != sl::ERROR_CODE::SUCCESS)
     {
       NODELET_WARN_STREAM("Error setting parameter " << sl::toString(setting) << ": " << sl::toString(err));
     }
     else
     {
-      NODELET_DEBUG_STREAM(sl::toString(setting) << " changed: " << mCamGamma << " <- " << value);
-      mUpdateDynParams = true;
+      NODELET_DEBUG_STREAM(sl::toString(setting) << " changed: " << value);
     }
+  }
+}
+
+bool ZEDWrapperNodelet::readbackCameraSettings()
+{
+  mDynParMutex.lock();
+  bool autoExposure = mCamAutoExposure;
+  bool autoWB = mCamAutoWB;
+  mDynParMutex.unlock();
+
+  if (!autoExposure && !autoWB)
+  {
+    return false;
+  }
+
+  int exposure = -1;
+  int gain = -1;
+  int wb = -1;
 
-    if (mTriggerAutoExposure)
+  // ----> Read from the camera
+  {
+    std::shared_lock<std::shared_mutex> lock(mCloseZedMutex);
+    if (mConnStatus != sl::ERROR_CODE::SUCCESS || !mZed.isOpened())
     {
-      setting = sl::VIDEO_SETTINGS::AEC_AGC;
-      err = mZed.getCameraSettings(setting, value);
-      int aec_agc = (mCamAutoExposure ? 1 : 0);
-      if (err == sl::ERROR_CODE::SUCCESS && value != aec_agc)
-      {
-        err = mZed.setCameraSettings(setting, aec_agc);
-      }
-      if (err != sl::ERROR_CODE::SUCCESS)
-      {
-        NODELET_WARN_STREAM("Error setting parameter " << sl::toString(setting) << ": " << sl::toString(err));
-      }
-      else
-      {
-        NODELET_DEBUG_STREAM(sl::toString(setting) << " changed: " << aec_agc << " <- " << value);
-        mUpdateDynParams = true;
-      }
+      return false;
     }
-    if (!mCamAutoExposure)
-    {
-      setting = sl::VIDEO_SETTINGS::EXPOSURE;
-      err = mZed.getCameraSettings(setting, value);
-      if (err == sl::ERROR_CODE::SUCCESS && value != mCamExposure)
-      {
-        err = mZed.setCameraSettings(setting, mCamExposure);
-      }
-      if (err != sl::ERROR_CODE::SUCCESS)
-      {
-        NODELET_WARN_STREAM("Error setting parameter " << sl::toString(setting) << ": " << sl::toString(err));
-      }
-      else
-      {
-        NODELET_DEBUG_STREAM(sl::toString(setting) << " changed: " << mCamExposure << " <- " << value);
-        mUpdateDynParams = true;
-      }
 
-      setting = sl::VIDEO_SETTINGS::GAIN;
-      err = mZed.getCameraSettings(setting, value);
-      if (err == sl::ERROR_CODE::SUCCESS && value != mCamGain)
-      {
-        err = mZed.setCameraSettings(setting, mCamGain);
-      }
-      if (err != sl::ERROR_CODE::SUCCESS)
+    if (autoExposure)
+    {
+      if (mZed.getCameraSettings(sl::VIDEO_SETTINGS::EXPOSURE, exposure) != sl::ERROR_CODE::SUCCESS)
       {
-        NODELET_WARN_STREAM("Error setting parameter " << sl::toString(setting) << ": " << sl::toString(err));
+        exposure = -1;
       }
-      else
+      if (mZed.getCameraSettings(sl::VIDEO_SETTINGS::GAIN, gain) != sl::ERROR_CODE::SUCCESS)
       {
-        NODELET_DEBUG_STREAM(sl::toString(setting) << " changed: " << mCamGain << " <- " << value);
-        mUpdateDynParams = true;
+        gain = -1;
       }
     }
+    if (autoWB && mZed.getCameraSettings(sl::VIDEO_SETTINGS::WHITEBALANCE_TEMPERATURE, wb) != sl::ERROR_CODE::SUCCESS)
+    {
+      wb = -1;
+    }
+  }
+  // <---- Read from the camera
 
-    if (mTriggerAutoWB)
+  // The values are copied only if the automatic control is still active: disabling it keeps the last
+  // values chosen by the camera
+  std::lock_guard<std::mutex> lock(mDynParMutex);
+  bool changed = false;
+  if (mCamAutoExposure)
+  {
+    if (exposure >= 0 && exposure != mCamExposure)
     {
-      setting = sl::VIDEO_SETTINGS::WHITEBALANCE_AUTO;
-      err = mZed.getCameraSettings(setting, value);
-      int wb_auto = (mCamAutoWB ? 1 : 0);
-      if (err == sl::ERROR_CODE::SUCCESS && value != wb_auto)
-      {
-        err = mZed.setCameraSettings(setting, wb_auto);
-      }
-      if (err != sl::ERROR_CODE::SUCCESS)
-      {
-        NODELET_WARN_STREAM("Error setting parameter " << sl::toString(setting) << ": " << sl::toString(err));
-      }
-      else
-      {
-        NODELET_DEBUG_STREAM(sl::toString(setting) << " changed: " << wb_auto << " <- " << value);
-        mUpdateDynParams = true;
-      }
+      mCamExposure = exposure;
+      changed = true;
     }
-    if (!mCamAutoWB)
+    if (gain >= 0 && gain != mCamGain)
     {
-      setting = sl::VIDEO_SETTINGS::WHITEBALANCE_TEMPERATURE;
-      err = mZed.getCameraSettings(setting, value);
-      if (err == sl::ERROR_CODE::SUCCESS && value != mCamWB)
-      {
-        err = mZed.setCameraSettings(setting, mCamWB);
-      }
-      if (err != sl::ERROR_CODE::SUCCESS)
-      {
-        NODELET_WARN_STREAM("Error setting parameter " << sl::toString(setting) << ": " << sl::toString(err));
-      }
-      else
-      {
-        NODELET_DEBUG_STREAM(sl::toString(setting) << " changed: " << mCamWB << " <- " << value);
-        mUpdateDynParams = true;
-      }
+      mCamGain = gain;
+      changed = true;
     }
-    mDynParMutex.unlock();
-    // NODELET_DEBUG_STREAM( "device_poll_thread_func MUTEX UNLOCK");
   }
-
-  if (mUpdateDynParams)
+  if (mCamAutoWB && wb >= 0 && wb / 100 != mCamWB / 100)  // The dynamic parameter is in hundreds of Kelvin
   {
-    NODELET_DEBUG("Update Dynamic Parameters");
-    updateDynamicReconfigure();
+    mCamWB = wb;
+    changed = true;
   }
-}
 
+  return changed;
+}
 void ZEDWrapperNodelet::callback_updateDiagnostic(diagnostic_updater::DiagnosticStatusWrapper& stat)
 {
   if (mConnStatus != sl::ERROR_CODE::SUCCESS)
   {
     stat.summary(diagnostic_msgs::DiagnosticStatus::ERROR, sl::toString(mConnStatus).c_str());
+    if (mConnector && mConnector->getState() == sl_tools::CameraConnector::State::CONNECTING)
+    {
+      stat.addf("Connection", "Attempt %u", mConnector->getStats().attempts + 1);
+    }
     return;
   }
 
+  if (mConnector)
+  {
+    const sl_tools::CameraConnector::Stats conn = mConnector->getStats();
+    if (conn.connections > 1)
+    {
+      stat.addf("Reconnections", "%u - Last recovery: %.3f sec (Max. %.3f sec) - Last reopening: %.3f sec",
+                conn.connections - 1, mLastRecovery_sec, mMaxRecovery_sec, conn.lastConnect_sec);
+    }
+  }
+
   if (mGrabActive)
   {
     if (mGrabStatus == sl::ERROR_CODE::SUCCESS /*|| mGrabStatus == sl::ERROR_CODE::NOT_A_NEW_FRAME*/)
@@ -4592,6 +5906,8 @@ void ZEDWrapperNodelet::callback_updateDiagnostic(diagnostic_updater::Diagnostic
           freq = 1000. / mObjDetPeriodMean_msec->getMean();
           freq_perc = 100. * freq / mPubFrameRate;
           stat.addf("Object detection", "Mean Frequency: %.3f Hz  (%.1f%%)", freq, freq_perc);
+          stat.addf("Object detection latency", "Mean: %.1f msec - Dropped results: %lu",
+                    mObjDetLatencyMean_msec->getMean(), static_cast<unsigned long>(mObjDetDropCount.load()));
         }
         else
         {
@@ -4619,6 +5935,9 @@ void ZEDWrapperNodelet::callback_updateDiagnostic(diagnostic_updater::Diagnostic
     double freq = 1000000. / mSensPeriodMean_usec->getMean();
     double freq_perc = 100. * freq / mSensPubRate;
     stat.addf("IMU", "Mean Frequency: %.1f Hz (%.1f%%)", freq, freq_perc);
+    stat.addf("IMU sampling", "Period: %.3f msec - Duplicated reads: %lu - Missed samples: %lu",
+              mImuPeriodEst_msec.load(), static_cast<unsigned long>(mSensDuplicateReads),
+              static_cast<unsigned long>(mSensMissedSamples));
   }
   else
   {
@@ -4641,6 +5960,45 @@ void ZEDWrapperNodelet::callback_updateDiagnostic(diagnostic_updater::Diagnostic
     stat.add("Right CMOS Temp.", "N/A");
   }
 
+  if (mGovEnabled)
+  {
+    stat.addf("Load governor", "Degradation level %d/%d", mGovLevel.load(), static_cast<int>(mGovShedOrder.size()));
+    if (mGovLevel > 0)
+    {
+      stat.mergeSummary(diagnostic_msgs::DiagnosticStatus::WARN, "Load shedding active");
+    }
+  }
+
+  stat.addf("Deadline misses", "Grab: %lu/%lu - Sensors: %lu/%lu - Point Cloud: %lu/%lu",
+            static_cast<unsigned long>(mGrabDeadlineMiss), static_cast<unsigned long>(mGrabLoopCount),
+            static_cast<unsigned long>(mSensDeadlineMiss), static_cast<unsigned long>(mSensLoopCount),
+            static_cast<unsigned long>(mPcDeadlineMiss), static_cast<unsigned long>(mPcLoopCount));
+
+  if (mExecutor)
+  {
+    // ----> Shared executor CPU share
+    uint64_t client_nsec, total_nsec, late_count;
+    mExecutor->getStats(mExecutorClientId, client_nsec, total_nsec, late_count);
+
+    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    double wall_nsec = std::chrono::duration_cast<std::chrono::nanoseconds>(now - mExecLastStatsTime).count();
+    double client_delta = static_cast<double>(client_nsec - mExecLastClient_nsec);
+    double total_delta = static_cast<double>(total_nsec - mExecLastTotal_nsec);
+
+    double share_perc = (total_delta > 0.) ? 100. * client_delta / total_delta : 0.;
+    double load_perc = (wall_nsec > 0.) ? 100. * total_delta / (wall_nsec * mExecutor->getWorkerCount()) : 0.;
+
+    stat.addf("Shared Executor", "Workers: %d - Cameras: %d - Load: %.1f%%", mExecutor->getWorkerCount(),
+              mExecutor->getClientCount(), load_perc);
+    stat.addf("Shared Executor CPU share", "%.1f%% (priority %d) - Late tasks: %lu", share_perc, mExecutorPriority,
+              static_cast<unsigned long>(late_count));
+
+    mExecLastClient_nsec = client_nsec;
+    mExecLastTotal_nsec = total_nsec;
+    mExecLastStatsTime = now;
+    // <---- Shared executor CPU share
+  }
+
   if (mRecording)
   {
     if (!mRecStatus.status)
@@ -5142,8 +6500,6 @@ bool ZEDWrapperNodelet::on_enable_object_detection(std_srvs::SetBool::Request& r
 
 void ZEDWrapperNodelet::processDetectedObjects(ros::Time t)
 {
-  static std::chrono::steady_clock::time_point old_time = std::chrono::steady_clock::now();
-
   sl::ObjectDetectionRuntimeParameters objectTracker_parameters_rt;
   objectTracker_parameters_rt.detection_confidence_threshold = mObjDetConfidence;
   objectTracker_parameters_rt.object_class_filter = mObjDetFilter;
@@ -5163,61 +6519,358 @@ void ZEDWrapperNodelet::processDetectedObjects(ros::Time t)
     return;
   }
 
+  // ----> Depth map used to measure the objects. Retrieved here because only the grab thread can retrieve the
+  // measures of the current frame, the measurement is done by the publishing stage
+  bool depthReady = false;
+  if (mObjDetDepth && !objects.object_list.empty() && mPubObjDetDepth.getNumSubscribers() > 0)
+  {
+    if (mFrameDepth.isInit() &&
+        mFrameDepth.timestamp.data_ns == mZed.getTimestamp(sl::TIME_REFERENCE::IMAGE).data_ns)
+    {
+      // Already retrieved for the depth topics: the buffer is shared, not copied. It is never written again, the
+      // next frame is retrieved into a new buffer
+      mObjDetDepthGrab = mFrameDepth;
+      depthReady = true;
+    }
+    else
+    {
+      depthReady = (mZed.retrieveMeasure(mObjDetDepthGrab, sl::MEASURE::DEPTH, sl::MEM::CPU, mMatResol) ==
+                    sl::ERROR_CODE::SUCCESS);
+    }
+  }
+  // <---- Depth map used to measure the objects
+
+  // ----> Queue the results, the latest frame wins
+  std::lock_guard<std::mutex> lock(mObjDetDataMutex);
+
+  if (mObjDetDataReady)
+  {
+    mObjDetDropCount++;
+  }
+
+  std::swap(mObjDetData, objects);
+  if (depthReady)
+  {
+    std::swap(mObjDetDepthData, mObjDetDepthGrab);
+  }
+  mObjDetDepthReady = depthReady;
+  mObjDetDataTime = t;
+  mObjDetQueueTime = std::chrono::steady_clock::now();
+  mObjDetDataReady = true;
+
+  if (mUseSharedExecutor)
+  {
+    // Post a publishing task only if the previous one has been completed: the publishing stage is not reentrant
+    if (!mObjDetTaskPosted)
+    {
+      postObjDetTask();
+    }
+  }
+  else
+  {
+    mObjDetDataCondVar.notify_one();
+  }
+  // <---- Queue the results, the latest frame wins
+}
+
+void ZEDWrapperNodelet::obj_det_thread_func()
+{
+  sl::Objects objects;
+  ros::Time t;
+  std::chrono::steady_clock::time_point queueTime;
+  bool depthReady = false;
+
+  while (!mStopNode)
+  {
+    {
+      std::unique_lock<std::mutex> lock(mObjDetDataMutex);
+
+      if (!mObjDetDataCondVar.wait_for(lock, std::chrono::milliseconds(500),
+                                       [this] { return mObjDetDataReady || mStopNode; }))
+      {
+        continue;
+      }
+
+      // ----> Rate control: results received while waiting replace the queued ones
+      if (mObjDetMaxRate > 0.0)
+      {
+        std::chrono::steady_clock::time_point next =
+            mObjDetLastTakeTime + std::chrono::microseconds(static_cast<int64_t>(1e6 / mObjDetMaxRate));
+        mObjDetDataCondVar.wait_until(lock, next, [this] { return mStopNode; });
+      }
+      // <---- Rate control
+
+      if (mStopNode || !mObjDetDataReady)
+      {
+        continue;
+      }
+
+      std::swap(objects, mObjDetData);
+      t = mObjDetDataTime;
+      queueTime = mObjDetQueueTime;
+      mObjDetDataReady = false;
+      mObjDetLastTakeTime = std::chrono::steady_clock::now();
+      depthReady = mObjDetDepthReady;
+      if (depthReady)
+      {
+        std::swap(mObjDetDepthOut, mObjDetDepthData);
+        mObjDetDepthReady = false;
+      }
+    }
+
+    publishDetectedObjects(objects, t, queueTime);
+    if (depthReady)
+    {
+      publishObjectsDepth(objects, mObjDetDepthOut, t);
+    }
+  }
+
+  NODELET_DEBUG("Object Detection thread finished");
+}
+
+void ZEDWrapperNodelet::postObjDetTask()
+{
+  std::chrono::steady_clock::time_point release = mObjDetQueueTime;
+  std::chrono::microseconds period(static_cast<int64_t>(1e6 / mPubFrameRate));
+  if (mObjDetMaxRate > 0.0)
+  {
+    period = std::chrono::microseconds(static_cast<int64_t>(1e6 / mObjDetMaxRate));
+    release = std::max(release, mObjDetLastTakeTime + period);
+  }
+  mObjDetTaskPosted = mExecutor->post(mExecutorClientId, sl_tools::TaskClass::OBJ_DET, release, release + period,
+                                      std::bind(&ZEDWrapperNodelet::obj_det_task_func, this));
+}
+
+void ZEDWrapperNodelet::obj_det_task_func()
+{
+  sl::Objects objects;
+  ros::Time t;
+  std::chrono::steady_clock::time_point queueTime;
+  bool depthReady = false;
+
+  {
+    std::lock_guard<std::mutex> lock(mObjDetDataMutex);
+
+    if (mStopNode || !mObjDetDataReady)
+    {
+      mObjDetTaskPosted = false;
+      return;
+    }
+
+    std::swap(objects, mObjDetData);
+    t = mObjDetDataTime;
+    queueTime = mObjDetQueueTime;
+    mObjDetDataReady = false;
+    mObjDetLastTakeTime = std::chrono::steady_clock::now();
+    depthReady = mObjDetDepthReady;
+    if (depthReady)
+    {
+      std::swap(mObjDetDepthOut, mObjDetDepthData);
+      mObjDetDepthReady = false;
+    }
+  }
+
+  publishDetectedObjects(objects, t, queueTime);
+  if (depthReady)
+  {
+    publishObjectsDepth(objects, mObjDetDepthOut, t);
+  }
+
+  // ----> Completed: a new task can be posted. The results queued while publishing are taken by a new task now,
+  // because the grab thread did not post it
+  std::lock_guard<std::mutex> lock(mObjDetDataMutex);
+  mObjDetTaskPosted = false;
+  if (!mStopNode && mObjDetDataReady)
+  {
+    postObjDetTask();
+  }
+  // <---- Completed
+}
+
+void ZEDWrapperNodelet::publishDetectedObjects(sl::Objects& objects, ros::Time t,
+                                               std::chrono::steady_clock::time_point queueTime)
+{
+  if (!mObjDetRunning)
+  {
+    return;
+  }
+
+  // With asynchronous detection the results can refer to a frame older than the one they have been retrieved with:
+  // stamp the message with the frame used by the inference and account for the age in the latency
+  if (mObjDetAsync && !mSvoMode && objects.timestamp.data_ns != 0)
+  {
+    ros::Time objStamp = sl_tools::slTime2Ros(objects.timestamp);
+    if (objStamp < t)
+    {
+      queueTime -= std::chrono::nanoseconds((t - objStamp).toNSec());
+      t = objStamp;
+    }
+  }
+
   // ----> Diagnostic information update
   std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
-  double elapsed_msec = std::chrono::duration_cast<std::chrono::milliseconds>(now - old_time).count();
+  double elapsed_msec = std::chrono::duration_cast<std::chrono::milliseconds>(now - mLastObjDetTime).count();
   mObjDetPeriodMean_msec->addValue(elapsed_msec);
-  old_time = now;
+  mLastObjDetTime = now;
+  mObjDetLatencyMean_msec->addValue(std::chrono::duration_cast<std::chrono::microseconds>(now - queueTime).count() /
+                                    1000.);
   // <---- Diagnostic information update
 
   NODELET_DEBUG_STREAM("Detected " << objects.object_list.size() << " objects");
 
-  size_t objCount = objects.object_list.size();
-
-  zed_interfaces::ObjectsStampedPtr objMsg = boost::make_shared<zed_interfaces::ObjectsStamped>();
+  // Reuse the storage of the previous message, including the label strings, when no subscriber holds it
+  if (!mObjDetMsg || !mObjDetMsg.unique())
+  {
+    mObjDetMsg = boost::make_shared<zed_interfaces::ObjectsStamped>();
+  }
+  zed_interfaces::ObjectsStampedPtr objMsg = mObjDetMsg;
   objMsg->header.stamp = t;
   objMsg->header.frame_id = mLeftCamFrameId;
 
-  objMsg->objects.resize(objCount);
+  sl_tools::objectsToROSmsg(objects.object_list, mObjDetTracking, objMsg->objects);
+
+  mPubObjDet.publish(objMsg);
+}
+
+void ZEDWrapperNodelet::publishObjectsDepth(const sl::Objects& objects, sl::Mat depth, ros::Time t)
+{
+  CalibSnapshotPtr calib = getCalibSnapshot();
+  if (!mObjDetRunning || !calib || depth.getWidth() == 0 || depth.getHeight() == 0)
+  {
+    return;
+  }
+
+  // Bounding boxes are in grab resolution, the depth map and the calibration in publishing resolution
+  const float boxScaleX = static_cast<float>(depth.getWidth()) / mCamWidth;
+  const float boxScaleY = static_cast<float>(depth.getHeight()) / mCamHeight;
+  const float fx = calib->fx * depth.getWidth() / calib->resol.width;
+  const float fy = calib->fy * depth.getHeight() / calib->resol.height;
+  const float cx = calib->cx * depth.getWidth() / calib->resol.width;
+  const float cy = calib->cy * depth.getHeight() / calib->resol.height;
+
+  const float* depthData = depth.getPtr<float>(sl::MEM::CPU);
+  const size_t depthStep = depth.getStepBytes(sl::MEM::CPU);
+
+  // Samples used for the median: enough for a robust estimation, bounded for large bounding boxes
+  const size_t maxSamples = 4096;
 
-  size_t idx = 0;
-  for (auto data : objects.object_list)
+  // With asynchronous detection the objects can come from an older frame than the depth map: their bounding boxes do
+  // not match the depth pixels of moving objects, so they are published as not valid
+  const bool sameFrame = objects.timestamp.data_ns == 0 || objects.timestamp.data_ns == depth.timestamp.data_ns;
+  if (!sameFrame)
   {
-    objMsg->objects[idx].label = sl::toString(data.label).c_str();
-    objMsg->objects[idx].sublabel = sl::toString(data.sublabel).c_str();
-    objMsg->objects[idx].label_id = data.raw_label;
-    objMsg->objects[idx].instance_id = data.id;
-    objMsg->objects[idx].confidence = data.confidence;
+    NODELET_DEBUG_STREAM_THROTTLE(5.0, "Objects depth not measured: objects and depth map from different frames ("
+                                           << 1e-6 * static_cast<double>(depth.timestamp - objects.timestamp)
+                                           << " msec)");
+  }
+
+  // Reuse the storage of the previous message, including the patches, when no subscriber holds it
+  if (!mObjDetDepthMsg || !mObjDetDepthMsg.unique())
+  {
+    mObjDetDepthMsg = boost::make_shared<zed_nodelets::ObjectsDepthStamped>();
+  }
+  zed_nodelets::ObjectsDepthStampedPtr msg = mObjDetDepthMsg;
+  msg->header.stamp = t;
+  msg->header.frame_id = mLeftCamFrameId;
+
+  const int objCount = static_cast<int>(objects.object_list.size());
+  msg->objects.resize(objCount);
+  if (mObjDetDepthScratch.size() < objects.object_list.size())
+  {
+    mObjDetDepthScratch.resize(objects.object_list.size());
+  }
+
+#pragma omp parallel for schedule(dynamic)
+  for (int idx = 0; idx < objCount; idx++)
+  {
+    const sl::ObjectData& data = objects.object_list[idx];
+    zed_nodelets::ObjectDepth& obj = msg->objects[idx];
 
-    memcpy(&(objMsg->objects[idx].position[0]), &(data.position[0]), 3 * sizeof(float));
-    memcpy(&(objMsg->objects[idx].position_covariance[0]), &(data.position_covariance[0]), 6 * sizeof(float));
-    memcpy(&(objMsg->objects[idx].velocity[0]), &(data.velocity[0]), 3 * sizeof(float));
+    obj.instance_id = data.id;
+    obj.label = sl_tools::objClassLabel(data.label);
+    obj.valid = false;
+    obj.median_depth = std::numeric_limits<float>::quiet_NaN();
+    obj.valid_samples = 0;
+    obj.centroid = geometry_msgs::Point();
+    obj.roi = sensor_msgs::RegionOfInterest();
+    obj.patch_stride = 0;
+    obj.patch.header.stamp = t;
+    obj.patch.header.frame_id = mDepthOptFrameId;
+    obj.patch.width = 0;
+    obj.patch.height = 0;
+    obj.patch.step = 0;
+    obj.patch.data.clear();
 
-    objMsg->objects[idx].tracking_available = mObjDetTracking;
-    objMsg->objects[idx].tracking_state = static_cast<int8_t>(data.tracking_state);
-    // NODELET_INFO_STREAM( "[" << idx << "] Tracking: " <<
-    // sl::toString(static_cast<sl::OBJECT_TRACKING_STATE>(data.tracking_state)));
-    objMsg->objects[idx].action_state = static_cast<int8_t>(data.action_state);
+    if (!sameFrame || data.bounding_box_2d.size() != 4)
+    {
+      continue;
+    }
 
-    if (data.bounding_box_2d.size() == 4)
+    // ----> Bounding box on the depth map
+    float minU = std::numeric_limits<float>::max(), minV = std::numeric_limits<float>::max();
+    float maxU = 0.0f, maxV = 0.0f;
+    for (const auto& corner : data.bounding_box_2d)
     {
-      memcpy(&(objMsg->objects[idx].bounding_box_2d.corners[0]), &(data.bounding_box_2d[0]), 8 * sizeof(unsigned int));
+      minU = std::min(minU, corner.x * boxScaleX);
+      minV = std::min(minV, corner.y * boxScaleY);
+      maxU = std::max(maxU, corner.x * boxScaleX);
+      maxV = std::max(maxV, corner.y * boxScaleY);
     }
-    if (data.bounding_box.size() == 8)
+    const int x0 = std::max(0, static_cast<int>(std::floor(minU)));
+    const int y0 = std::max(0, static_cast<int>(std::floor(minV)));
+    const int x1 = std::min(static_cast<int>(depth.getWidth()), static_cast<int>(std::ceil(maxU)) + 1);
+    const int y1 = std::min(static_cast<int>(depth.getHeight()), static_cast<int>(std::ceil(maxV)) + 1);
+    if (x1 <= x0 || y1 <= y0)
     {
-      memcpy(&(objMsg->objects[idx].bounding_box_3d.corners[0]), &(data.bounding_box[0]), 24 * sizeof(float));
+      continue;
     }
-
-    memcpy(&(objMsg->objects[idx].dimensions_3d[0]), &(data.dimensions[0]), 3 * sizeof(float));
-
-    // Body Detection is in a separate module in ZED SDK v4
-    objMsg->objects[idx].skeleton_available = false;
-
-    // at the end of the loop
-    idx++;
+    obj.roi.x_offset = x0;
+    obj.roi.y_offset = y0;
+    obj.roi.width = x1 - x0;
+    obj.roi.height = y1 - y0;
+    // <---- Bounding box on the depth map
+
+    // ----> Robust centroid
+    float median, u, v;
+    obj.valid_samples = sl_tools::depthRoiMedian(depth, x0, y0, x1 - x0, y1 - y0, mObjDetDepthInlierTol, maxSamples,
+                                                 mObjDetDepthScratch[idx], median, u, v);
+    if (obj.valid_samples > 0)
+    {
+      obj.valid = true;
+      obj.median_depth = median;
+      // Left camera frame: X forward, Y left, Z up
+      obj.centroid.x = median;
+      obj.centroid.y = -(u - cx) * median / fx;
+      obj.centroid.z = -(v - cy) * median / fy;
+    }
+    // <---- Robust centroid
+
+    // ----> Depth patch, subsampled to fit the maximum size
+    if (mObjDetDepthPatchSize > 0)
+    {
+      const int stride = std::max(1, (std::max(x1 - x0, y1 - y0) + mObjDetDepthPatchSize - 1) / mObjDetDepthPatchSize);
+      obj.patch_stride = stride;
+      obj.patch.width = (x1 - x0 + stride - 1) / stride;
+      obj.patch.height = (y1 - y0 + stride - 1) / stride;
+      obj.patch.encoding = sensor_msgs::image_encodings::TYPE_32FC1;
+      obj.patch.is_bigendian = false;
+      obj.patch.step = obj.patch.width * sizeof(float);
+      obj.patch.data.resize(obj.patch.step * obj.patch.height);
+
+      float* dst = reinterpret_cast<float*>(obj.patch.data.data());
+      for (int r = y0; r < y1; r += stride)
+      {
+        const float* row = reinterpret_cast<const float*>(reinterpret_cast<const uint8_t*>(depthData) + r * depthStep);
+        for (int c = x0; c < x1; c += stride)
+        {
+          *dst++ = row[c];
+        }
+      }
+    }
+    // <---- Depth patch, subsampled to fit the maximum size
   }
 
-  mPubObjDet.publish(objMsg);
+  mPubObjDetDepth.publish(msg);
 }
 
 void ZEDWrapperNodelet::clickedPtCallback(geometry_msgs::PointStampedConstPtr msg)
@@ -5275,13 +6928,17 @@ void ZEDWrapperNodelet::clickedPtCallback(geometry_msgs::PointStampedConstPtr ms
   // <---- Transform the point from `map` frame to `left_camera_optical_frame`
 
   // ----> Project the point into 2D image coordinates
-  sl::CalibrationParameters zedParam;
-  zedParam = mZed.getCameraInformation(mMatResol).camera_configuration.calibration_parameters;  // ok
+  CalibSnapshotPtr calib = getCalibSnapshot();
+  if (!calib)
+  {
+    NODELET_WARN("Camera calibration not yet available");
+    return;
+  }
 
-  float f_x = zedParam.left_cam.fx;
-  float f_y = zedParam.left_cam.fy;
-  float c_x = zedParam.left_cam.cx;
-  float c_y = zedParam.left_cam.cy;
+  float f_x = calib->fx;
+  float f_y = calib->fy;
+  float c_x = calib->cx;
+  float c_y = calib->cy;
 
   float out_scale_factor = static_cast<float>(mMatResol.width) / mCamWidth;
 
@@ -5317,7 +6974,6 @@ void ZEDWrapperNodelet::clickedPtCallback(geometry_msgs::PointStampedConstPtr ms
     // ----> Publish a blue sphere in the clicked point
     visualization_msgs::MarkerPtr pt_marker = boost::make_shared<visualization_msgs::Marker>();
     // Set the frame ID and timestamp.  See the TF tutorials for information on these.
-    static int hit_pt_id = 0;
     pt_marker->header.stamp = ts;
     // Set the marker action.  Options are ADD and DELETE
     pt_marker->action = visualization_msgs::Marker::ADD;
@@ -5326,7 +6982,7 @@ void ZEDWrapperNodelet::clickedPtCallback(geometry_msgs::PointStampedConstPtr ms
     // Set the namespace and id for this marker.  This serves to create a unique ID
     // Any marker sent with the same namespace and id will overwrite the old one
     pt_marker->ns = "plane_hit_points";
-    pt_marker->id = hit_pt_id++;
+    pt_marker->id = mHitPtMarkerId++;
     pt_marker->header.frame_id = mMapFrameId;
 
     // Set the marker type.
@@ -5359,7 +7015,6 @@ void ZEDWrapperNodelet::clickedPtCallback(geometry_msgs::PointStampedConstPtr ms
     // ----> Publish the plane as green mesh
     visualization_msgs::MarkerPtr plane_marker = boost::make_shared<visualization_msgs::Marker>();
     // Set the frame ID and timestamp.  See the TF tutorials for information on these.
-    static int plane_mesh_id = 0;
     plane_marker->header.stamp = ts;
     // Set the marker action.  Options are ADD and DELETE
     plane_marker->action = visualization_msgs::Marker::ADD;
@@ -5368,7 +7023,7 @@ void ZEDWrapperNodelet::clickedPtCallback(geometry_msgs::PointStampedConstPtr ms
     // Set the namespace and id for this marker.  This serves to create a unique ID
     // Any marker sent with the same namespace and id will overwrite the old one
     plane_marker->ns = "plane_meshes";
-    plane_marker->id = plane_mesh_id++;
+    plane_marker->id = mPlaneMeshMarkerId++;
     plane_marker->header.frame_id = mLeftCamFrameId;
 
     // Set the marker type.
@@ -5603,6 +7258,11 @@ void ZEDWrapperNodelet::processOdometry()
     publishOdom(mOdom2BaseTransf, deltaOdom, mFrameTimestamp);
     mPosTrackingReady = true;
 
+    if (mImuOdomEnabled)
+    {
+      updateImuOdomAnchor(mOdom2BaseTransf, mFrameTimestamp);
+    }
+
     mOdomMutex.unlock();  //
   }
 }
@@ -5714,29 +7374,16 @@ void ZEDWrapperNodelet::publishTFs(ros::Time t)
   }
 
   // Publish pose tf only if enabled
-  if (mDepthMode != sl::DEPTH_MODE::NONE && mPublishTF)
+  if (mDepthMode == sl::DEPTH_MODE::NONE || !mPublishTF)
   {
-    publishOdomTF(t);  // publish the base Frame in odometry frame
-
-    if (mPublishMapTF)
-    {
-      publishPoseTF(t);  // publish the odometry Frame in map frame
-    }
+    return;
   }
-}
-
-void ZEDWrapperNodelet::publishOdomTF(ros::Time t)
-{
-  // NODELET_DEBUG("publishOdomTF");
 
   // ----> Avoid duplicated TF publishing
-  static ros::Time last_stamp;
-
-  if (t == last_stamp)
+  if (!mTfStamp.update(t.toNSec()))
   {
     return;
   }
-  last_stamp = t;
   // <---- Avoid duplicated TF publishing
 
   if (!mSensor2BaseTransfValid)
@@ -5754,76 +7401,42 @@ void ZEDWrapperNodelet::publishOdomTF(ros::Time t)
     getCamera2BaseTransform();
   }
 
-  geometry_msgs::TransformStamped transformStamped;
-  transformStamped.header.stamp = t;
-
-  // NODELET_DEBUG_STREAM(get_logger(), "Odom TS: " << transformStamped.header.stamp);
-
-  transformStamped.header.frame_id = mOdomFrameId;
-  transformStamped.child_frame_id = mBaseFrameId;
-  // conversion from Tranform to message
-  mOdomMutex.lock();  //
-  tf2::Vector3 translation = mOdom2BaseTransf.getOrigin();
-  tf2::Quaternion quat = mOdom2BaseTransf.getRotation();
-  mOdomMutex.unlock();  //
-  transformStamped.transform.translation.x = translation.x();
-  transformStamped.transform.translation.y = translation.y();
-  transformStamped.transform.translation.z = translation.z();
-  transformStamped.transform.rotation.x = quat.x();
-  transformStamped.transform.rotation.y = quat.y();
-  transformStamped.transform.rotation.z = quat.z();
-  transformStamped.transform.rotation.w = quat.w();
-
-  // Publish transformation
-  mTfBroadcaster.sendTransform(transformStamped);
-}
-
-void ZEDWrapperNodelet::publishPoseTF(ros::Time t)
-{
-  // NODELET_DEBUG("publishPoseTF");
+  // The dynamic transforms of the frame are sent as a single `tf2_msgs/TFMessage`.
+  // The vector is a member: after the first frame resizing it does not allocate.
+  const size_t tfCount = mPublishMapTF ? 2 : 1;
+  mTfBatch.resize(tfCount);
 
-  // ----> Avoid duplicated TF publishing
-  static ros::Time last_stamp;
-
-  if (t == last_stamp)
-  {
-    return;
-  }
-  last_stamp = t;
-  // <---- Avoid duplicated TF publishing
+  PoseSnapshotPtr poseSnap = getPoseSnapshot();
 
-  if (!mSensor2BaseTransfValid)
-  {
-    getSens2BaseTransform();
-  }
+  // odom -> base_link
+  fillTransformStamped(mTfBatch[0], poseSnap->odom2base, mOdomFrameId, mBaseFrameId, t);
 
-  if (!mSensor2CameraTransfValid)
+  // map -> odom
+  if (mPublishMapTF)
   {
-    getSens2CameraTransform();
+    fillTransformStamped(mTfBatch[1], poseSnap->map2odom, mMapFrameId, mOdomFrameId, t);
   }
 
-  if (!mCamera2BaseTransfValid)
-  {
-    getCamera2BaseTransform();
-  }
+  // Publish transformations
+  mTfBroadcaster.sendTransform(mTfBatch);
+}
 
-  geometry_msgs::TransformStamped transformStamped;
-  transformStamped.header.stamp = t;
-  transformStamped.header.frame_id = mMapFrameId;
-  transformStamped.child_frame_id = mOdomFrameId;
+void ZEDWrapperNodelet::fillTransformStamped(geometry_msgs::TransformStamped& msg, const tf2::Transform& transf,
+                                             const std::string& frameId, const std::string& childFrameId, ros::Time t)
+{
+  msg.header.stamp = t;
+  msg.header.frame_id = frameId;
+  msg.child_frame_id = childFrameId;
   // conversion from Tranform to message
-  tf2::Vector3 translation = mMap2OdomTransf.getOrigin();
-  tf2::Quaternion quat = mMap2OdomTransf.getRotation();
-  transformStamped.transform.translation.x = translation.x();
-  transformStamped.transform.translation.y = translation.y();
-  transformStamped.transform.translation.z = translation.z();
-  transformStamped.transform.rotation.x = quat.x();
-  transformStamped.transform.rotation.y = quat.y();
-  transformStamped.transform.rotation.z = quat.z();
-  transformStamped.transform.rotation.w = quat.w();
-
-  // Publish transformation
-  mTfBroadcaster.sendTransform(transformStamped);
+  const tf2::Vector3& translation = transf.getOrigin();
+  tf2::Quaternion quat = transf.getRotation();
+  msg.transform.translation.x = translation.x();
+  msg.transform.translation.y = translation.y();
+  msg.transform.translation.z = translation.z();
+  msg.transform.rotation.x = quat.x();
+  msg.transform.rotation.y = quat.y();
+  msg.transform.rotation.z = quat.z();
+  msg.transform.rotation.w = quat.w();
 }
 
 }  // namespace zed_nodelets
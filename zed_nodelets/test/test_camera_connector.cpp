@@ -0,0 +1,289 @@
+///////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2023, STEREOLABS.
+//
+// All rights reserved.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+///////////////////////////////////////////////////////////////////////////
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "sl_camera_connector.h"
+
+using sl_tools::CameraConnector;
+using namespace std::chrono_literals;
+
+namespace
+{
+// Synthetic camera: fails the first `failures` openings after each disconnection
+class FakeCamera
+{
+public:
+  sl::ERROR_CODE open()
+  {
+    std::lock_guard<std::mutex> lock(mMutex);
+    mAttempts.push_back(CameraConnector::Clock::now());
+    if (mFailures > 0)
+    {
+      mFailures--;
+      return sl::ERROR_CODE::CAMERA_NOT_DETECTED;
+    }
+    mOpened = true;
+    return sl::ERROR_CODE::SUCCESS;
+  }
+
+  void close()
+  {
+    std::lock_guard<std::mutex> lock(mMutex);
+    mCloses++;
+    mOpened = false;
+  }
+
+  void disconnect(int failures)
+  {
+    std::lock_guard<std::mutex> lock(mMutex);
+    mOpened = false;
+    mFailures = failures;
+  }
+
+  std::vector<CameraConnector::Clock::time_point> attempts()
+  {
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mAttempts;
+  }
+
+  int closes()
+  {
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mCloses;
+  }
+
+  bool opened()
+  {
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mOpened;
+  }
+
+  CameraConnector::OpenFunc openFunc()
+  {
+    return [this] { return open(); };
+  }
+
+  CameraConnector::CloseFunc closeFunc()
+  {
+    return [this] { close(); };
+  }
+
+private:
+  std::mutex mMutex;
+  std::vector<CameraConnector::Clock::time_point> mAttempts;
+  int mFailures = 0;
+  int mCloses = 0;
+  bool mOpened = false;
+};
+
+CameraConnector::Params testParams()
+{
+  CameraConnector::Params params;
+  params.minDelay = 0.02;
+  params.maxDelay = 0.08;
+  params.backoffFactor = 2.0;
+  return params;
+}
+
+double seconds(CameraConnector::Clock::duration d)
+{
+  return std::chrono::duration<double>(d).count();
+}
+}  // namespace
+
+TEST(CameraConnector, ConnectsAtFirstAttempt)
+{
+  FakeCamera camera;
+  CameraConnector connector(camera.openFunc(), camera.closeFunc(), testParams());
+  EXPECT_EQ(connector.getState(), CameraConnector::State::DISCONNECTED);
+
+  connector.requestConnection();
+  ASSERT_TRUE(connector.waitConnected(2s));
+
+  EXPECT_EQ(connector.getState(), CameraConnector::State::CONNECTED);
+  EXPECT_TRUE(camera.opened());
+  EXPECT_EQ(camera.closes(), 1);  // The camera is closed before the first attempt
+
+  CameraConnector::Stats stats = connector.getStats();
+  EXPECT_EQ(stats.connections, 1u);
+  EXPECT_EQ(stats.attempts, 1u);
+  EXPECT_EQ(stats.lastError, sl::ERROR_CODE::SUCCESS);
+}
+
+TEST(CameraConnector, BackoffSequence)
+{
+  FakeCamera camera;
+  camera.disconnect(5);
+  CameraConnector connector(camera.openFunc(), camera.closeFunc(), testParams());
+
+  connector.requestConnection();
+  ASSERT_TRUE(connector.waitConnected(5s));
+
+  std::vector<CameraConnector::Clock::time_point> attempts = camera.attempts();
+  ASSERT_EQ(attempts.size(), 6u);
+  EXPECT_EQ(connector.getStats().attempts, 6u);
+
+  // Doubled after each failure up to the maximum delay
+  const double expected[] = { 0.02, 0.04, 0.08, 0.08, 0.08 };
+  for (size_t i = 1; i < attempts.size(); i++)
+  {
+    double delay = seconds(attempts[i] - attempts[i - 1]);
+    EXPECT_GE(delay, expected[i - 1] * 0.95) << "attempt " << i;
+    EXPECT_LT(delay, expected[i - 1] + 0.5) << "attempt " << i;
+  }
+}
+
+TEST(CameraConnector, ReconnectAfterDisconnection)
+{
+  FakeCamera camera;
+  CameraConnector connector(camera.openFunc(), camera.closeFunc(), testParams());
+
+  connector.requestConnection();
+  ASSERT_TRUE(connector.waitConnected(2s));
+
+  // The camera is unplugged and comes back after a few attempts
+  camera.disconnect(2);
+  connector.requestConnection();
+  ASSERT_TRUE(connector.waitConnected(5s));
+
+  EXPECT_TRUE(camera.opened());
+  EXPECT_EQ(camera.closes(), 2);
+
+  CameraConnector::Stats stats = connector.getStats();
+  EXPECT_EQ(stats.connections, 2u);
+  EXPECT_EQ(stats.attempts, 3u);
+  EXPECT_GE(stats.lastConnect_sec, 0.02 + 0.04);
+  EXPECT_DOUBLE_EQ(stats.maxConnect_sec, stats.lastConnect_sec);
+}
+
+TEST(CameraConnector, RequestIgnoredWhileConnecting)
+{
+  FakeCamera camera;
+  camera.disconnect(3);
+  CameraConnector connector(camera.openFunc(), camera.closeFunc(), testParams());
+
+  connector.requestConnection();
+  while (camera.attempts().empty())
+  {
+    std::this_thread::sleep_for(1ms);
+  }
+  connector.requestConnection();
+  ASSERT_TRUE(connector.waitConnected(5s));
+
+  EXPECT_EQ(camera.closes(), 1);
+  EXPECT_EQ(connector.getStats().connections, 1u);
+}
+
+TEST(CameraConnector, WaitTimeout)
+{
+  FakeCamera camera;
+  camera.disconnect(1000);
+  CameraConnector connector(camera.openFunc(), camera.closeFunc(), testParams());
+
+  connector.requestConnection();
+
+  auto start = CameraConnector::Clock::now();
+  EXPECT_FALSE(connector.waitConnected(100ms));
+  EXPECT_GE(seconds(CameraConnector::Clock::now() - start), 0.1);
+  EXPECT_EQ(connector.getState(), CameraConnector::State::CONNECTING);
+  EXPECT_EQ(connector.getStats().lastError, sl::ERROR_CODE::CAMERA_NOT_DETECTED);
+}
+
+TEST(CameraConnector, StopCancelsWait)
+{
+  FakeCamera camera;
+  camera.disconnect(1000);
+  CameraConnector connector(camera.openFunc(), camera.closeFunc(), testParams());
+
+  connector.requestConnection();
+
+  std::atomic<bool> connected(true);
+  std::thread waiter([&] { connected = connector.waitConnected(30s); });
+
+  std::this_thread::sleep_for(50ms);
+  auto start = CameraConnector::Clock::now();
+  connector.stop();
+  waiter.join();
+
+  EXPECT_FALSE(connected);
+  EXPECT_LT(seconds(CameraConnector::Clock::now() - start), 1.0);
+  EXPECT_NE(connector.getState(), CameraConnector::State::CONNECTED);
+
+  // No more attempts after stop
+  size_t attempts = camera.attempts().size();
+  std::this_thread::sleep_for(200ms);
+  EXPECT_EQ(camera.attempts().size(), attempts);
+}
+
+TEST(GrabErrorAction, LiveCamera)
+{
+  using sl_tools::GrabErrorAction;
+  const double grace = 0.5;
+
+  // Transient errors are retried, an unplugged camera is reopened after the grace time
+  EXPECT_EQ(sl_tools::grabErrorAction(sl::ERROR_CODE::CAMERA_NOT_DETECTED, false, false, 0.1, grace),
+            GrabErrorAction::RETRY);
+  EXPECT_EQ(sl_tools::grabErrorAction(sl::ERROR_CODE::CAMERA_NOT_DETECTED, false, false, 0.6, grace),
+            GrabErrorAction::RECONNECT);
+  EXPECT_EQ(sl_tools::grabErrorAction(sl::ERROR_CODE::FAILURE, false, false, 0.6, grace), GrabErrorAction::RECONNECT);
+  EXPECT_EQ(sl_tools::grabErrorAction(sl::ERROR_CODE::CORRUPTED_FRAME, false, false, 0.6, grace),
+            GrabErrorAction::RECONNECT);
+
+  // The SDK is given time to reboot the camera by itself
+  EXPECT_EQ(sl_tools::grabErrorAction(sl::ERROR_CODE::CAMERA_REBOOTING, false, false, 0.6, grace),
+            GrabErrorAction::RETRY);
+  EXPECT_EQ(sl_tools::grabErrorAction(sl::ERROR_CODE::CAMERA_REBOOTING, false, false,
+                                      sl_tools::REBOOT_GRACE_SEC + 0.1, grace),
+            GrabErrorAction::RECONNECT);
+  EXPECT_EQ(sl_tools::grabErrorAction(sl::ERROR_CODE::CAMERA_REBOOTING, false, false, 10.0, 20.0),
+            GrabErrorAction::RETRY);
+}
+
+TEST(GrabErrorAction, Svo)
+{
+  using sl_tools::GrabErrorAction;
+
+  EXPECT_EQ(sl_tools::grabErrorAction(sl::ERROR_CODE::END_OF_SVOFILE_REACHED, true, false, 0.0, 0.5),
+            GrabErrorAction::STOP);
+  // Never reopened
+  EXPECT_EQ(sl_tools::grabErrorAction(sl::ERROR_CODE::CAMERA_NOT_DETECTED, true, false, 100.0, 0.5),
+            GrabErrorAction::RETRY);
+}
+
+TEST(GrabErrorAction, RemoteStream)
+{
+  using sl_tools::GrabErrorAction;
+
+  EXPECT_EQ(sl_tools::grabErrorAction(sl::ERROR_CODE::FAILURE, false, true, 0.1, 0.5), GrabErrorAction::RETRY);
+  EXPECT_EQ(sl_tools::grabErrorAction(sl::ERROR_CODE::FAILURE, false, true, 0.6, 0.5), GrabErrorAction::STOP);
+}
+
+int main(int argc, char** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
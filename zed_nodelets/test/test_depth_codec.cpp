@@ -0,0 +1,326 @@
+///////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2023, STEREOLABS.
+//
+// All rights reserved.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+///////////////////////////////////////////////////////////////////////////
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "zed_nodelets/sl_depth_codec.h"
+
+namespace dc = sl_tools::depth_codec;
+
+namespace
+{
+// Depth map with invalid holes and smooth valid areas, like a real camera depth
+std::vector<uint16_t> makeDepth(int width, int height, unsigned seed)
+{
+  std::mt19937 rng(seed);
+  std::uniform_int_distribution<int> noise(-20, 20);
+  std::vector<uint16_t> depth(static_cast<size_t>(width) * height);
+  for (int r = 0; r < height; r++)
+  {
+    for (int c = 0; c < width; c++)
+    {
+      int v = 1000 + 10 * r + 3 * c + noise(rng);
+      bool hole = ((r / 7 + c / 11) % 5) == 0;
+      depth[static_cast<size_t>(r) * width + c] = hole ? 0 : static_cast<uint16_t>(v);
+    }
+  }
+  depth[0] = 0xFFFF;  // Full range
+  depth[1] = 1;
+  return depth;
+}
+
+// Depth map of a synthetic indoor scene seen by a camera 1 m above the floor: a floor plane, a back wall at 6 m, a box
+// and a sphere, with depth noise growing with the distance, invalid pixels on the occlusion borders and past 10 m
+std::vector<uint16_t> makeScene(int width, int height, unsigned seed)
+{
+  std::mt19937 rng(seed);
+  std::normal_distribution<float> noise(0.0f, 1.0f);
+  const float f = 0.5f * width;  // Focal length [pixel], 90 deg horizontal field of view
+  const float cx = 0.5f * width;
+  const float cy = 0.5f * height;
+
+  std::vector<uint16_t> depth(static_cast<size_t>(width) * height);
+  for (int r = 0; r < height; r++)
+  {
+    float y = (r - cy) / f;  // Ray direction, z = 1
+    for (int c = 0; c < width; c++)
+    {
+      float x = (c - cx) / f;
+
+      float z = 6.0f;  // Back wall
+      if (y > 0.0f)
+      {
+        z = std::min(z, 1.0f / y);  // Floor
+      }
+      if (x > -0.6f && x < -0.2f && y > -0.1f && y < 0.25f)
+      {
+        z = std::min(z, 3.0f + 0.5f * x);  // Slanted box face
+      }
+      float dx = x - 0.25f, dy = y - 0.05f;
+      float d2 = dx * dx + dy * dy;
+      bool border = false;
+      if (d2 < 0.04f)
+      {
+        z = std::min(z, 2.0f - 0.5f * std::sqrt(0.04f - d2) / 0.2f);  // Sphere
+        border = d2 > 0.036f;
+      }
+
+      float z_mm = z * 1000.0f + noise(rng) * z * z;  // Stereo noise grows with the squared distance
+      bool invalid = border || z > 10.0f || (c % 97 == 0 && r % 5 == 0);
+      depth[static_cast<size_t>(r) * width + c] = invalid ? 0 : static_cast<uint16_t>(z_mm);
+    }
+  }
+  return depth;
+}
+
+std::vector<uint8_t> encode(const std::vector<uint16_t>& depth, int width, int height, int maxError)
+{
+  std::vector<uint8_t> stream;
+  EXPECT_TRUE(dc::compress(depth.data(), width, height, 0, maxError, stream));
+  return stream;
+}
+
+void putU32(std::vector<uint8_t>& stream, size_t offset, uint32_t value)
+{
+  for (int i = 0; i < 4; i++)
+  {
+    stream[offset + i] = static_cast<uint8_t>(value >> (8 * i));
+  }
+}
+}  // namespace
+
+TEST(DepthCodec, LosslessRoundTrip)
+{
+  const int width = 173;  // Not a multiple of the tile rows or of the word size
+  const int height = 97;
+  std::vector<uint16_t> depth = makeDepth(width, height, 1);
+
+  std::vector<uint8_t> stream = encode(depth, width, height, 0);
+  EXPECT_LT(stream.size(), depth.size() * sizeof(uint16_t));
+
+  std::vector<uint16_t> decoded;
+  int w = 0, h = 0;
+  ASSERT_TRUE(dc::decompress(stream.data(), stream.size(), decoded, w, h));
+  EXPECT_EQ(w, width);
+  EXPECT_EQ(h, height);
+  EXPECT_EQ(decoded, depth);
+}
+
+TEST(DepthCodec, RowStep)
+{
+  const int width = 64;
+  const int height = 40;
+  const int stride = width + 13;
+  std::vector<uint16_t> depth = makeDepth(width, height, 2);
+  std::vector<uint16_t> padded(static_cast<size_t>(stride) * height, 0xABCD);
+  for (int r = 0; r < height; r++)
+  {
+    memcpy(&padded[static_cast<size_t>(r) * stride], &depth[static_cast<size_t>(r) * width], width * sizeof(uint16_t));
+  }
+
+  std::vector<uint8_t> stream;
+  ASSERT_TRUE(dc::compress(padded.data(), width, height, stride * sizeof(uint16_t), 0, stream));
+
+  std::vector<uint16_t> decoded;
+  int w = 0, h = 0;
+  ASSERT_TRUE(dc::decompress(stream.data(), stream.size(), decoded, w, h));
+  EXPECT_EQ(decoded, depth);
+}
+
+TEST(DepthCodec, BoundedErrorRoundTrip)
+{
+  const int width = 128;
+  const int height = 75;
+  std::vector<uint16_t> depth = makeDepth(width, height, 3);
+
+  for (int maxError : { 1, 5, 50 })
+  {
+    std::vector<uint8_t> stream = encode(depth, width, height, maxError);
+
+    std::vector<uint16_t> decoded;
+    int w = 0, h = 0;
+    ASSERT_TRUE(dc::decompress(stream.data(), stream.size(), decoded, w, h));
+    ASSERT_EQ(decoded.size(), depth.size());
+    for (size_t i = 0; i < depth.size(); i++)
+    {
+      if (depth[i] == 0)
+      {
+        ASSERT_EQ(decoded[i], 0) << "pixel " << i;
+      }
+      else
+      {
+        ASSERT_NE(decoded[i], 0) << "pixel " << i;
+        ASSERT_LE(std::abs(static_cast<int>(decoded[i]) - static_cast<int>(depth[i])), maxError) << "pixel " << i;
+      }
+    }
+  }
+}
+
+TEST(DepthCodec, InvalidParameters)
+{
+  std::vector<uint16_t> depth(16, 1000);
+  std::vector<uint8_t> stream;
+  EXPECT_FALSE(dc::compress(nullptr, 4, 4, 0, 0, stream));
+  EXPECT_FALSE(dc::compress(depth.data(), 0, 4, 0, 0, stream));
+  EXPECT_FALSE(dc::compress(depth.data(), 4, 4, 0, -1, stream));
+  EXPECT_FALSE(dc::compress(depth.data(), 4, 4, 0, 0x8000, stream));
+  EXPECT_FALSE(dc::compress(depth.data(), 4, 4, 0, 0, stream, 0));
+}
+
+TEST(DepthCodec, TruncatedStreamRejected)
+{
+  const int width = 40;
+  const int height = 70;
+  std::vector<uint8_t> stream = encode(makeDepth(width, height, 4), width, height, 0);
+
+  std::vector<uint16_t> decoded;
+  int w = 0, h = 0;
+  for (size_t size = 0; size < stream.size(); size++)
+  {
+    // Copied to let the memory checkers detect reads past the end
+    std::vector<uint8_t> truncated(stream.begin(), stream.begin() + size);
+    EXPECT_FALSE(dc::decompress(truncated.data(), truncated.size(), decoded, w, h)) << "size " << size;
+  }
+}
+
+TEST(DepthCodec, UntrustedHeaderRejected)
+{
+  const int width = 32;
+  const int height = 32;
+  const std::vector<uint8_t> stream = encode(makeDepth(width, height, 5), width, height, 0);
+
+  std::vector<uint16_t> decoded;
+  int w = 0, h = 0;
+
+  // Huge image: rejected before allocating
+  std::vector<uint8_t> corrupted = stream;
+  putU32(corrupted, 4, 0xFFFF);
+  putU32(corrupted, 8, 0xFFFF);
+  putU32(corrupted, 16, 0xFFFF);
+  putU32(corrupted, 20, 1);
+  EXPECT_FALSE(dc::decompress(corrupted.data(), corrupted.size(), decoded, w, h));
+
+  // Tile count not matching the height
+  corrupted = stream;
+  putU32(corrupted, 20, 1000);
+  EXPECT_FALSE(dc::decompress(corrupted.data(), corrupted.size(), decoded, w, h));
+
+  // Tile size past the end of the stream
+  corrupted = stream;
+  putU32(corrupted, 24, 0xFFFFFFF0);
+  EXPECT_FALSE(dc::decompress(corrupted.data(), corrupted.size(), decoded, w, h));
+
+  // Bad magic
+  corrupted = stream;
+  corrupted[0] = 'X';
+  EXPECT_FALSE(dc::decompress(corrupted.data(), corrupted.size(), decoded, w, h));
+}
+
+TEST(DepthCodec, CorruptedPayloadNeverCrashes)
+{
+  const int width = 48;
+  const int height = 48;
+  const std::vector<uint8_t> stream = encode(makeDepth(width, height, 6), width, height, 0);
+  const size_t payloadStart = 6 * 4 + 2 * 4;  // Header and tile sizes
+
+  std::mt19937 rng(7);
+  std::uniform_int_distribution<size_t> pos(payloadStart, stream.size() - 1);
+  std::uniform_int_distribution<int> byte(0, 255);
+
+  std::vector<uint16_t> decoded;
+  int w = 0, h = 0;
+  for (int i = 0; i < 500; i++)
+  {
+    std::vector<uint8_t> corrupted = stream;
+    for (int k = 0; k < 4; k++)
+    {
+      corrupted[pos(rng)] = static_cast<uint8_t>(byte(rng));
+    }
+    // Either rejected or decoded to an image of the declared size
+    if (dc::decompress(corrupted.data(), corrupted.size(), decoded, w, h))
+    {
+      EXPECT_EQ(decoded.size(), static_cast<size_t>(width) * height);
+    }
+  }
+}
+
+TEST(DepthCodec, Throughput)
+{
+  const int width = 1920;
+  const int height = 1080;
+  const int iterations = 20;
+  const double raw_mb = static_cast<double>(width) * height * sizeof(uint16_t) / (1024.0 * 1024.0);
+
+  std::vector<uint16_t> depth = makeScene(width, height, 8);
+
+  for (int maxError : { 0, 10 })
+  {
+    std::vector<uint8_t> stream;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++)
+    {
+      ASSERT_TRUE(dc::compress(depth.data(), width, height, 0, maxError, stream, 32));
+    }
+    double enc_msec =
+        std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / iterations;
+
+    std::vector<uint16_t> decoded;
+    int w = 0, h = 0;
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++)
+    {
+      ASSERT_TRUE(dc::decompress(stream.data(), stream.size(), decoded, w, h));
+    }
+    double dec_msec =
+        std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / iterations;
+
+    if (maxError == 0)
+    {
+      EXPECT_EQ(decoded, depth);
+    }
+
+    double ratio = raw_mb * 1024.0 * 1024.0 / stream.size();
+    EXPECT_GT(ratio, 1.5);
+
+    std::string name = "HD1080_err" + std::to_string(maxError);
+    RecordProperty(name + "_ratio", std::to_string(ratio));
+    RecordProperty(name + "_encode_MBps", std::to_string(raw_mb / enc_msec * 1000.0));
+    RecordProperty(name + "_decode_MBps", std::to_string(raw_mb / dec_msec * 1000.0));
+    std::cout << "HD1080 max error " << maxError << " mm: ratio " << ratio << " - encode " << enc_msec << " msec ("
+              << raw_mb / enc_msec * 1000.0 << " MB/s) - decode " << dec_msec << " msec ("
+              << raw_mb / dec_msec * 1000.0 << " MB/s)" << std::endl;
+  }
+}
+
+int main(int argc, char** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,160 @@
+///////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2023, STEREOLABS.
+//
+// All rights reserved.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+///////////////////////////////////////////////////////////////////////////
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "sl_tools.h"
+
+namespace
+{
+// Scalar reference of the OpenNI conversion
+uint16_t referenceMm(float depth)
+{
+  if (!std::isfinite(depth) || depth <= 0.0f)
+  {
+    return 0;
+  }
+  return static_cast<uint16_t>(std::min(std::lround(depth * 1000.0), 65535l));
+}
+
+uint16_t convert(float depth)
+{
+  uint16_t mm = 0xBEEF;
+  sl_tools::depthToU16mm(&depth, sizeof(float), &mm, sizeof(uint16_t), 1, 1);
+  return mm;
+}
+}  // namespace
+
+TEST(DepthToU16mm, InvalidValues)
+{
+  EXPECT_EQ(convert(std::numeric_limits<float>::quiet_NaN()), 0);
+  EXPECT_EQ(convert(-std::numeric_limits<float>::quiet_NaN()), 0);
+  EXPECT_EQ(convert(std::numeric_limits<float>::infinity()), 0);
+  EXPECT_EQ(convert(-std::numeric_limits<float>::infinity()), 0);
+  EXPECT_EQ(convert(-1.0f), 0);
+  EXPECT_EQ(convert(-0.0f), 0);
+  EXPECT_EQ(convert(0.0f), 0);
+  EXPECT_EQ(convert(-std::numeric_limits<float>::max()), 0);
+}
+
+TEST(DepthToU16mm, Range)
+{
+  EXPECT_EQ(convert(std::numeric_limits<float>::denorm_min()), 0);
+  EXPECT_EQ(convert(0.0004f), 0);
+  EXPECT_EQ(convert(0.0006f), 1);
+  EXPECT_EQ(convert(1.0f), 1000);
+  EXPECT_EQ(convert(1.2344f), 1234);
+  EXPECT_EQ(convert(1.2346f), 1235);
+  EXPECT_EQ(convert(65.534f), 65534);
+  EXPECT_EQ(convert(65.535f), 65535);
+
+  // Saturation
+  EXPECT_EQ(convert(65.6f), 65535);
+  EXPECT_EQ(convert(1000.0f), 65535);
+  EXPECT_EQ(convert(std::numeric_limits<float>::max()), 65535);
+}
+
+TEST(DepthToU16mm, MatchesReference)
+{
+  const int width = 67;  // Not a multiple of the vector size
+  const int height = 31;
+  const int srcStride = width + 5;
+  const int dstStride = width + 3;
+
+  std::mt19937 rng(42);
+  std::uniform_real_distribution<float> range(-1.0f, 70.0f);
+  std::uniform_int_distribution<int> special(0, 9);
+
+  std::vector<float> src(static_cast<size_t>(srcStride) * height);
+  for (float& v : src)
+  {
+    switch (special(rng))
+    {
+      case 0:
+        v = std::numeric_limits<float>::quiet_NaN();
+        break;
+      case 1:
+        v = std::numeric_limits<float>::infinity();
+        break;
+      default:
+        v = range(rng);
+    }
+  }
+
+  const uint16_t padding = 0xBEEF;
+  std::vector<uint16_t> dst(static_cast<size_t>(dstStride) * height, padding);
+  sl_tools::depthToU16mm(src.data(), srcStride * sizeof(float), dst.data(), dstStride * sizeof(uint16_t), width,
+                         height);
+
+  for (int r = 0; r < height; r++)
+  {
+    for (int c = 0; c < dstStride; c++)
+    {
+      uint16_t mm = dst[static_cast<size_t>(r) * dstStride + c];
+      if (c >= width)
+      {
+        ASSERT_EQ(mm, padding) << "row padding overwritten at " << r << "," << c;
+        continue;
+      }
+      float depth = src[static_cast<size_t>(r) * srcStride + c];
+      // Ties can differ by 1 mm because of the float precision
+      ASSERT_LE(std::abs(static_cast<int>(mm) - static_cast<int>(referenceMm(depth))), 1)
+          << "depth " << depth << " at " << r << "," << c;
+    }
+  }
+}
+
+TEST(DepthToU16mm, Throughput)
+{
+  const int width = 1920;
+  const int height = 1080;
+  const int iterations = 20;
+
+  std::vector<float> src(static_cast<size_t>(width) * height, 2.5f);
+  std::vector<uint16_t> dst(src.size());
+
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < iterations; i++)
+  {
+    sl_tools::depthToU16mm(src.data(), width * sizeof(float), dst.data(), width * sizeof(uint16_t), width, height);
+  }
+  double elapsed_msec =
+      std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / iterations;
+
+  EXPECT_EQ(dst.back(), 2500);
+  RecordProperty("HD1080_msec", std::to_string(elapsed_msec));
+  std::cout << "HD1080 conversion: " << elapsed_msec << " msec" << std::endl;
+}
+
+int main(int argc, char** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,128 @@
+///////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2023, STEREOLABS.
+//
+// All rights reserved.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+///////////////////////////////////////////////////////////////////////////
+
+#include <gtest/gtest.h>
+
+#include <boost/make_shared.hpp>
+#include <chrono>
+#include <iostream>
+#include <string>
+
+#include <sensor_msgs/image_encodings.h>
+#include <stereo_msgs/DisparityImage.h>
+
+#include <sl/Camera.hpp>
+
+#include "sl_tools.h"
+
+namespace
+{
+// HD1080 disparity map with a horizontal gradient
+sl::Mat makeDisparity(int width, int height)
+{
+  sl::Mat disparity(width, height, sl::MAT_TYPE::F32_C1, sl::MEM::CPU);
+  for (int r = 0; r < height; r++)
+  {
+    for (int c = 0; c < width; c++)
+    {
+      disparity.setValue<sl::float1>(c, r, -1.0f - 0.01f * c, sl::MEM::CPU);
+    }
+  }
+  return disparity;
+}
+
+// Same fill as ZEDWrapperNodelet::publishDisparity
+void fillDisparity(stereo_msgs::DisparityImage& msg, const sl::Mat& disparity, const ros::Time& t)
+{
+  sl_tools::imageToROSmsg(msg.image, disparity, "zed_left_camera_optical_frame", t);
+  msg.header = msg.image.header;
+  msg.f = 1000.0f;
+  msg.T = -0.12f;
+  msg.min_disparity = -120.0f;
+  msg.max_disparity = -4.0f;
+}
+}  // namespace
+
+TEST(ImageToROSmsg, DisparityFill)
+{
+  const int width = 64;
+  const int height = 48;
+  sl::Mat disparity = makeDisparity(width, height);
+
+  stereo_msgs::DisparityImage msg;
+  fillDisparity(msg, disparity, ros::Time(10.0));
+
+  EXPECT_EQ(msg.header.stamp, ros::Time(10.0));
+  EXPECT_EQ(msg.image.header.frame_id, msg.header.frame_id);
+  EXPECT_EQ(msg.image.width, static_cast<uint32_t>(width));
+  EXPECT_EQ(msg.image.height, static_cast<uint32_t>(height));
+  EXPECT_EQ(msg.image.encoding, sensor_msgs::image_encodings::TYPE_32FC1);
+  ASSERT_EQ(msg.image.data.size(), static_cast<size_t>(msg.image.step) * height);
+
+  const float* last =
+      reinterpret_cast<const float*>(&msg.image.data[static_cast<size_t>(height - 1) * msg.image.step]) + width - 1;
+  EXPECT_FLOAT_EQ(*last, -1.0f - 0.01f * (width - 1));
+}
+
+TEST(ImageToROSmsg, DisparityThroughput)
+{
+  const int width = 1920;
+  const int height = 1080;
+  const int iterations = 50;
+
+  sl::Mat disparity = makeDisparity(width, height);
+
+  // Pooled message, as reused by the nodelet when no intra-process subscriber holds it
+  stereo_msgs::DisparityImagePtr pooled = boost::make_shared<stereo_msgs::DisparityImage>();
+  fillDisparity(*pooled, disparity, ros::Time(1.0));
+  const uint8_t* buffer = pooled->image.data.data();
+
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < iterations; i++)
+  {
+    fillDisparity(*pooled, disparity, ros::Time(1.0 + i));
+  }
+  double pooled_msec =
+      std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / iterations;
+
+  // The data buffer of the pooled message is never reallocated
+  EXPECT_EQ(pooled->image.data.data(), buffer);
+
+  // Reference: a new message for each frame
+  start = std::chrono::steady_clock::now();
+  for (int i = 0; i < iterations; i++)
+  {
+    stereo_msgs::DisparityImagePtr msg = boost::make_shared<stereo_msgs::DisparityImage>();
+    fillDisparity(*msg, disparity, ros::Time(1.0 + i));
+  }
+  double alloc_msec =
+      std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / iterations;
+
+  RecordProperty("HD1080_pooled_msec", std::to_string(pooled_msec));
+  RecordProperty("HD1080_alloc_msec", std::to_string(alloc_msec));
+  std::cout << "HD1080 disparity fill: pooled " << pooled_msec << " msec - new message " << alloc_msec << " msec"
+            << std::endl;
+}
+
+int main(int argc, char** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,177 @@
+///////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2023, STEREOLABS.
+//
+// All rights reserved.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+///////////////////////////////////////////////////////////////////////////
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include "sl_stamp_tracker.h"
+
+namespace
+{
+/*! \brief Synthetic source: each grab returns the timestamp of the latest frame, so a frame is seen several times
+ * when the publisher runs faster than the camera */
+struct SyntheticSource
+{
+  uint64_t start_ns;
+  uint64_t period_ns;
+  int repeats;  // Number of times each frame is returned
+
+  uint64_t stamp(int grab) const
+  {
+    return start_ns + static_cast<uint64_t>(grab / repeats) * period_ns;
+  }
+};
+
+/*! \brief The per-camera publishing state, as owned by each nodelet instance */
+struct Instance
+{
+  sl_tools::StampTracker videoStamp;
+  sl_tools::StampTracker imuStamp;
+  int published = 0;
+  double periodSum_sec = 0.0;
+  int periodCount = 0;
+
+  void publish(uint64_t stamp_ns)
+  {
+    double period_sec;
+    if (!videoStamp.update(stamp_ns, period_sec))
+    {
+      return;
+    }
+    ++published;
+    if (period_sec > 0.0)
+    {
+      periodSum_sec += period_sec;
+      ++periodCount;
+    }
+  }
+
+  double meanPeriod() const
+  {
+    return periodCount > 0 ? periodSum_sec / periodCount : 0.0;
+  }
+};
+}  // namespace
+
+TEST(StampTracker, SkipsRepeatedStamps)
+{
+  sl_tools::StampTracker tracker;
+  double period_sec;
+
+  EXPECT_TRUE(tracker.update(1000000000, period_sec));
+  EXPECT_EQ(period_sec, 0.0);
+  EXPECT_FALSE(tracker.isNew(1000000000));
+  EXPECT_FALSE(tracker.update(1000000000, period_sec));
+  EXPECT_TRUE(tracker.update(1033000000, period_sec));
+  EXPECT_NEAR(period_sec, 0.033, 1e-9);
+
+  tracker.reset();
+  EXPECT_EQ(tracker.last(), 0u);
+  EXPECT_TRUE(tracker.update(1066000000, period_sec));
+  EXPECT_EQ(period_sec, 0.0);
+}
+
+// Two cameras grabbing frames with the same timestamps must both publish all of them: a shared state would make
+// the second camera skip every frame already published by the first one
+TEST(StampTracker, InstancesWithSameStampsAreIndependent)
+{
+  SyntheticSource src{1000000000, 33333333, 1};
+  Instance camA, camB;
+
+  const int frames = 1000;
+  for (int i = 0; i < frames; ++i)
+  {
+    camA.publish(src.stamp(i));
+    camB.publish(src.stamp(i));
+  }
+
+  EXPECT_EQ(camA.published, frames);
+  EXPECT_EQ(camB.published, frames);
+  EXPECT_NEAR(camA.meanPeriod(), 0.0333, 1e-4);
+  EXPECT_NEAR(camB.meanPeriod(), 0.0333, 1e-4);
+}
+
+// Interleaved cameras at different rates: the period measured by each camera must be its own frame period
+TEST(StampTracker, InstancesKeepTheirOwnRate)
+{
+  SyntheticSource src30{1000000000, 33333333, 2};
+  SyntheticSource src15{1000000000, 66666666, 3};
+  Instance cam30, cam15;
+
+  const int grabs = 3000;
+  for (int i = 0; i < grabs; ++i)
+  {
+    cam30.publish(src30.stamp(i));
+    cam15.publish(src15.stamp(i));
+    cam15.imuStamp.update(src15.start_ns + static_cast<uint64_t>(i) * 2500000);
+  }
+
+  EXPECT_EQ(cam30.published, grabs / 2);
+  EXPECT_EQ(cam15.published, grabs / 3);
+  EXPECT_NEAR(cam30.meanPeriod(), 0.0333, 1e-4);
+  EXPECT_NEAR(cam15.meanPeriod(), 0.0667, 1e-4);
+
+  // The sensors stream of a camera does not touch the video stream of any camera
+  EXPECT_EQ(cam30.imuStamp.last(), 0u);
+  EXPECT_EQ(cam15.videoStamp.last(), src15.stamp(grabs - 1));
+
+  // Losing the frames of a camera only resets its own state
+  cam30.videoStamp.reset();
+  EXPECT_TRUE(cam30.videoStamp.isNew(src30.stamp(grabs - 1)));
+  EXPECT_FALSE(cam15.videoStamp.isNew(src15.stamp(grabs - 1)));
+}
+
+// Stress: two cameras publishing concurrently from their own threads, each fed by its own synthetic source
+TEST(StampTracker, ConcurrentInstances)
+{
+  const int grabs = 200000;
+  std::vector<SyntheticSource> sources = { { 1000000000, 33333333, 2 }, { 1000000000, 16666666, 4 } };
+  std::vector<Instance> cams(sources.size());
+
+  std::vector<std::thread> threads;
+  for (size_t c = 0; c < cams.size(); ++c)
+  {
+    threads.emplace_back([&, c]() {
+      for (int i = 0; i < grabs; ++i)
+      {
+        cams[c].publish(sources[c].stamp(i));
+      }
+    });
+  }
+  for (auto& t : threads)
+  {
+    t.join();
+  }
+
+  for (size_t c = 0; c < cams.size(); ++c)
+  {
+    EXPECT_EQ(cams[c].published, grabs / sources[c].repeats) << "camera " << c;
+    EXPECT_NEAR(cams[c].meanPeriod(), sources[c].period_ns / 1e9, 1e-6) << "camera " << c;
+  }
+}
+
+int main(int argc, char** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
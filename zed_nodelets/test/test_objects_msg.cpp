@@ -0,0 +1,143 @@
+///////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2023, STEREOLABS.
+//
+// All rights reserved.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+///////////////////////////////////////////////////////////////////////////
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <sl/Camera.hpp>
+#include <zed_interfaces/ObjectsStamped.h>
+
+#include "sl_tools.h"
+
+namespace
+{
+std::vector<sl::ObjectData> makeObjects(size_t count)
+{
+  std::vector<sl::ObjectData> objects(count);
+  for (size_t i = 0; i < count; i++)
+  {
+    sl::ObjectData& data = objects[i];
+    data.id = static_cast<int>(i);
+    data.label = static_cast<sl::OBJECT_CLASS>(i % static_cast<int>(sl::OBJECT_CLASS::LAST));
+    data.sublabel = static_cast<sl::OBJECT_SUBCLASS>(i % static_cast<int>(sl::OBJECT_SUBCLASS::LAST));
+    data.raw_label = static_cast<int>(i % 80);
+    data.confidence = 50.0f + static_cast<float>(i % 50);
+    data.tracking_state = sl::OBJECT_TRACKING_STATE::OK;
+    data.position = sl::float3(0.1f * i, 0.0f, 3.0f);
+    data.velocity = sl::float3(0.0f, 0.0f, 0.5f);
+    data.dimensions = sl::float3(0.5f, 1.7f, 0.4f);
+    for (unsigned int k = 0; k < 4; k++)
+    {
+      data.bounding_box_2d.push_back(sl::uint2(10 * i + k, 20 + k));
+    }
+    if (i % 2 == 0)  // Some objects without 3D box
+    {
+      for (int k = 0; k < 8; k++)
+      {
+        data.bounding_box.push_back(sl::float3(0.1f * k, 0.2f * k, 3.0f));
+      }
+    }
+  }
+  return objects;
+}
+}  // namespace
+
+TEST(ObjectLabels, ClassLabelsMatchSdk)
+{
+  for (int i = 0; i < static_cast<int>(sl::OBJECT_CLASS::LAST); i++)
+  {
+    sl::OBJECT_CLASS objClass = static_cast<sl::OBJECT_CLASS>(i);
+    EXPECT_EQ(sl_tools::objClassLabel(objClass), std::string(sl::toString(objClass).c_str())) << "class " << i;
+  }
+  EXPECT_EQ(sl_tools::objClassLabel(sl::OBJECT_CLASS::LAST), "UNKNOWN");
+}
+
+TEST(ObjectLabels, SubclassLabelsMatchSdk)
+{
+  for (int i = 0; i < static_cast<int>(sl::OBJECT_SUBCLASS::LAST); i++)
+  {
+    sl::OBJECT_SUBCLASS objSubclass = static_cast<sl::OBJECT_SUBCLASS>(i);
+    EXPECT_EQ(sl_tools::objSubclassLabel(objSubclass), std::string(sl::toString(objSubclass).c_str()))
+        << "subclass " << i;
+  }
+  EXPECT_EQ(sl_tools::objSubclassLabel(sl::OBJECT_SUBCLASS::LAST), "UNKNOWN");
+}
+
+TEST(ObjectsToROSmsg, ReusedMessageIsOverwritten)
+{
+  std::vector<sl::ObjectData> objects = makeObjects(4);
+  zed_interfaces::ObjectsStamped msg;
+  sl_tools::objectsToROSmsg(objects, true, msg.objects);
+
+  // A smaller set of objects without boxes must not keep the values of the previous message
+  std::vector<sl::ObjectData> fewer(2);
+  fewer[0].label = sl::OBJECT_CLASS::VEHICLE;
+  sl_tools::objectsToROSmsg(fewer, false, msg.objects);
+
+  ASSERT_EQ(msg.objects.size(), 2u);
+  EXPECT_EQ(msg.objects[0].label, sl_tools::objClassLabel(sl::OBJECT_CLASS::VEHICLE));
+  EXPECT_FALSE(msg.objects[0].tracking_available);
+  for (const auto& obj : msg.objects)
+  {
+    for (const auto& corner : obj.bounding_box_2d.corners)
+    {
+      EXPECT_EQ(corner.kp[0], 0u);
+      EXPECT_EQ(corner.kp[1], 0u);
+    }
+    for (const auto& corner : obj.bounding_box_3d.corners)
+    {
+      EXPECT_EQ(corner.kp[2], 0.0f);
+    }
+  }
+}
+
+TEST(ObjectsToROSmsg, Throughput)
+{
+  const size_t count = 100;
+  const int iterations = 1000;
+
+  std::vector<sl::ObjectData> objects = makeObjects(count);
+  zed_interfaces::ObjectsStamped msg;  // Reused, as the nodelet does when no subscriber holds it
+  sl_tools::objectsToROSmsg(objects, true, msg.objects);
+
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < iterations; i++)
+  {
+    sl_tools::objectsToROSmsg(objects, true, msg.objects);
+  }
+  double elapsed_usec =
+      std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() / iterations;
+
+  ASSERT_EQ(msg.objects.size(), count);
+  EXPECT_EQ(msg.objects[count - 1].instance_id, static_cast<int>(count - 1));
+  EXPECT_EQ(msg.objects[count - 1].bounding_box_2d.corners[3].kp[0], 10 * (count - 1) + 3);
+  RecordProperty("objects_100_usec", std::to_string(elapsed_usec));
+  std::cout << "100 objects fill: " << elapsed_usec << " usec" << std::endl;
+}
+
+int main(int argc, char** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
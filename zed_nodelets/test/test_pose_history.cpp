@@ -0,0 +1,218 @@
+///////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2023, STEREOLABS.
+//
+// All rights reserved.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+///////////////////////////////////////////////////////////////////////////
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <memory>
+#include <vector>
+
+#include <tf2/LinearMath/Quaternion.h>
+
+#include "zed_nodelets/sl_pose_history.h"
+
+using sl_tools::PoseHistory;
+
+namespace
+{
+tf2::Transform makePose(double x, double yaw)
+{
+  tf2::Quaternion q;
+  q.setRPY(0.0, 0.0, yaw);
+  return tf2::Transform(q, tf2::Vector3(x, 2.0 * x, 0.0));
+}
+
+// Poses at 10, 10.1, 10.2, ... with x growing by 1 m and yaw by 0.1 rad per sample
+std::shared_ptr<PoseHistory> makeHistory(const std::string& name, int count, size_t capacity = 100)
+{
+  std::shared_ptr<PoseHistory> history = PoseHistory::create(name, capacity);
+  for (int i = 0; i < count; i++)
+  {
+    history->add(ros::Time(10.0 + 0.1 * i), makePose(i, 0.1 * i), makePose(-i, -0.1 * i));
+  }
+  return history;
+}
+
+void expectPose(const tf2::Transform& pose, double x, double yaw)
+{
+  tf2::Transform expected = makePose(x, yaw);
+  EXPECT_NEAR(pose.getOrigin().distance(expected.getOrigin()), 0.0, 1e-9);
+  EXPECT_NEAR(pose.getRotation().angleShortestPath(expected.getRotation()), 0.0, 1e-6);
+}
+}  // namespace
+
+TEST(PoseHistory, ExactHit)
+{
+  std::shared_ptr<PoseHistory> history = makeHistory("exact", 10);
+
+  PoseHistory::Sample sample;
+  ASSERT_TRUE(history->lookup(ros::Time(10.3), sample));
+  EXPECT_EQ(sample.stamp, ros::Time(10.3));
+  expectPose(sample.odom2base, 3.0, 0.3);
+  expectPose(sample.map2base, -3.0, -0.3);
+
+  // First and last stored poses are inside the range
+  ASSERT_TRUE(history->lookup(ros::Time(10.0), sample));
+  expectPose(sample.odom2base, 0.0, 0.0);
+  ASSERT_TRUE(history->lookup(ros::Time(10.9), sample));
+  expectPose(sample.odom2base, 9.0, 0.9);
+}
+
+TEST(PoseHistory, Interpolated)
+{
+  std::shared_ptr<PoseHistory> history = makeHistory("interpolated", 10);
+
+  PoseHistory::Sample sample;
+  ASSERT_TRUE(history->lookup(ros::Time(10.425), sample));
+  EXPECT_EQ(sample.stamp, ros::Time(10.425));
+  expectPose(sample.odom2base, 4.25, 0.425);
+  expectPose(sample.map2base, -4.25, -0.425);
+}
+
+TEST(PoseHistory, SlerpAcrossQuaternionSignFlip)
+{
+  std::shared_ptr<PoseHistory> history = PoseHistory::create("sign_flip", 10);
+
+  // Yaw from 170 deg to -170 deg: the two quaternions have opposite signs, the interpolation must take the short
+  // path through 180 deg, not the long one through 0 deg
+  tf2::Quaternion q1, q2;
+  q1.setRPY(0.0, 0.0, 170.0 * M_PI / 180.0);
+  q2.setRPY(0.0, 0.0, -170.0 * M_PI / 180.0);
+  ASSERT_LT(q1.dot(q2), 0.0);
+
+  tf2::Transform p1(q1, tf2::Vector3(0.0, 0.0, 0.0));
+  tf2::Transform p2(q2, tf2::Vector3(1.0, 0.0, 0.0));
+  history->add(ros::Time(1.0), p1, p1);
+  history->add(ros::Time(2.0), p2, p2);
+
+  PoseHistory::Sample sample;
+  ASSERT_TRUE(history->lookup(ros::Time(1.5), sample));
+  tf2::Quaternion expected;
+  expected.setRPY(0.0, 0.0, M_PI);
+  EXPECT_NEAR(sample.odom2base.getRotation().angleShortestPath(expected), 0.0, 1e-6);
+  EXPECT_NEAR(sample.odom2base.getOrigin().x(), 0.5, 1e-9);
+}
+
+TEST(PoseHistory, OutOfRange)
+{
+  std::shared_ptr<PoseHistory> history = makeHistory("out_of_range", 10);
+
+  PoseHistory::Sample sample;
+  EXPECT_FALSE(history->lookup(ros::Time(9.999), sample));
+  EXPECT_FALSE(history->lookup(ros::Time(10.901), sample));
+
+  std::shared_ptr<PoseHistory> empty = PoseHistory::create("empty", 10);
+  EXPECT_FALSE(empty->lookup(ros::Time(10.0), sample));
+  ros::Time oldest, newest;
+  EXPECT_FALSE(empty->getTimeRange(oldest, newest));
+}
+
+TEST(PoseHistory, OlderPosesIgnored)
+{
+  std::shared_ptr<PoseHistory> history = makeHistory("older", 5);
+
+  // Same stamp as the last pose and older than it: both ignored
+  history->add(ros::Time(10.4), makePose(100.0, 0.0), makePose(100.0, 0.0));
+  history->add(ros::Time(10.35), makePose(100.0, 0.0), makePose(100.0, 0.0));
+
+  PoseHistory::Sample sample;
+  ASSERT_TRUE(history->lookup(ros::Time(10.4), sample));
+  expectPose(sample.odom2base, 4.0, 0.4);
+  ASSERT_TRUE(history->lookup(ros::Time(10.35), sample));
+  expectPose(sample.odom2base, 3.5, 0.35);
+
+  ros::Time oldest, newest;
+  ASSERT_TRUE(history->getTimeRange(oldest, newest));
+  EXPECT_EQ(oldest, ros::Time(10.0));
+  EXPECT_EQ(newest, ros::Time(10.4));
+}
+
+TEST(PoseHistory, CapacityDropsOldestPoses)
+{
+  std::shared_ptr<PoseHistory> history = makeHistory("capacity", 10, 4);
+
+  ros::Time oldest, newest;
+  ASSERT_TRUE(history->getTimeRange(oldest, newest));
+  EXPECT_EQ(oldest, ros::Time(10.6));
+  EXPECT_EQ(newest, ros::Time(10.9));
+
+  PoseHistory::Sample sample;
+  EXPECT_FALSE(history->lookup(ros::Time(10.5), sample));
+  ASSERT_TRUE(history->lookup(ros::Time(10.65), sample));
+  expectPose(sample.odom2base, 6.5, 0.65);
+}
+
+TEST(PoseHistory, Clear)
+{
+  std::shared_ptr<PoseHistory> history = makeHistory("clear", 10);
+  history->clear();
+
+  PoseHistory::Sample sample;
+  EXPECT_FALSE(history->lookup(ros::Time(10.5), sample));
+  ros::Time oldest, newest;
+  EXPECT_FALSE(history->getTimeRange(oldest, newest));
+
+  // After a reset of the odometry the history restarts from any stamp
+  history->add(ros::Time(5.0), makePose(1.0, 0.0), makePose(1.0, 0.0));
+  ASSERT_TRUE(history->lookup(ros::Time(5.0), sample));
+  expectPose(sample.odom2base, 1.0, 0.0);
+}
+
+TEST(PoseHistory, BatchLookup)
+{
+  std::shared_ptr<PoseHistory> history = makeHistory("batch", 10);
+
+  std::vector<ros::Time> stamps = { ros::Time(9.0), ros::Time(10.2), ros::Time(10.55), ros::Time(11.0) };
+  std::vector<PoseHistory::Sample> samples;
+  std::vector<uint8_t> valid;
+  EXPECT_EQ(history->lookup(stamps, samples, valid), 2u);
+
+  ASSERT_EQ(samples.size(), stamps.size());
+  ASSERT_EQ(valid.size(), stamps.size());
+  EXPECT_EQ(valid, std::vector<uint8_t>({ 0, 1, 1, 0 }));
+  expectPose(samples[1].odom2base, 2.0, 0.2);
+  expectPose(samples[2].odom2base, 5.5, 0.55);
+}
+
+TEST(PoseHistory, Registry)
+{
+  std::shared_ptr<PoseHistory> history = makeHistory("registry", 3);
+
+  std::shared_ptr<const PoseHistory> found = PoseHistory::find("registry");
+  EXPECT_EQ(found.get(), history.get());
+  EXPECT_EQ(PoseHistory::find("unknown"), nullptr);
+
+  // A new history with the same name replaces the previous one
+  std::shared_ptr<PoseHistory> replaced = PoseHistory::create("registry", 10);
+  EXPECT_EQ(PoseHistory::find("registry").get(), replaced.get());
+
+  // The readers keep the history alive, it is removed from the registry when the last reference is released
+  found = PoseHistory::find("registry");
+  replaced.reset();
+  EXPECT_NE(PoseHistory::find("registry"), nullptr);
+  found.reset();
+  EXPECT_EQ(PoseHistory::find("registry"), nullptr);
+}
+
+int main(int argc, char** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
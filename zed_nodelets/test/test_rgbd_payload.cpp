@@ -0,0 +1,128 @@
+///////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2023, STEREOLABS.
+//
+// All rights reserved.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+///////////////////////////////////////////////////////////////////////////
+
+#include <gtest/gtest.h>
+
+#include <boost/make_shared.hpp>
+
+#include "sl_rgbd_payload.h"
+
+using sl_tools::RgbdPayloadChannel;
+
+namespace
+{
+sensor_msgs::ImagePtr makeImage(ros::Time stamp, const std::string& encoding, uint32_t bytesPerPixel)
+{
+  sensor_msgs::ImagePtr img = boost::make_shared<sensor_msgs::Image>();
+  img->header.stamp = stamp;
+  img->header.frame_id = "zed_left_camera_optical_frame";
+  img->width = 64;
+  img->height = 48;
+  img->encoding = encoding;
+  img->step = img->width * bytesPerPixel;
+  img->data.resize(img->step * img->height, 0x5A);
+  return img;
+}
+}  // namespace
+
+TEST(RgbdPayload, ReferenceKeepsOnlyTheMetadata)
+{
+  sensor_msgs::ImagePtr rgb = makeImage(ros::Time(10.0), "bgra8", 4);
+
+  sensor_msgs::Image ref;
+  RgbdPayloadChannel::fillReference(*rgb, ref);
+
+  EXPECT_TRUE(RgbdPayloadChannel::isReference(ref));
+  EXPECT_FALSE(RgbdPayloadChannel::isReference(*rgb));
+  EXPECT_TRUE(ref.data.empty());
+  EXPECT_EQ(ref.header.stamp, rgb->header.stamp);
+  EXPECT_EQ(ref.header.frame_id, rgb->header.frame_id);
+  EXPECT_EQ(ref.width, rgb->width);
+  EXPECT_EQ(ref.height, rgb->height);
+  EXPECT_EQ(ref.step, rgb->step);
+  EXPECT_EQ(ref.encoding, rgb->encoding);
+}
+
+TEST(RgbdPayload, DemuxedImagesShareStorage)
+{
+  const std::string topic = "/zed/rgbd_sens/shared";
+  std::shared_ptr<RgbdPayloadChannel> channel = RgbdPayloadChannel::create(topic, 4);
+
+  const ros::Time stamp(20.0);
+  sensor_msgs::ImageConstPtr rgb = makeImage(stamp, "bgra8", 4);
+  sensor_msgs::ImageConstPtr depth = makeImage(stamp, "32FC1", 4);
+  const uint8_t* rgbData = rgb->data.data();
+  const uint8_t* depthData = depth->data.data();
+
+  // Sync side
+  channel->add(stamp, rgb, depth);
+  EXPECT_EQ(rgb.use_count(), 2);
+  EXPECT_EQ(depth.use_count(), 2);
+
+  // Demux side
+  std::shared_ptr<const RgbdPayloadChannel> found = RgbdPayloadChannel::find(topic);
+  ASSERT_EQ(found.get(), channel.get());
+
+  sensor_msgs::ImageConstPtr rgbOut, depthOut;
+  ASSERT_TRUE(found->get(stamp, rgbOut, depthOut));
+
+  EXPECT_EQ(rgbOut.get(), rgb.get());
+  EXPECT_EQ(depthOut.get(), depth.get());
+  EXPECT_EQ(rgbOut->data.data(), rgbData);
+  EXPECT_EQ(depthOut->data.data(), depthData);
+  EXPECT_EQ(rgb.use_count(), 3);
+  EXPECT_EQ(depth.use_count(), 3);
+}
+
+TEST(RgbdPayload, OldPayloadsAreReleased)
+{
+  const std::string topic = "/zed/rgbd_sens/capacity";
+  std::shared_ptr<RgbdPayloadChannel> channel = RgbdPayloadChannel::create(topic, 2);
+
+  sensor_msgs::ImageConstPtr first = makeImage(ros::Time(1.0), "bgra8", 4);
+  channel->add(ros::Time(1.0), first, first);
+  for (int i = 2; i <= 3; i++)
+  {
+    sensor_msgs::ImageConstPtr img = makeImage(ros::Time(i), "bgra8", 4);
+    channel->add(ros::Time(i), img, img);
+  }
+
+  // The oldest payload has been dropped and its images released
+  sensor_msgs::ImageConstPtr rgbOut, depthOut;
+  EXPECT_FALSE(channel->get(ros::Time(1.0), rgbOut, depthOut));
+  EXPECT_TRUE(channel->get(ros::Time(3.0), rgbOut, depthOut));
+  EXPECT_EQ(first.use_count(), 1);
+}
+
+TEST(RgbdPayload, ChannelUnregisteredWhenReleased)
+{
+  const std::string topic = "/zed/rgbd_sens/released";
+  std::shared_ptr<RgbdPayloadChannel> channel = RgbdPayloadChannel::create(topic, 1);
+  EXPECT_TRUE(RgbdPayloadChannel::find(topic));
+
+  channel.reset();
+  EXPECT_FALSE(RgbdPayloadChannel::find(topic));
+}
+
+int main(int argc, char** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}